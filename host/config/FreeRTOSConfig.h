@@ -0,0 +1,82 @@
+/**
+******************************************************************************
+* @file 	FreeRTOSConfig.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Kernel configuration of the host build, mirrors the ESP-IDF settings the firmware relies on */
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#define configUSE_PREEMPTION (1)
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION (0)
+#define configUSE_IDLE_HOOK (0)
+#define configUSE_TICK_HOOK (0)
+#define configCPU_CLOCK_HZ (CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000000U)
+#define configTICK_RATE_HZ (CONFIG_FREERTOS_HZ)
+#define configMAX_PRIORITIES (25)
+#define configMINIMAL_STACK_SIZE (4096U) /* Words, pthreads and glibc need far more than the Xtensa port */
+#define configSTACK_DEPTH_TYPE uint32_t
+#define configTOTAL_HEAP_SIZE (16U * 1024U * 1024U)
+#define configMAX_TASK_NAME_LEN (CONFIG_FREERTOS_MAX_TASK_NAME_LEN)
+#define configUSE_16_BIT_TICKS (0)
+#define configIDLE_SHOULD_YIELD (1)
+#define configUSE_TASK_NOTIFICATIONS (1)
+#define configUSE_MUTEXES (1)
+#define configUSE_RECURSIVE_MUTEXES (1)
+#define configUSE_COUNTING_SEMAPHORES (1)
+#define configUSE_QUEUE_SETS (1)
+#define configQUEUE_REGISTRY_SIZE (0)
+#define configUSE_TIME_SLICING (1)
+#define configENABLE_BACKWARD_COMPATIBILITY (1)
+#define configCHECK_FOR_STACK_OVERFLOW (0)
+#define configUSE_MALLOC_FAILED_HOOK (0)
+#define configUSE_APPLICATION_TASK_TAG (0)
+
+/* Firmware static allocation needs Xtensa sized stacks, the host build always allocates dynamically */
+#define configSUPPORT_STATIC_ALLOCATION (0)
+#define configSUPPORT_DYNAMIC_ALLOCATION (1)
+
+/* Task monitor */
+#define configUSE_TRACE_FACILITY (CONFIG_FREERTOS_USE_TRACE_FACILITY)
+#define configUSE_STATS_FORMATTING_FUNCTIONS (0)
+#define configGENERATE_RUN_TIME_STATS (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+extern int64_t esp_timer_get_time(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() ((uint32_t)esp_timer_get_time())
+
+/* Software timers, same priority as the ESP-IDF timer task */
+#define configUSE_TIMERS (1)
+#define configTIMER_TASK_PRIORITY (CONFIG_FREERTOS_TIMER_TASK_PRIORITY)
+#define configTIMER_QUEUE_LENGTH (CONFIG_FREERTOS_TIMER_QUEUE_LENGTH)
+#define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2U)
+
+#define INCLUDE_vTaskPrioritySet (1)
+#define INCLUDE_uxTaskPriorityGet (1)
+#define INCLUDE_vTaskDelete (1)
+#define INCLUDE_vTaskSuspend (1)
+#define INCLUDE_vTaskDelayUntil (1)
+#define INCLUDE_xTaskDelayUntil (1)
+#define INCLUDE_vTaskDelay (1)
+#define INCLUDE_xTaskGetCurrentTaskHandle (1)
+#define INCLUDE_uxTaskGetStackHighWaterMark (1)
+#define INCLUDE_xTaskGetIdleTaskHandle (1)
+#define INCLUDE_eTaskGetState (1)
+#define INCLUDE_xTimerPendFunctionCall (1)
+#define INCLUDE_xTaskGetSchedulerState (1)
+
+extern void vHOST_AssertCalled(const char* file, unsigned long line);
+#define configASSERT(x)                             \
+    do {                                            \
+        if (!(x)) {                                 \
+            vHOST_AssertCalled(__FILE__, __LINE__); \
+        }                                           \
+    } while (0)
+
+#endif //FREERTOS_CONFIG_H
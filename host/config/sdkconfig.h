@@ -0,0 +1,21 @@
+/**
+******************************************************************************
+* @file 	sdkconfig.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __SDKCONFIG_H__
+#define __SDKCONFIG_H__
+
+/* Subset of the project sdkconfig read by the firmware, keep in sync with ../sdkconfig */
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_FREERTOS_MAX_TASK_NAME_LEN 16
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY 1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS 1
+#define CONFIG_FREERTOS_TIMER_TASK_PRIORITY 1
+#define CONFIG_FREERTOS_TIMER_QUEUE_LENGTH 10
+
+#endif //__SDKCONFIG_H__
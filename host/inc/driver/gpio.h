@@ -0,0 +1,125 @@
+/**
+******************************************************************************
+* @file 	gpio.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __DRIVER_GPIO_H__
+#define __DRIVER_GPIO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_bit_defs.h"
+#include "esp_err.h"
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_1 = 1,
+    GPIO_NUM_2 = 2,
+    GPIO_NUM_3 = 3,
+    GPIO_NUM_4 = 4,
+    GPIO_NUM_5 = 5,
+    GPIO_NUM_6 = 6,
+    GPIO_NUM_7 = 7,
+    GPIO_NUM_8 = 8,
+    GPIO_NUM_9 = 9,
+    GPIO_NUM_10 = 10,
+    GPIO_NUM_11 = 11,
+    GPIO_NUM_12 = 12,
+    GPIO_NUM_13 = 13,
+    GPIO_NUM_14 = 14,
+    GPIO_NUM_15 = 15,
+    GPIO_NUM_16 = 16,
+    GPIO_NUM_17 = 17,
+    GPIO_NUM_18 = 18,
+    GPIO_NUM_19 = 19,
+    GPIO_NUM_21 = 21,
+    GPIO_NUM_22 = 22,
+    GPIO_NUM_23 = 23,
+    GPIO_NUM_25 = 25,
+    GPIO_NUM_26 = 26,
+    GPIO_NUM_27 = 27,
+    GPIO_NUM_32 = 32,
+    GPIO_NUM_33 = 33,
+    GPIO_NUM_34 = 34,
+    GPIO_NUM_35 = 35,
+    GPIO_NUM_36 = 36,
+    GPIO_NUM_37 = 37,
+    GPIO_NUM_38 = 38,
+    GPIO_NUM_39 = 39,
+    GPIO_NUM_MAX = 40,
+} gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = BIT(0),
+    GPIO_MODE_OUTPUT = BIT(1),
+    GPIO_MODE_OUTPUT_OD = BIT(1) | BIT(2),
+    GPIO_MODE_INPUT_OUTPUT_OD = BIT(0) | BIT(1) | BIT(2),
+    GPIO_MODE_INPUT_OUTPUT = BIT(0) | BIT(1),
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+    GPIO_INTR_MAX,
+} gpio_int_type_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void* pArg);
+
+/* Input levels are driven by vHOST_SetGpioLevel, output levels are recorded in the host timeline */
+esp_err_t gpio_config(const gpio_config_t* pGpioConfig);
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio);
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode);
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level);
+
+int gpio_get_level(gpio_num_t gpio);
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t intrType);
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio);
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio);
+
+esp_err_t gpio_install_isr_service(int intrAllocFlags);
+
+void gpio_uninstall_isr_service(void);
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t isrHandler, void* pArgs);
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio);
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t intrType);
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio);
+
+#endif //__DRIVER_GPIO_H__
@@ -0,0 +1,89 @@
+/**
+******************************************************************************
+* @file 	mcpwm.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __DRIVER_MCPWM_H__
+#define __DRIVER_MCPWM_H__
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef enum {
+    MCPWM0A = 0,
+    MCPWM0B,
+    MCPWM1A,
+    MCPWM1B,
+    MCPWM2A,
+    MCPWM2B,
+} mcpwm_io_signals_t;
+
+typedef enum {
+    MCPWM_UNIT_0 = 0,
+    MCPWM_UNIT_1,
+    MCPWM_UNIT_MAX,
+} mcpwm_unit_t;
+
+typedef enum {
+    MCPWM_TIMER_0 = 0,
+    MCPWM_TIMER_1,
+    MCPWM_TIMER_2,
+    MCPWM_TIMER_MAX,
+} mcpwm_timer_t;
+
+typedef enum {
+    MCPWM_OPR_A = 0,
+    MCPWM_OPR_B,
+    MCPWM_OPR_MAX,
+} mcpwm_operator_t;
+
+typedef enum {
+    MCPWM_UP_COUNTER = 1,
+    MCPWM_DOWN_COUNTER,
+    MCPWM_UP_DOWN_COUNTER,
+    MCPWM_COUNTER_MAX,
+} mcpwm_counter_type_t;
+
+typedef enum {
+    MCPWM_DUTY_MODE_0 = 0,
+    MCPWM_DUTY_MODE_1,
+    MCPWM_HAL_GENERATOR_MODE_FORCE_LOW,
+    MCPWM_HAL_GENERATOR_MODE_FORCE_HIGH,
+    MCPWM_DUTY_MODE_MAX,
+} mcpwm_duty_type_t;
+
+typedef struct {
+    uint32_t frequency;
+    float cmpr_a;
+    float cmpr_b;
+    mcpwm_duty_type_t duty_mode;
+    mcpwm_counter_type_t counter_mode;
+} mcpwm_config_t;
+
+/* Every output change is recorded in the host timeline as a pulse width in microseconds */
+esp_err_t mcpwm_gpio_init(mcpwm_unit_t mcpwmNum, mcpwm_io_signals_t ioSignal, int gpioNum);
+
+esp_err_t mcpwm_init(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, const mcpwm_config_t* pMcpwmConf);
+
+esp_err_t mcpwm_set_frequency(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, uint32_t frequency);
+
+esp_err_t mcpwm_set_duty(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, float duty);
+
+esp_err_t mcpwm_set_duty_in_us(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, uint32_t dutyInUs);
+
+esp_err_t mcpwm_set_duty_type(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, mcpwm_duty_type_t dutyType);
+
+esp_err_t mcpwm_set_signal_low(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum);
+
+esp_err_t mcpwm_set_signal_high(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum);
+
+esp_err_t mcpwm_start(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum);
+
+esp_err_t mcpwm_stop(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum);
+
+#endif //__DRIVER_MCPWM_H__
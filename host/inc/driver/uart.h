@@ -0,0 +1,106 @@
+/**
+******************************************************************************
+* @file 	uart.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __DRIVER_UART_H__
+#define __DRIVER_UART_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define UART_FIFO_LEN (128)
+#define UART_PIN_NO_CHANGE (-1)
+
+typedef enum {
+    UART_NUM_0 = 0,
+    UART_NUM_1,
+    UART_NUM_2,
+    UART_NUM_MAX,
+} uart_port_t;
+
+typedef enum {
+    UART_DATA_5_BITS = 0,
+    UART_DATA_6_BITS,
+    UART_DATA_7_BITS,
+    UART_DATA_8_BITS,
+    UART_DATA_BITS_MAX,
+} uart_word_length_t;
+
+typedef enum {
+    UART_STOP_BITS_1 = 1,
+    UART_STOP_BITS_1_5,
+    UART_STOP_BITS_2,
+    UART_STOP_BITS_MAX,
+} uart_stop_bits_t;
+
+typedef enum {
+    UART_PARITY_DISABLE = 0,
+    UART_PARITY_EVEN = 2,
+    UART_PARITY_ODD = 3,
+} uart_parity_t;
+
+typedef enum {
+    UART_HW_FLOWCTRL_DISABLE = 0,
+    UART_HW_FLOWCTRL_RTS,
+    UART_HW_FLOWCTRL_CTS,
+    UART_HW_FLOWCTRL_CTS_RTS,
+    UART_HW_FLOWCTRL_MAX,
+} uart_hw_flowcontrol_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t rx_flow_ctrl_thresh;
+    bool use_ref_tick;
+} uart_config_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+/* Each port is a pseudo-terminal, its slave path is printed at driver install: connect tools/link_client.py to it */
+esp_err_t uart_param_config(uart_port_t uartNum, const uart_config_t* pUartConfig);
+
+esp_err_t uart_set_pin(uart_port_t uartNum, int txIoNum, int rxIoNum, int rtsIoNum, int ctsIoNum);
+
+esp_err_t uart_driver_install(uart_port_t uartNum, int rxBufferSize, int txBufferSize, int queueSize, QueueHandle_t* pUartQueue, int intrAllocFlags);
+
+esp_err_t uart_driver_delete(uart_port_t uartNum);
+
+int uart_read_bytes(uart_port_t uartNum, uint8_t* pBuffer, uint32_t length, TickType_t ticksToWait);
+
+int uart_write_bytes(uart_port_t uartNum, const char* pSource, size_t size);
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uartNum, size_t* pSize);
+
+esp_err_t uart_flush_input(uart_port_t uartNum);
+
+esp_err_t uart_wait_tx_done(uart_port_t uartNum, TickType_t ticksToWait);
+
+#endif //__DRIVER_UART_H__
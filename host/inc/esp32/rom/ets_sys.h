@@ -0,0 +1,17 @@
+/**
+******************************************************************************
+* @file 	ets_sys.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP32_ROM_ETS_SYS_H__
+#define __ESP32_ROM_ETS_SYS_H__
+
+#include <stdint.h>
+
+/* Busy wait, the calling task keeps the simulated core as on the target */
+void ets_delay_us(uint32_t us);
+
+#endif //__ESP32_ROM_ETS_SYS_H__
@@ -0,0 +1,15 @@
+/**
+******************************************************************************
+* @file 	esp_bit_defs.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_BIT_DEFS_H__
+#define __ESP_BIT_DEFS_H__
+
+#define BIT(nr) (1UL << (nr))
+#define BIT64(nr) (1ULL << (nr))
+
+#endif //__ESP_BIT_DEFS_H__
@@ -0,0 +1,24 @@
+/**
+******************************************************************************
+* @file 	esp_err.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_ERR_H__
+#define __ESP_ERR_H__
+
+#include <stdint.h>
+
+typedef int32_t esp_err_t;
+
+#define ESP_OK (0)
+#define ESP_FAIL (-1)
+#define ESP_ERR_NO_MEM (0x101)
+#define ESP_ERR_INVALID_ARG (0x102)
+#define ESP_ERR_INVALID_STATE (0x103)
+#define ESP_ERR_NOT_FOUND (0x105)
+#define ESP_ERR_TIMEOUT (0x107)
+
+#endif //__ESP_ERR_H__
@@ -0,0 +1,21 @@
+/**
+******************************************************************************
+* @file 	esp_ipc.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_IPC_H__
+#define __ESP_IPC_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef void (*esp_ipc_func_t)(void* arg);
+
+/* Single simulated core: the function runs in the caller */
+esp_err_t esp_ipc_call_blocking(uint32_t cpuId, esp_ipc_func_t function, void* pArg);
+
+#endif //__ESP_IPC_H__
@@ -0,0 +1,18 @@
+/**
+******************************************************************************
+* @file 	esp_spi_flash.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_SPI_FLASH_H__
+#define __ESP_SPI_FLASH_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/* No flash on the host, header is only kept for the firmware includes */
+
+#endif //__ESP_SPI_FLASH_H__
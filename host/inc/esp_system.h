@@ -0,0 +1,24 @@
+/**
+******************************************************************************
+* @file 	esp_system.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_SYSTEM_H__
+#define __ESP_SYSTEM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/* Exits the host process */
+void esp_restart(void) __attribute__((noreturn));
+
+uint32_t esp_get_free_heap_size(void);
+
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#endif //__ESP_SYSTEM_H__
@@ -0,0 +1,19 @@
+/**
+******************************************************************************
+* @file 	esp_timer.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __ESP_TIMER_H__
+#define __ESP_TIMER_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/* Microseconds since the host process started */
+int64_t esp_timer_get_time(void);
+
+#endif //__ESP_TIMER_H__
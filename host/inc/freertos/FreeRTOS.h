@@ -0,0 +1,68 @@
+/**
+******************************************************************************
+* @file 	FreeRTOS.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+/* ESP-IDF flavoured FreeRTOS on top of the vanilla kernel POSIX port */
+#include <FreeRTOS.h>
+
+#include "esp_bit_defs.h"
+
+/* Single simulated core, spinlocks reduce to the kernel critical section */
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED \
+    {                                \
+        0U, 0U                       \
+    }
+#define portNUM_PROCESSORS (1)
+#define tskNO_AFFINITY (0x7FFFFFFF)
+#define xPortGetCoreID() ((BaseType_t)0)
+
+#undef portENTER_CRITICAL
+#undef portEXIT_CRITICAL
+#define portENTER_CRITICAL(pMux) \
+    do {                         \
+        (void)(pMux);            \
+        vPortEnterCritical();    \
+    } while (0)
+#define portEXIT_CRITICAL(pMux) \
+    do {                        \
+        (void)(pMux);           \
+        vPortExitCritical();    \
+    } while (0)
+#define portENTER_CRITICAL_ISR(pMux) portENTER_CRITICAL(pMux)
+#define portEXIT_CRITICAL_ISR(pMux) portEXIT_CRITICAL(pMux)
+#define portENTER_CRITICAL_SAFE(pMux) portENTER_CRITICAL(pMux)
+#define portEXIT_CRITICAL_SAFE(pMux) portEXIT_CRITICAL(pMux)
+
+/* Emulated ISRs run in a critical section of the highest priority harness task */
+#undef portSET_INTERRUPT_MASK_FROM_ISR
+#undef portCLEAR_INTERRUPT_MASK_FROM_ISR
+#define portSET_INTERRUPT_MASK_FROM_ISR() \
+    ({                                    \
+        vPortEnterCritical();             \
+        (UBaseType_t)0U;                  \
+    })
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(savedStatus) \
+    do {                                               \
+        (void)(savedStatus);                           \
+        vPortExitCritical();                           \
+    } while (0)
+
+/* Woken tasks run as soon as the harness task blocks again */
+#undef portYIELD_FROM_ISR
+#define portYIELD_FROM_ISR() \
+    do {                     \
+    } while (0)
+
+#endif //__HOST_FREERTOS_H__
@@ -0,0 +1,16 @@
+/**
+******************************************************************************
+* @file 	event_groups.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_EVENT_GROUPS_H__
+#define __HOST_EVENT_GROUPS_H__
+
+#include "freertos/FreeRTOS.h"
+
+#include <event_groups.h>
+
+#endif //__HOST_EVENT_GROUPS_H__
@@ -0,0 +1,16 @@
+/**
+******************************************************************************
+* @file 	queue.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_QUEUE_H__
+#define __HOST_QUEUE_H__
+
+#include "freertos/FreeRTOS.h"
+
+#include <queue.h>
+
+#endif //__HOST_QUEUE_H__
@@ -0,0 +1,16 @@
+/**
+******************************************************************************
+* @file 	semphr.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_SEMPHR_H__
+#define __HOST_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+#include <semphr.h>
+
+#endif //__HOST_SEMPHR_H__
@@ -0,0 +1,25 @@
+/**
+******************************************************************************
+* @file 	task.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_TASK_H__
+#define __HOST_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+#include <task.h>
+
+/* Firmware stack sizes are in bytes for the Xtensa port, scaled up for pthreads and glibc */
+#define HOST_STACK_MULTIPLIER (16U)
+#define HOST_STACK_DEPTH(stackBytes) (((stackBytes)*HOST_STACK_MULTIPLIER) / sizeof(StackType_t))
+
+#define xTaskCreate(function, name, stackBytes, pParameters, priority, pHandle) \
+    xTaskCreate((function), (name), HOST_STACK_DEPTH(stackBytes), (pParameters), (priority), (pHandle))
+#define xTaskCreatePinnedToCore(function, name, stackBytes, pParameters, priority, pHandle, coreId) \
+    xTaskCreate((function), (name), (stackBytes), (pParameters), (priority), (pHandle))
+
+#endif //__HOST_TASK_H__
@@ -0,0 +1,16 @@
+/**
+******************************************************************************
+* @file 	timers.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOST_TIMERS_H__
+#define __HOST_TIMERS_H__
+
+#include "freertos/FreeRTOS.h"
+
+#include <timers.h>
+
+#endif //__HOST_TIMERS_H__
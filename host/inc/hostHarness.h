@@ -0,0 +1,52 @@
+/**
+******************************************************************************
+* @file 	hostHarness.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __HOSTHARNESS_H__
+#define __HOSTHARNESS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "driver/gpio.h"
+
+#define HOST_TIMELINE_MAX_SAMPLES (65536U)
+
+typedef enum {
+    HOST_SIGNAL_GPIO_INPUT = 0, /* value: level injected by the harness */
+    HOST_SIGNAL_GPIO_OUTPUT, /* value: level written by the firmware */
+    HOST_SIGNAL_MCPWM, /* value: pulse width in us */
+    HOST_SIGNAL_LEDC, /* value: duty in timer resolution steps */
+    /* Do not erase */
+    HOST_SIGNAL_NUMBER
+} hostSignal_e;
+
+typedef struct {
+    int64_t timestampUs;
+    hostSignal_e signal;
+    uint32_t gpio;
+    uint32_t value;
+} hostSample_t;
+
+/* Drives an input pin, the registered ISR handler runs on matching edges */
+void vHOST_SetGpioLevel(gpio_num_t gpio, uint32_t level);
+
+/* Output levels written by the firmware on output are also driven on input, as a jumper would */
+void vHOST_WireGpio(gpio_num_t output, gpio_num_t input);
+
+/* True when no pulse is driven on a routed output: every servo is parked or stopped */
+bool bHOST_AreMcpwmOutputsLow(void);
+
+void vHOST_RecordSample(hostSignal_e signal, uint32_t gpio, uint32_t value, int64_t timestampUs);
+
+uint32_t u32HOST_GetTimeline(hostSample_t* pSamples, uint32_t maxSamples);
+
+/* CSV, time ordered: time_us,signal,gpio,value */
+void vHOST_WriteTimeline(FILE* pFile);
+
+#endif //__HOSTHARNESS_H__
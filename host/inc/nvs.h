@@ -0,0 +1,45 @@
+/**
+******************************************************************************
+* @file 	nvs.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __NVS_H__
+#define __NVS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_BASE (0x1100)
+#define ESP_ERR_NVS_NOT_FOUND (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_INVALID_HANDLE (ESP_ERR_NVS_BASE + 0x07)
+#define ESP_ERR_NVS_READ_ONLY (ESP_ERR_NVS_BASE + 0x04)
+#define ESP_ERR_NVS_NOT_ENOUGH_SPACE (ESP_ERR_NVS_BASE + 0x05)
+#define ESP_ERR_NVS_INVALID_LENGTH (ESP_ERR_NVS_BASE + 0x0C)
+#define ESP_ERR_NVS_NO_FREE_PAGES (ESP_ERR_NVS_BASE + 0x0D)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND (ESP_ERR_NVS_BASE + 0x10)
+#define NVS_KEY_NAME_MAX_SIZE (16)
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+/* Blobs live in memory for the process lifetime: a calibration uploaded to the host build is lost at exit */
+esp_err_t nvs_open(const char* pName, nvs_open_mode_t openMode, nvs_handle_t* pHandle);
+
+void nvs_close(nvs_handle_t handle);
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* pKey, const void* pValue, size_t length);
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* pKey, void* pValue, size_t* pLength);
+
+esp_err_t nvs_commit(nvs_handle_t handle);
+
+#endif //__NVS_H__
@@ -0,0 +1,19 @@
+/**
+******************************************************************************
+* @file 	nvs_flash.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __NVS_FLASH_H__
+#define __NVS_FLASH_H__
+
+#include "esp_err.h"
+#include "nvs.h"
+
+esp_err_t nvs_flash_init(void);
+
+esp_err_t nvs_flash_erase(void);
+
+#endif //__NVS_FLASH_H__
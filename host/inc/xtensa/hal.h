@@ -0,0 +1,17 @@
+/**
+******************************************************************************
+* @file 	hal.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __XTENSA_HAL_H__
+#define __XTENSA_HAL_H__
+
+#include <stdint.h>
+
+/* CPU cycles derived from esp_timer at the configured CPU frequency */
+uint32_t xthal_get_ccount(void);
+
+#endif //__XTENSA_HAL_H__
@@ -0,0 +1,241 @@
+/**
+******************************************************************************
+* @file 	hostGpio.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "hostHarness.h"
+
+/* Struct */
+typedef struct {
+    gpio_mode_t mode;
+    gpio_int_type_t intrType;
+    bool intrEnabled;
+    uint32_t level;
+    gpio_isr_t isrHandler;
+    void* pIsrArgs;
+    gpio_num_t wiredInput;
+} hostGpio_t;
+
+/* Static prototypes */
+static bool _isValid(gpio_num_t gpio);
+static bool _isTriggered(const hostGpio_t* pGpio, uint32_t previousLevel);
+
+/* Static variables */
+static hostGpio_t _gpios[GPIO_NUM_MAX] = { [0 ... GPIO_NUM_MAX - 1] = { .wiredInput = GPIO_NUM_NC } };
+static bool _isrServiceInstalled = false;
+
+/* Public functions */
+void vHOST_SetGpioLevel(gpio_num_t gpio, uint32_t level)
+{
+    uint32_t previousLevel = 0U;
+
+    if (_isValid(gpio)) {
+        /* Handler runs as an ISR would: nothing else is scheduled until it returns */
+        vPortEnterCritical();
+        previousLevel = _gpios[gpio].level;
+        _gpios[gpio].level = (level != 0U) ? 1U : 0U;
+        vHOST_RecordSample(HOST_SIGNAL_GPIO_INPUT, gpio, _gpios[gpio].level, esp_timer_get_time());
+        if (_isTriggered(&_gpios[gpio], previousLevel)) {
+            _gpios[gpio].isrHandler(_gpios[gpio].pIsrArgs);
+        }
+        vPortExitCritical();
+    }
+}
+
+void vHOST_WireGpio(gpio_num_t output, gpio_num_t input)
+{
+    if (_isValid(output) && _isValid(input)) {
+        _gpios[output].wiredInput = input;
+    }
+}
+
+esp_err_t gpio_config(const gpio_config_t* pGpioConfig)
+{
+    for (uint8_t gpio = 0U; gpio < GPIO_NUM_MAX; gpio++) {
+        if ((pGpioConfig->pin_bit_mask & BIT64(gpio)) != 0U) {
+            _gpios[gpio].mode = pGpioConfig->mode;
+            _gpios[gpio].intrType = pGpioConfig->intr_type;
+            _gpios[gpio].intrEnabled = (pGpioConfig->intr_type != GPIO_INTR_DISABLE);
+            /* Idle level of an undriven input */
+            if ((pGpioConfig->mode & GPIO_MODE_INPUT) && !(pGpioConfig->mode & GPIO_MODE_OUTPUT)) {
+                _gpios[gpio].level = (pGpioConfig->pull_up_en == GPIO_PULLUP_ENABLE) ? 1U : 0U;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    /* Wiring to an input is kept, it is the board, not the pin configuration */
+    if (_isValid(gpio)) {
+        _gpios[gpio].mode = GPIO_MODE_INPUT;
+        _gpios[gpio].intrType = GPIO_INTR_DISABLE;
+        _gpios[gpio].intrEnabled = false;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(gpio)) {
+        _gpios[gpio].mode = mode;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(gpio)) {
+        _gpios[gpio].level = (level != 0U) ? 1U : 0U;
+        vHOST_RecordSample(HOST_SIGNAL_GPIO_OUTPUT, gpio, _gpios[gpio].level, esp_timer_get_time());
+        if (_gpios[gpio].wiredInput != GPIO_NUM_NC) {
+            vHOST_SetGpioLevel(_gpios[gpio].wiredInput, level);
+        }
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+int gpio_get_level(gpio_num_t gpio)
+{
+    return _isValid(gpio) ? (int)_gpios[gpio].level : 0;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t intrType)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(gpio) && (intrType < GPIO_INTR_MAX)) {
+        _gpios[gpio].intrType = intrType;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(gpio)) {
+        _gpios[gpio].intrEnabled = true;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(gpio)) {
+        _gpios[gpio].intrEnabled = false;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_install_isr_service(int intrAllocFlags)
+{
+    esp_err_t result = ESP_ERR_INVALID_STATE;
+
+    (void)intrAllocFlags;
+    if (!_isrServiceInstalled) {
+        _isrServiceInstalled = true;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+void gpio_uninstall_isr_service(void)
+{
+    _isrServiceInstalled = false;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t isrHandler, void* pArgs)
+{
+    esp_err_t result = ESP_ERR_INVALID_STATE;
+
+    if (_isrServiceInstalled && _isValid(gpio)) {
+        vPortEnterCritical();
+        _gpios[gpio].isrHandler = isrHandler;
+        _gpios[gpio].pIsrArgs = pArgs;
+        vPortExitCritical();
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio)
+{
+    return gpio_isr_handler_add(gpio, NULL, NULL);
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t intrType)
+{
+    /* No sleep on the host */
+    return _isValid(gpio) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio)
+{
+    return _isValid(gpio) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+/* Static functions */
+static bool _isValid(gpio_num_t gpio)
+{
+    return (gpio >= GPIO_NUM_0) && (gpio < GPIO_NUM_MAX);
+}
+
+static bool _isTriggered(const hostGpio_t* pGpio, uint32_t previousLevel)
+{
+    bool result = false;
+
+    if (_isrServiceInstalled && pGpio->intrEnabled && (pGpio->isrHandler != NULL)) {
+        switch (pGpio->intrType) {
+        case GPIO_INTR_POSEDGE:
+            result = (previousLevel == 0U) && (pGpio->level == 1U);
+            break;
+        case GPIO_INTR_NEGEDGE:
+            result = (previousLevel == 1U) && (pGpio->level == 0U);
+            break;
+        case GPIO_INTR_ANYEDGE:
+            result = (previousLevel != pGpio->level);
+            break;
+        case GPIO_INTR_LOW_LEVEL:
+            result = (pGpio->level == 0U);
+            break;
+        case GPIO_INTR_HIGH_LEVEL:
+            result = (pGpio->level == 1U);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,168 @@
+/**
+******************************************************************************
+* @file 	hostLedc.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hostHarness.h"
+
+/* Define */
+#define HOST_NO_GPIO (-1)
+
+/* Struct */
+typedef struct {
+    int gpio;
+    uint32_t duty; /* Applied */
+    uint32_t pendingDuty; /* Set, waiting for update or fade start */
+    uint32_t fadeTimeMs;
+} hostLedcChannel_t;
+
+/* Static prototypes */
+static bool _isValid(ledc_mode_t speedMode, ledc_channel_t channel);
+static void _applyDuty(hostLedcChannel_t* pChannel, uint32_t duty, int64_t timestampUs);
+
+/* Static variables */
+static hostLedcChannel_t _channels[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX] = {
+    [0 ... LEDC_SPEED_MODE_MAX - 1] = { [0 ... LEDC_CHANNEL_MAX - 1] = { .gpio = HOST_NO_GPIO } }
+};
+static bool _fadeInstalled = false;
+
+/* Public functions */
+esp_err_t ledc_timer_config(const ledc_timer_config_t* pTimerConf)
+{
+    /* Duties are recorded in resolution steps, timer settings do not change the timeline */
+    return ((pTimerConf->speed_mode < LEDC_SPEED_MODE_MAX) && (pTimerConf->timer_num < LEDC_TIMER_MAX)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* pLedcConf)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    hostLedcChannel_t* pChannel = NULL;
+
+    if (_isValid(pLedcConf->speed_mode, pLedcConf->channel)) {
+        pChannel = &_channels[pLedcConf->speed_mode][pLedcConf->channel];
+        pChannel->gpio = pLedcConf->gpio_num;
+        pChannel->pendingDuty = pLedcConf->duty;
+        _applyDuty(pChannel, pLedcConf->duty, esp_timer_get_time());
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speedMode, ledc_channel_t channel, uint32_t duty)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(speedMode, channel)) {
+        _channels[speedMode][channel].pendingDuty = duty;
+        _channels[speedMode][channel].fadeTimeMs = 0U;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speedMode, ledc_channel_t channel)
+{
+    return _isValid(speedMode, channel) ? _channels[speedMode][channel].duty : 0U;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speedMode, ledc_channel_t channel)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(speedMode, channel)) {
+        _applyDuty(&_channels[speedMode][channel], _channels[speedMode][channel].pendingDuty, esp_timer_get_time());
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speedMode, ledc_channel_t channel, uint32_t idleLevel)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(speedMode, channel)) {
+        _applyDuty(&_channels[speedMode][channel], (idleLevel != 0U) ? UINT32_MAX : 0U, esp_timer_get_time());
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t ledc_fade_func_install(int intrAllocFlags)
+{
+    esp_err_t result = ESP_FAIL;
+
+    (void)intrAllocFlags;
+    if (!_fadeInstalled) {
+        _fadeInstalled = true;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+void ledc_fade_func_uninstall(void)
+{
+    _fadeInstalled = false;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speedMode, ledc_channel_t channel, uint32_t targetDuty, int maxFadeTimeMs)
+{
+    esp_err_t result = ESP_ERR_INVALID_STATE;
+
+    if (!_isValid(speedMode, channel)) {
+        result = ESP_ERR_INVALID_ARG;
+    } else if (_fadeInstalled) {
+        _channels[speedMode][channel].pendingDuty = targetDuty;
+        _channels[speedMode][channel].fadeTimeMs = (maxFadeTimeMs > 0) ? (uint32_t)maxFadeTimeMs : 0U;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speedMode, ledc_channel_t channel, ledc_fade_mode_t fadeMode)
+{
+    esp_err_t result = ESP_ERR_INVALID_STATE;
+    hostLedcChannel_t* pChannel = NULL;
+
+    if (!_isValid(speedMode, channel)) {
+        result = ESP_ERR_INVALID_ARG;
+    } else if (_fadeInstalled) {
+        pChannel = &_channels[speedMode][channel];
+        /* Fade is recorded as its target, reached at the end of the fade */
+        _applyDuty(pChannel, pChannel->pendingDuty, esp_timer_get_time() + (int64_t)pChannel->fadeTimeMs * 1000LL);
+        if (fadeMode == LEDC_FADE_WAIT_DONE) {
+            vTaskDelay(pdMS_TO_TICKS(pChannel->fadeTimeMs));
+        }
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+/* Static functions */
+static bool _isValid(ledc_mode_t speedMode, ledc_channel_t channel)
+{
+    return (speedMode < LEDC_SPEED_MODE_MAX) && (channel < LEDC_CHANNEL_MAX);
+}
+
+static void _applyDuty(hostLedcChannel_t* pChannel, uint32_t duty, int64_t timestampUs)
+{
+    vPortEnterCritical();
+    pChannel->duty = duty;
+    if (pChannel->gpio != HOST_NO_GPIO) {
+        vHOST_RecordSample(HOST_SIGNAL_LEDC, pChannel->gpio, duty, timestampUs);
+    }
+    vPortExitCritical();
+}
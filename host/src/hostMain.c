@@ -0,0 +1,341 @@
+/**
+******************************************************************************
+* @file 	hostMain.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "hostHarness.h"
+#include "inputLog.h"
+#include "mapping.h"
+#include "system_def.h"
+
+/* Define */
+#define TAG_HOST ("HOST")
+#define HOST_MAIN_TASK_STACK_SIZE (3584U) /* CONFIG_ESP_MAIN_TASK_STACK_SIZE */
+#define HOST_MAIN_TASK_PRIORITY (1U) /* Same as the ESP-IDF main task */
+#define HOST_SCRIPT_TASK_STACK_SIZE (4096U)
+#define HOST_SCRIPT_TASK_PRIORITY (configMAX_PRIORITIES - 1U) /* Injected edges preempt the firmware, as interrupts do */
+#define HOST_SCRIPT_MAX_COMMANDS (256U)
+#define HOST_SCRIPT_LINE_LENGTH (128U)
+#define HOST_SCRIPT_TAIL_MS (2000U) /* Run time after the last command of a script without end */
+#define HOST_REPLAY_LINE_LENGTH (256U)
+#define HOST_REPLAY_POLL_TICKS (pdMS_TO_TICKS(100U))
+
+/* Enum */
+typedef enum {
+    HOST_COMMAND_LEVEL = 0,
+    HOST_COMMAND_END,
+    HOST_COMMAND_EXPECT_STOPPED,
+} hostCommand_e;
+
+/* Struct */
+typedef struct {
+    uint32_t timeMs; /* From the end of app_main, all modules are ready */
+    hostCommand_e type;
+    gpio_num_t gpio;
+    uint32_t level;
+} hostCommand_t;
+
+typedef struct {
+    const char* name;
+    gpio_num_t gpio;
+} hostButton_t;
+
+/* Static prototypes */
+static void _mainTask(void* pvParameters);
+static void _scriptTask(void* pvParameters);
+static bool _loadScript(const char* path);
+static bool _loadReplay(const char* path);
+static bool _parseLine(char* line, hostCommand_t* pCommand);
+static bool _parseGpio(const char* name, gpio_num_t* pGpio);
+static void _writeTimeline(void);
+static void _printUsage(const char* program);
+
+/* Static variables */
+static const hostButton_t _buttons[] = {
+    { "GO", BUTTON_GO_GPIO_NUM },
+    { "RESET", BUTTON_RESET_GPIO_NUM },
+    { "BACK", BUTTON_BACK_GPIO_NUM },
+    { "FORWARD", BUTTON_FORWARD_GPIO_NUM },
+    { "BACKWARD", BUTTON_BACKWARD_GPIO_NUM },
+    { "LEFT", BUTTON_LEFT_GPIO_NUM },
+    { "RIGHT", BUTTON_RIGHT_GPIO_NUM },
+};
+static hostCommand_t _script[HOST_SCRIPT_MAX_COMMANDS] = { 0 };
+static uint32_t _commandNumber = 0U;
+static const char* _timelinePath = "timeline.csv";
+static uint8_t* _pReplayLog = NULL;
+
+extern void app_main(void);
+
+/* Public functions */
+int main(int argc, char* argv[])
+{
+    const char* scriptPath = NULL;
+    const char* replayPath = NULL;
+    int option = 0;
+
+    while ((option = getopt(argc, argv, "s:r:o:h")) != -1) {
+        switch (option) {
+        case 's':
+            scriptPath = optarg;
+            break;
+        case 'r':
+            replayPath = optarg;
+            break;
+        case 'o':
+            _timelinePath = optarg;
+            break;
+        default:
+            _printUsage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((scriptPath != NULL) && (replayPath != NULL)) {
+        fprintf(stderr, "A script and a replay cannot drive the buttons together\n");
+        return EXIT_FAILURE;
+    }
+    if ((scriptPath != NULL) && !_loadScript(scriptPath)) {
+        return EXIT_FAILURE;
+    }
+    if ((replayPath != NULL) && !_loadReplay(replayPath)) {
+        return EXIT_FAILURE;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    xTaskCreate(_mainTask, "main", HOST_MAIN_TASK_STACK_SIZE, NULL, HOST_MAIN_TASK_PRIORITY, NULL);
+    vTaskStartScheduler();
+
+    return EXIT_FAILURE;
+}
+
+/* Static functions */
+static void _mainTask(void* pvParameters)
+{
+    /* Jumper of the benchmark edge generator */
+    vHOST_WireGpio(BENCH_EDGE_GPIO_NUM, BENCH_EDGE_TARGET_GPIO_NUM);
+    app_main();
+    /* Without script the firmware runs until the process is killed */
+    if (_commandNumber > 0U) {
+        xTaskCreate(_scriptTask, "Host script", HOST_SCRIPT_TASK_STACK_SIZE, NULL, HOST_SCRIPT_TASK_PRIORITY, NULL);
+    } else if (_pReplayLog != NULL) {
+        /* The replay started with the log in app_main, the last reaction settles as after a script */
+        while (bILOG_IsReplaying()) {
+            vTaskDelay(HOST_REPLAY_POLL_TICKS);
+        }
+        vTaskDelay(pdMS_TO_TICKS(HOST_SCRIPT_TAIL_MS));
+        _writeTimeline();
+        fflush(NULL);
+        exit(EXIT_SUCCESS);
+    }
+    vTaskDelete(NULL);
+}
+
+static void _scriptTask(void* pvParameters)
+{
+    TickType_t lastWakeTime = xTaskGetTickCount();
+    TickType_t elapsedTicks = 0U;
+    TickType_t commandTicks = 0U;
+    bool result = true;
+
+    for (uint32_t index = 0U; index < _commandNumber; index++) {
+        commandTicks = pdMS_TO_TICKS(_script[index].timeMs);
+        if (commandTicks > elapsedTicks) {
+            vTaskDelayUntil(&lastWakeTime, commandTicks - elapsedTicks);
+            elapsedTicks = commandTicks;
+        }
+        if (_script[index].type == HOST_COMMAND_END) {
+            break;
+        } else if (_script[index].type == HOST_COMMAND_EXPECT_STOPPED) {
+            if (!bHOST_AreMcpwmOutputsLow()) {
+                ESP_LOGE(TAG_HOST, "Wheels still driven at %u ms", _script[index].timeMs);
+                result = false;
+            }
+        } else {
+            vHOST_SetGpioLevel(_script[index].gpio, _script[index].level);
+        }
+    }
+
+    _writeTimeline();
+    fflush(NULL);
+    exit(result ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool _loadScript(const char* path)
+{
+    FILE* pFile = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    char line[HOST_SCRIPT_LINE_LENGTH];
+    uint32_t lineNumber = 0U;
+    bool result = (pFile != NULL);
+
+    if (pFile == NULL) {
+        fprintf(stderr, "Cannot open script %s\n", path);
+    }
+    while (result && (fgets(line, sizeof(line), pFile) != NULL)) {
+        lineNumber++;
+        if (strchr(line, '#') != NULL) {
+            *strchr(line, '#') = '\0';
+        }
+        if (strspn(line, " \t\r\n") == strlen(line)) {
+            continue;
+        }
+        if (_commandNumber >= (HOST_SCRIPT_MAX_COMMANDS - 1U)) {
+            fprintf(stderr, "%s:%u: more than %u commands\n", path, lineNumber, HOST_SCRIPT_MAX_COMMANDS - 1U);
+            result = false;
+        } else if (!_parseLine(line, &_script[_commandNumber])) {
+            fprintf(stderr, "%s:%u: cannot parse command\n", path, lineNumber);
+            result = false;
+        } else if ((_commandNumber > 0U) && (_script[_commandNumber].timeMs < _script[_commandNumber - 1U].timeMs)) {
+            fprintf(stderr, "%s:%u: commands must be in time order\n", path, lineNumber);
+            result = false;
+        } else {
+            _commandNumber++;
+        }
+    }
+
+    /* Let the last reaction settle before the timeline is written */
+    if (result && ((_commandNumber == 0U) || (_script[_commandNumber - 1U].type != HOST_COMMAND_END))) {
+        _script[_commandNumber].timeMs = (_commandNumber > 0U) ? (_script[_commandNumber - 1U].timeMs + HOST_SCRIPT_TAIL_MS) : HOST_SCRIPT_TAIL_MS;
+        _script[_commandNumber].type = HOST_COMMAND_END;
+        _commandNumber++;
+    }
+    if ((pFile != NULL) && (pFile != stdin)) {
+        fclose(pFile);
+    }
+
+    return result;
+}
+
+/* Console capture of a previous run: the "@IL" lines hold the log, everything else is skipped */
+static bool _loadReplay(const char* path)
+{
+    FILE* pFile = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    char line[HOST_REPLAY_LINE_LENGTH];
+    uint32_t length = 0U;
+    uint32_t capacity = 0U;
+    unsigned int byte = 0U;
+    bool result = (pFile != NULL);
+
+    if (pFile == NULL) {
+        fprintf(stderr, "Cannot open replay %s\n", path);
+    }
+    while (result && (fgets(line, sizeof(line), pFile) != NULL)) {
+        if (strncmp(line, "@IL ", 4U) != 0) {
+            continue;
+        }
+        for (const char* pHex = &line[4]; result && (sscanf(pHex, "%2x", &byte) == 1); pHex += 2) {
+            if (length == capacity) {
+                capacity = (capacity > 0U) ? (2U * capacity) : HOST_REPLAY_LINE_LENGTH;
+                _pReplayLog = realloc(_pReplayLog, capacity);
+                result = (_pReplayLog != NULL);
+            }
+            if (result) {
+                _pReplayLog[length++] = (uint8_t)byte;
+            }
+        }
+    }
+
+    if (result && (length == 0U)) {
+        fprintf(stderr, "No input log in %s, capture with SYSTEM_INPUT_LOG_ENABLED set\n", path);
+        result = false;
+    }
+    /* Kept until the process ends, the replay reads it in place */
+    result = result && bILOG_LoadReplay(_pReplayLog, length);
+    if ((pFile != NULL) && (pFile != stdin)) {
+        fclose(pFile);
+    }
+
+    return result;
+}
+
+static bool _parseLine(char* line, hostCommand_t* pCommand)
+{
+    char command[16] = { 0 };
+    char argument[16] = { 0 };
+    unsigned int timeMs = 0U;
+    unsigned int level = 0U;
+    int fields = sscanf(line, "%u %15s %15s %u", &timeMs, command, argument, &level);
+    bool result = false;
+
+    pCommand->timeMs = timeMs;
+    if ((fields == 2) && (strcasecmp(command, "end") == 0)) {
+        pCommand->type = HOST_COMMAND_END;
+        result = true;
+    } else if ((fields == 3) && (strcasecmp(command, "expect") == 0) && (strcasecmp(argument, "stopped") == 0)) {
+        /* Checked when reached, a failed check makes the run exit with an error */
+        pCommand->type = HOST_COMMAND_EXPECT_STOPPED;
+        result = true;
+    } else if ((fields == 3) && (strcasecmp(command, "press") == 0)) {
+        /* Buttons are pulled down, pressed is high */
+        pCommand->type = HOST_COMMAND_LEVEL;
+        pCommand->level = 1U;
+        result = _parseGpio(argument, &pCommand->gpio);
+    } else if ((fields == 3) && (strcasecmp(command, "release") == 0)) {
+        pCommand->type = HOST_COMMAND_LEVEL;
+        pCommand->level = 0U;
+        result = _parseGpio(argument, &pCommand->gpio);
+    } else if ((fields == 4) && (strcasecmp(command, "level") == 0)) {
+        pCommand->type = HOST_COMMAND_LEVEL;
+        pCommand->level = level;
+        result = _parseGpio(argument, &pCommand->gpio);
+    }
+
+    return result;
+}
+
+static bool _parseGpio(const char* name, gpio_num_t* pGpio)
+{
+    char* pEnd = NULL;
+    unsigned long gpio = 0UL;
+    bool result = false;
+
+    for (uint8_t index = 0U; index < (sizeof(_buttons) / sizeof(_buttons[0])); index++) {
+        if (strcasecmp(name, _buttons[index].name) == 0) {
+            *pGpio = _buttons[index].gpio;
+            result = true;
+            break;
+        }
+    }
+    if (!result) {
+        gpio = strtoul(name, &pEnd, 10);
+        if ((*pEnd == '\0') && (gpio < GPIO_NUM_MAX)) {
+            *pGpio = (gpio_num_t)gpio;
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+static void _writeTimeline(void)
+{
+    FILE* pFile = fopen(_timelinePath, "w");
+
+    if (pFile != NULL) {
+        vHOST_WriteTimeline(pFile);
+        fclose(pFile);
+        ESP_LOGI(TAG_HOST, "Timeline written to %s", _timelinePath);
+    } else {
+        ESP_LOGE(TAG_HOST, "Cannot write timeline to %s", _timelinePath);
+    }
+}
+
+static void _printUsage(const char* program)
+{
+    printf("Usage: %s [-s script | -r capture.log] [-o timeline.csv]\n", program);
+    printf("  -s  button script, '-' for stdin. Without script nor replay the firmware runs until killed\n");
+    printf("  -r  console output of a previous run, its inputs are replayed at their original ticks\n");
+    printf("  -o  output timeline, default timeline.csv\n");
+    printf("Script lines, times in ms after all modules are ready, 10 ms resolution:\n");
+    printf("  <time> press|release GO|RESET|BACK|FORWARD|BACKWARD|LEFT|RIGHT|<gpio>\n");
+    printf("  <time> level <button|gpio> <0|1>\n");
+    printf("  <time> expect stopped (the run fails if a servo output still drives a pulse)\n");
+    printf("  <time> end\n");
+}
@@ -0,0 +1,223 @@
+/**
+******************************************************************************
+* @file 	hostMcpwm.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "driver/mcpwm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "hostHarness.h"
+
+/* Define */
+#define HOST_NO_GPIO (-1)
+#define US_PER_SECOND (1000000U)
+
+/* Struct */
+typedef struct {
+    uint32_t frequency;
+    bool running;
+    int gpio[MCPWM_OPR_MAX];
+    uint32_t pulseUs[MCPWM_OPR_MAX];
+    mcpwm_duty_type_t dutyType[MCPWM_OPR_MAX];
+} hostMcpwmTimer_t;
+
+/* Static prototypes */
+static bool _isValid(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum);
+static void _setPulse(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, uint32_t pulseUs);
+static uint32_t _getPeriodUs(const hostMcpwmTimer_t* pTimer);
+static uint32_t _getOutputUs(const hostMcpwmTimer_t* pTimer, mcpwm_operator_t opNum);
+
+/* Static variables */
+static hostMcpwmTimer_t _timers[MCPWM_UNIT_MAX][MCPWM_TIMER_MAX] = {
+    [0 ... MCPWM_UNIT_MAX - 1] = { [0 ... MCPWM_TIMER_MAX - 1] = { .gpio = { [0 ... MCPWM_OPR_MAX - 1] = HOST_NO_GPIO } } }
+};
+
+/* Public functions */
+esp_err_t mcpwm_gpio_init(mcpwm_unit_t mcpwmNum, mcpwm_io_signals_t ioSignal, int gpioNum)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    /* MCPWMxA and MCPWMxB are the outputs of operator pair x */
+    if ((mcpwmNum < MCPWM_UNIT_MAX) && (ioSignal <= MCPWM2B)) {
+        _timers[mcpwmNum][ioSignal / MCPWM_OPR_MAX].gpio[ioSignal % MCPWM_OPR_MAX] = gpioNum;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_init(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, const mcpwm_config_t* pMcpwmConf)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    hostMcpwmTimer_t* pTimer = NULL;
+
+    if (_isValid(mcpwmNum, timerNum, MCPWM_OPR_A) && (pMcpwmConf->frequency > 0U)) {
+        pTimer = &_timers[mcpwmNum][timerNum];
+        pTimer->frequency = pMcpwmConf->frequency;
+        pTimer->running = true;
+        _setPulse(mcpwmNum, timerNum, MCPWM_OPR_A, (uint32_t)(pMcpwmConf->cmpr_a * _getPeriodUs(pTimer) / 100.0F));
+        _setPulse(mcpwmNum, timerNum, MCPWM_OPR_B, (uint32_t)(pMcpwmConf->cmpr_b * _getPeriodUs(pTimer) / 100.0F));
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_set_frequency(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, uint32_t frequency)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(mcpwmNum, timerNum, MCPWM_OPR_A) && (frequency > 0U)) {
+        _timers[mcpwmNum][timerNum].frequency = frequency;
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_set_duty(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, float duty)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(mcpwmNum, timerNum, opNum)) {
+        _setPulse(mcpwmNum, timerNum, opNum, (uint32_t)(duty * _getPeriodUs(&_timers[mcpwmNum][timerNum]) / 100.0F));
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_set_duty_in_us(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, uint32_t dutyInUs)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(mcpwmNum, timerNum, opNum)) {
+        _setPulse(mcpwmNum, timerNum, opNum, dutyInUs);
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_set_duty_type(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, mcpwm_duty_type_t dutyType)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isValid(mcpwmNum, timerNum, opNum) && (dutyType < MCPWM_DUTY_MODE_MAX)) {
+        /* Forced levels keep the programmed pulse for the return to a duty mode */
+        _timers[mcpwmNum][timerNum].dutyType[opNum] = dutyType;
+        _setPulse(mcpwmNum, timerNum, opNum, _timers[mcpwmNum][timerNum].pulseUs[opNum]);
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_set_signal_low(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum)
+{
+    return mcpwm_set_duty_type(mcpwmNum, timerNum, opNum, MCPWM_HAL_GENERATOR_MODE_FORCE_LOW);
+}
+
+esp_err_t mcpwm_set_signal_high(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum)
+{
+    return mcpwm_set_duty_type(mcpwmNum, timerNum, opNum, MCPWM_HAL_GENERATOR_MODE_FORCE_HIGH);
+}
+
+esp_err_t mcpwm_start(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    hostMcpwmTimer_t* pTimer = NULL;
+
+    if (_isValid(mcpwmNum, timerNum, MCPWM_OPR_A)) {
+        pTimer = &_timers[mcpwmNum][timerNum];
+        pTimer->running = true;
+        for (uint8_t opNum = 0U; opNum < MCPWM_OPR_MAX; opNum++) {
+            _setPulse(mcpwmNum, timerNum, opNum, pTimer->pulseUs[opNum]);
+        }
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t mcpwm_stop(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    hostMcpwmTimer_t* pTimer = NULL;
+
+    if (_isValid(mcpwmNum, timerNum, MCPWM_OPR_A)) {
+        pTimer = &_timers[mcpwmNum][timerNum];
+        vPortEnterCritical();
+        pTimer->running = false;
+        /* Stopped outputs stay low, programmed pulses are kept for the next start */
+        for (uint8_t opNum = 0U; opNum < MCPWM_OPR_MAX; opNum++) {
+            if (pTimer->gpio[opNum] != HOST_NO_GPIO) {
+                vHOST_RecordSample(HOST_SIGNAL_MCPWM, pTimer->gpio[opNum], 0U, esp_timer_get_time());
+            }
+        }
+        vPortExitCritical();
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+bool bHOST_AreMcpwmOutputsLow(void)
+{
+    bool result = true;
+
+    vPortEnterCritical();
+    for (uint8_t mcpwmNum = 0U; mcpwmNum < MCPWM_UNIT_MAX; mcpwmNum++) {
+        for (uint8_t timerNum = 0U; timerNum < MCPWM_TIMER_MAX; timerNum++) {
+            for (uint8_t opNum = 0U; opNum < MCPWM_OPR_MAX; opNum++) {
+                if (_timers[mcpwmNum][timerNum].running && (_timers[mcpwmNum][timerNum].gpio[opNum] != HOST_NO_GPIO)
+                    && (_getOutputUs(&_timers[mcpwmNum][timerNum], opNum) > 0U)) {
+                    result = false;
+                }
+            }
+        }
+    }
+    vPortExitCritical();
+
+    return result;
+}
+
+/* Static functions */
+static bool _isValid(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum)
+{
+    return (mcpwmNum < MCPWM_UNIT_MAX) && (timerNum < MCPWM_TIMER_MAX) && (opNum < MCPWM_OPR_MAX);
+}
+
+static void _setPulse(mcpwm_unit_t mcpwmNum, mcpwm_timer_t timerNum, mcpwm_operator_t opNum, uint32_t pulseUs)
+{
+    hostMcpwmTimer_t* pTimer = &_timers[mcpwmNum][timerNum];
+
+    vPortEnterCritical();
+    pTimer->pulseUs[opNum] = pulseUs;
+    /* Outputs not routed to a pin drive nothing */
+    if (pTimer->running && (pTimer->gpio[opNum] != HOST_NO_GPIO)) {
+        vHOST_RecordSample(HOST_SIGNAL_MCPWM, pTimer->gpio[opNum], _getOutputUs(pTimer, opNum), esp_timer_get_time());
+    }
+    vPortExitCritical();
+}
+
+static uint32_t _getPeriodUs(const hostMcpwmTimer_t* pTimer)
+{
+    return (pTimer->frequency > 0U) ? (US_PER_SECOND / pTimer->frequency) : 0U;
+}
+
+static uint32_t _getOutputUs(const hostMcpwmTimer_t* pTimer, mcpwm_operator_t opNum)
+{
+    uint32_t result = pTimer->pulseUs[opNum];
+
+    if (pTimer->dutyType[opNum] == MCPWM_HAL_GENERATOR_MODE_FORCE_LOW) {
+        result = 0U;
+    } else if (pTimer->dutyType[opNum] == MCPWM_HAL_GENERATOR_MODE_FORCE_HIGH) {
+        result = _getPeriodUs(pTimer);
+    }
+
+    return result;
+}
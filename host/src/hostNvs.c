@@ -0,0 +1,184 @@
+/**
+******************************************************************************
+* @file 	hostNvs.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "nvs_flash.h"
+
+/* Define */
+#define HOST_NVS_MAX_ENTRIES (16U)
+#define HOST_NVS_MAX_BLOB_SIZE (128U)
+#define HOST_NVS_MAX_NAMESPACES (8U)
+#define HOST_NVS_READ_ONLY_FLAG (0x80000000U) /* Handles are namespace index + 1, with the open mode on top */
+
+/* Struct */
+typedef struct {
+    bool used;
+    uint8_t namespaceIndex;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint8_t value[HOST_NVS_MAX_BLOB_SIZE];
+    size_t length;
+} hostNvsEntry_t;
+
+/* Static prototypes */
+static bool _getNamespace(nvs_handle_t handle, uint8_t* pNamespaceIndex);
+static hostNvsEntry_t* _findEntry(uint8_t namespaceIndex, const char* pKey);
+
+/* Static variables */
+static char _namespaces[HOST_NVS_MAX_NAMESPACES][NVS_KEY_NAME_MAX_SIZE] = { 0 };
+static hostNvsEntry_t _entries[HOST_NVS_MAX_ENTRIES] = { 0 };
+static bool _initialized = false;
+
+/* Public functions */
+esp_err_t nvs_flash_init(void)
+{
+    _initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    vPortEnterCritical();
+    memset(_namespaces, 0, sizeof(_namespaces));
+    memset(_entries, 0, sizeof(_entries));
+    vPortExitCritical();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* pName, nvs_open_mode_t openMode, nvs_handle_t* pHandle)
+{
+    esp_err_t result = ESP_ERR_NVS_NOT_FOUND;
+    uint8_t index = 0U;
+
+    if (!_initialized) {
+        result = ESP_ERR_INVALID_STATE;
+    } else if (strlen(pName) >= NVS_KEY_NAME_MAX_SIZE) {
+        result = ESP_ERR_INVALID_ARG;
+    } else {
+        vPortEnterCritical();
+        index = 0U;
+        while ((index < HOST_NVS_MAX_NAMESPACES) && (_namespaces[index][0] != '\0') && (strcmp(_namespaces[index], pName) != 0)) {
+            index++;
+        }
+        /* As on the target, a namespace is only created by a read-write open */
+        if ((index < HOST_NVS_MAX_NAMESPACES) && (_namespaces[index][0] == '\0') && (openMode == NVS_READWRITE)) {
+            strcpy(_namespaces[index], pName);
+        }
+        if ((index < HOST_NVS_MAX_NAMESPACES) && (_namespaces[index][0] != '\0')) {
+            *pHandle = (index + 1U) | ((openMode == NVS_READONLY) ? HOST_NVS_READ_ONLY_FLAG : 0U);
+            result = ESP_OK;
+        } else if (index >= HOST_NVS_MAX_NAMESPACES) {
+            result = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+        vPortExitCritical();
+    }
+
+    return result;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* pKey, const void* pValue, size_t length)
+{
+    esp_err_t result = ESP_ERR_NVS_INVALID_HANDLE;
+    hostNvsEntry_t* pEntry = NULL;
+    uint8_t namespaceIndex = 0U;
+
+    if (_getNamespace(handle, &namespaceIndex)) {
+        vPortEnterCritical();
+        pEntry = _findEntry(namespaceIndex, pKey);
+        for (uint8_t index = 0U; (pEntry == NULL) && (index < HOST_NVS_MAX_ENTRIES); index++) {
+            if (!_entries[index].used) {
+                pEntry = &_entries[index];
+            }
+        }
+        if ((handle & HOST_NVS_READ_ONLY_FLAG) != 0U) {
+            result = ESP_ERR_NVS_READ_ONLY;
+        } else if ((length > HOST_NVS_MAX_BLOB_SIZE) || (strlen(pKey) >= NVS_KEY_NAME_MAX_SIZE)) {
+            result = ESP_ERR_NVS_INVALID_LENGTH;
+        } else if (pEntry == NULL) {
+            result = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        } else {
+            pEntry->used = true;
+            pEntry->namespaceIndex = namespaceIndex;
+            strcpy(pEntry->key, pKey);
+            memcpy(pEntry->value, pValue, length);
+            pEntry->length = length;
+            result = ESP_OK;
+        }
+        vPortExitCritical();
+    }
+
+    return result;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* pKey, void* pValue, size_t* pLength)
+{
+    esp_err_t result = ESP_ERR_NVS_INVALID_HANDLE;
+    hostNvsEntry_t* pEntry = NULL;
+    uint8_t namespaceIndex = 0U;
+
+    if (_getNamespace(handle, &namespaceIndex)) {
+        vPortEnterCritical();
+        pEntry = _findEntry(namespaceIndex, pKey);
+        if (pEntry == NULL) {
+            result = ESP_ERR_NVS_NOT_FOUND;
+        } else if (pValue == NULL) {
+            /* Length query */
+            *pLength = pEntry->length;
+            result = ESP_OK;
+        } else if (*pLength < pEntry->length) {
+            result = ESP_ERR_NVS_INVALID_LENGTH;
+        } else {
+            memcpy(pValue, pEntry->value, pEntry->length);
+            *pLength = pEntry->length;
+            result = ESP_OK;
+        }
+        vPortExitCritical();
+    }
+
+    return result;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    uint8_t namespaceIndex = 0U;
+
+    return _getNamespace(handle, &namespaceIndex) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+/* Static functions */
+static bool _getNamespace(nvs_handle_t handle, uint8_t* pNamespaceIndex)
+{
+    uint32_t index = handle & ~HOST_NVS_READ_ONLY_FLAG;
+    bool result = (index > 0U) && (index <= HOST_NVS_MAX_NAMESPACES);
+
+    if (result) {
+        *pNamespaceIndex = (uint8_t)(index - 1U);
+    }
+
+    return result;
+}
+
+static hostNvsEntry_t* _findEntry(uint8_t namespaceIndex, const char* pKey)
+{
+    hostNvsEntry_t* result = NULL;
+
+    for (uint8_t index = 0U; (index < HOST_NVS_MAX_ENTRIES) && (result == NULL); index++) {
+        if (_entries[index].used && (_entries[index].namespaceIndex == namespaceIndex) && (strcmp(_entries[index].key, pKey) == 0)) {
+            result = &_entries[index];
+        }
+    }
+
+    return result;
+}
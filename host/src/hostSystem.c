@@ -0,0 +1,113 @@
+/**
+******************************************************************************
+* @file 	hostSystem.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "esp32/rom/ets_sys.h"
+#include "esp_ipc.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "xtensa/hal.h"
+
+/* Static prototypes */
+static void _initClock(void) __attribute__((constructor));
+
+/* Static variables */
+static struct timespec _startTime = { 0 };
+static esp_log_level_t _logLevel = ESP_LOG_VERBOSE;
+
+/* Public functions */
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)(now.tv_sec - _startTime.tv_sec) * 1000000LL) + ((now.tv_nsec - _startTime.tv_nsec) / 1000LL);
+}
+
+uint32_t xthal_get_ccount(void)
+{
+    return (uint32_t)(esp_timer_get_time() * CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ);
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000LL);
+}
+
+uint32_t esp_log_early_timestamp(void)
+{
+    return esp_log_timestamp();
+}
+
+void esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+    /* No per tag filtering on the host */
+    (void)tag;
+    _logLevel = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    va_list args;
+
+    (void)tag;
+    if (level <= _logLevel) {
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+    }
+}
+
+void esp_restart(void)
+{
+    fflush(NULL);
+    exit(EXIT_SUCCESS);
+}
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpuId, esp_ipc_func_t function, void* pArg)
+{
+    function(pArg);
+    return ESP_OK;
+}
+
+void ets_delay_us(uint32_t us)
+{
+    int64_t endUs = esp_timer_get_time() + us;
+
+    while (esp_timer_get_time() < endUs) {
+    }
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return (uint32_t)xPortGetFreeHeapSize();
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return (uint32_t)xPortGetMinimumEverFreeHeapSize();
+}
+
+void vHOST_AssertCalled(const char* file, unsigned long line)
+{
+    fprintf(stderr, "Assert failed: %s:%lu\n", file, line);
+    fflush(NULL);
+    abort();
+}
+
+/* Static functions */
+static void _initClock(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &_startTime);
+}
@@ -0,0 +1,70 @@
+/**
+******************************************************************************
+* @file 	hostTimeline.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "hostHarness.h"
+
+/* Static variables */
+static const char* _signalNames[HOST_SIGNAL_NUMBER] = {
+    [HOST_SIGNAL_GPIO_INPUT] = "in",
+    [HOST_SIGNAL_GPIO_OUTPUT] = "out",
+    [HOST_SIGNAL_MCPWM] = "mcpwm",
+    [HOST_SIGNAL_LEDC] = "ledc",
+};
+static hostSample_t _timeline[HOST_TIMELINE_MAX_SAMPLES] = { 0 };
+static uint32_t _sampleNumber = 0U;
+static uint32_t _droppedSamples = 0U;
+
+/* Public functions */
+void vHOST_RecordSample(hostSignal_e signal, uint32_t gpio, uint32_t value, int64_t timestampUs)
+{
+    uint32_t position = 0U;
+
+    vPortEnterCritical();
+    if (_sampleNumber < HOST_TIMELINE_MAX_SAMPLES) {
+        /* Kept time ordered, only fade ends are recorded ahead of time */
+        position = _sampleNumber;
+        while ((position > 0U) && (_timeline[position - 1U].timestampUs > timestampUs)) {
+            position--;
+        }
+        memmove(&_timeline[position + 1U], &_timeline[position], (_sampleNumber - position) * sizeof(hostSample_t));
+        _timeline[position].timestampUs = timestampUs;
+        _timeline[position].signal = signal;
+        _timeline[position].gpio = gpio;
+        _timeline[position].value = value;
+        _sampleNumber++;
+    } else {
+        _droppedSamples++;
+    }
+    vPortExitCritical();
+}
+
+uint32_t u32HOST_GetTimeline(hostSample_t* pSamples, uint32_t maxSamples)
+{
+    uint32_t sampleNumber = 0U;
+
+    vPortEnterCritical();
+    sampleNumber = (_sampleNumber < maxSamples) ? _sampleNumber : maxSamples;
+    memcpy(pSamples, _timeline, sampleNumber * sizeof(hostSample_t));
+    vPortExitCritical();
+
+    return sampleNumber;
+}
+
+void vHOST_WriteTimeline(FILE* pFile)
+{
+    fprintf(pFile, "time_us,signal,gpio,value\n");
+    for (uint32_t index = 0U; index < _sampleNumber; index++) {
+        fprintf(pFile, "%lld,%s,%u,%u\n", (long long)_timeline[index].timestampUs, _signalNames[_timeline[index].signal], _timeline[index].gpio, _timeline[index].value);
+    }
+    if (_droppedSamples > 0U) {
+        fprintf(stderr, "%u timeline samples dropped\n", _droppedSamples);
+    }
+}
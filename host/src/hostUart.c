@@ -0,0 +1,241 @@
+/**
+******************************************************************************
+* @file 	hostUart.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+/* Define */
+#define HOST_UART_BUFFER_SIZE (4096U)
+#define HOST_UART_TASK_STACK_SIZE (4096U)
+#define HOST_UART_TASK_PRIORITY (configMAX_PRIORITIES - 1U) /* Bytes come in as the RX interrupt would */
+#define HOST_UART_POLL_TICKS (1U)
+
+/* Struct */
+typedef struct {
+    bool installed;
+    int masterFd;
+    int slaveFd; /* Kept open: raw mode stays set and reads do not fail while no client is connected */
+    uint8_t rxBuffer[HOST_UART_BUFFER_SIZE];
+    uint32_t rxCapacity;
+    uint32_t rxHead; /* Free running */
+    uint32_t rxTail; /* Free running */
+    QueueHandle_t eventQueue;
+} hostUart_t;
+
+/* Static prototypes */
+static bool _isInstalled(uart_port_t uartNum);
+static bool _openPseudoTerminal(hostUart_t* pUart, uart_port_t uartNum);
+static void _rxTask(void* pvParameters);
+static void _postEvent(hostUart_t* pUart, uart_event_type_t type, size_t size);
+
+/* Static variables */
+static hostUart_t _uarts[UART_NUM_MAX] = { 0 };
+
+/* Public functions */
+esp_err_t uart_param_config(uart_port_t uartNum, const uart_config_t* pUartConfig)
+{
+    /* Baud rate and format do not apply to a pseudo-terminal */
+    return ((uartNum < UART_NUM_MAX) && (pUartConfig != NULL)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_pin(uart_port_t uartNum, int txIoNum, int rxIoNum, int rtsIoNum, int ctsIoNum)
+{
+    return (uartNum < UART_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_driver_install(uart_port_t uartNum, int rxBufferSize, int txBufferSize, int queueSize, QueueHandle_t* pUartQueue, int intrAllocFlags)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+    hostUart_t* pUart = NULL;
+
+    if ((uartNum < UART_NUM_MAX) && (rxBufferSize > UART_FIFO_LEN) && !_uarts[uartNum].installed) {
+        pUart = &_uarts[uartNum];
+        pUart->rxCapacity = ((uint32_t)rxBufferSize < HOST_UART_BUFFER_SIZE) ? (uint32_t)rxBufferSize : HOST_UART_BUFFER_SIZE;
+        pUart->rxHead = 0U;
+        pUart->rxTail = 0U;
+        pUart->eventQueue = (pUartQueue != NULL) ? xQueueCreate(queueSize, sizeof(uart_event_t)) : NULL;
+        if (pUartQueue != NULL) {
+            *pUartQueue = pUart->eventQueue;
+        }
+        result = _openPseudoTerminal(pUart, uartNum) ? ESP_OK : ESP_FAIL;
+        if (result == ESP_OK) {
+            pUart->installed = true;
+            xTaskCreate(_rxTask, "Host UART", HOST_UART_TASK_STACK_SIZE, pUart, HOST_UART_TASK_PRIORITY, NULL);
+        }
+    }
+
+    return result;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uartNum)
+{
+    /* Pseudo-terminals live as long as the process */
+    return _isInstalled(uartNum) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+int uart_read_bytes(uart_port_t uartNum, uint8_t* pBuffer, uint32_t length, TickType_t ticksToWait)
+{
+    TickType_t startTicks = xTaskGetTickCount();
+    hostUart_t* pUart = NULL;
+    uint32_t readLength = 0U;
+    int result = -1;
+
+    if (_isInstalled(uartNum)) {
+        pUart = &_uarts[uartNum];
+        for (;;) {
+            vPortEnterCritical();
+            while ((readLength < length) && (pUart->rxTail != pUart->rxHead)) {
+                pBuffer[readLength++] = pUart->rxBuffer[pUart->rxTail % pUart->rxCapacity];
+                pUart->rxTail++;
+            }
+            vPortExitCritical();
+            if ((readLength >= length) || ((xTaskGetTickCount() - startTicks) >= ticksToWait)) {
+                break;
+            }
+            vTaskDelay(HOST_UART_POLL_TICKS);
+        }
+        result = (int)readLength;
+    }
+
+    return result;
+}
+
+int uart_write_bytes(uart_port_t uartNum, const char* pSource, size_t size)
+{
+    ssize_t written = 0;
+    size_t total = 0U;
+    int result = -1;
+
+    if (_isInstalled(uartNum)) {
+        /* The kernel buffers the bytes, a client reading late does not stall the firmware until it is full */
+        while (total < size) {
+            written = write(_uarts[uartNum].masterFd, &pSource[total], size - total);
+            if (written > 0) {
+                total += (size_t)written;
+            } else if ((written < 0) && (errno != EINTR) && (errno != EAGAIN)) {
+                break;
+            } else {
+                vTaskDelay(HOST_UART_POLL_TICKS);
+            }
+        }
+        result = (int)total;
+    }
+
+    return result;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uartNum, size_t* pSize)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isInstalled(uartNum)) {
+        vPortEnterCritical();
+        *pSize = _uarts[uartNum].rxHead - _uarts[uartNum].rxTail;
+        vPortExitCritical();
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t uart_flush_input(uart_port_t uartNum)
+{
+    esp_err_t result = ESP_ERR_INVALID_ARG;
+
+    if (_isInstalled(uartNum)) {
+        vPortEnterCritical();
+        _uarts[uartNum].rxTail = _uarts[uartNum].rxHead;
+        vPortExitCritical();
+        result = ESP_OK;
+    }
+
+    return result;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uartNum, TickType_t ticksToWait)
+{
+    /* Writes complete in the kernel buffer */
+    return _isInstalled(uartNum) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+/* Static functions */
+static bool _isInstalled(uart_port_t uartNum)
+{
+    return (uartNum < UART_NUM_MAX) && _uarts[uartNum].installed;
+}
+
+static bool _openPseudoTerminal(hostUart_t* pUart, uart_port_t uartNum)
+{
+    struct termios settings;
+    bool result = false;
+
+    pUart->masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((pUart->masterFd >= 0) && (grantpt(pUart->masterFd) == 0) && (unlockpt(pUart->masterFd) == 0)) {
+        pUart->slaveFd = open(ptsname(pUart->masterFd), O_RDWR | O_NOCTTY);
+        /* Raw on the client side: no echo of the firmware output back into its input, binary frames untouched */
+        if ((pUart->slaveFd >= 0) && (tcgetattr(pUart->slaveFd, &settings) == 0)) {
+            cfmakeraw(&settings);
+            result = (tcsetattr(pUart->slaveFd, TCSANOW, &settings) == 0);
+        }
+        fcntl(pUart->masterFd, F_SETFL, fcntl(pUart->masterFd, F_GETFL) | O_NONBLOCK);
+    }
+    if (result) {
+        printf("UART%d on %s\n", uartNum, ptsname(pUart->masterFd));
+    } else {
+        fprintf(stderr, "Cannot open a pseudo-terminal for UART%d: %s\n", uartNum, strerror(errno));
+    }
+
+    return result;
+}
+
+static void _rxTask(void* pvParameters)
+{
+    hostUart_t* pUart = (hostUart_t*)pvParameters;
+    uint8_t chunk[UART_FIFO_LEN];
+    uint32_t stored = 0U;
+    ssize_t received = 0;
+
+    for (;;) {
+        received = read(pUart->masterFd, chunk, sizeof(chunk));
+        if (received > 0) {
+            /* Bytes beyond the driver buffer are lost, as on the target */
+            vPortEnterCritical();
+            for (stored = 0U; (stored < (uint32_t)received) && ((pUart->rxHead - pUart->rxTail) < pUart->rxCapacity); stored++) {
+                pUart->rxBuffer[pUart->rxHead % pUart->rxCapacity] = chunk[stored];
+                pUart->rxHead++;
+            }
+            vPortExitCritical();
+            _postEvent(pUart, (stored < (uint32_t)received) ? UART_BUFFER_FULL : UART_DATA, stored);
+        } else {
+            vTaskDelay(HOST_UART_POLL_TICKS);
+        }
+    }
+}
+
+static void _postEvent(hostUart_t* pUart, uart_event_type_t type, size_t size)
+{
+    uart_event_t event = { 0 };
+
+    if (pUart->eventQueue != NULL) {
+        event.type = type;
+        event.size = size;
+        xQueueSend(pUart->eventQueue, &event, 0U);
+    }
+}
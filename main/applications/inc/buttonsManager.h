@@ -9,8 +9,11 @@
 #ifndef __BUTTONSMANAGER_H__
 #define __BUTTONSMANAGER_H__
 
+#include "reactor.h"
 #include "system_def.h"
 
 void vBUTMNGR_Process(void* pvParameters);
 
+const reactorModule_t* pBUTMNGR_GetReactorModule(void);
+
 #endif //__BUTTONSMANAGER_H__
@@ -11,10 +11,13 @@
 
 /* ____________________________________________________________________________ */
 /* Includes 																	*/
+#include "reactor.h"
 #include "system_def.h"
 
 /* ____________________________________________________________________________ */
 /* Defines 																		*/
+#define MVT_DURATION_DEFAULT (0U) /* Duration of the movement profile */
+#define MVT_DURATION_UNTIL_HALT (portMAX_DELAY) /* Runs until vMVT_Halt() or the next move */
 
 /* ____________________________________________________________________________ */
 /* Enum 																		*/
@@ -24,15 +27,27 @@ typedef enum {
     MOVEMENT_BACKWARD,
     MOVEMENT_ROTATION_LEFT,
     MOVEMENT_ROTATION_RIGHT,
+    /* Do not erase */
+    MOVEMENT_NUMBER
 } movementType_e;
 
 /* ____________________________________________________________________________ */
 /* Struct																	 	*/
+typedef void (*mvtEndCallback_t)(uint32_t endToken); /* endToken is the one given with the move */
 
 /* ____________________________________________________________________________ */
 /* Public function prototypes 													*/
 void vMVT_Process(void* pvParameters);
 
-void vMVT_Move(movementType_e movement, void (*endCallback)(void));
+const reactorModule_t* pMVT_GetReactorModule(void);
+
+void vMVT_Move(movementType_e movement, mvtEndCallback_t endCallback);
+
+/* Same as vMVT_Move() with an explicit duration, end callback is not called for a move halted or replaced.
+ * A move may end before its replacement is handled: endToken lets the caller tell which move ended */
+void vMVT_MoveFor(movementType_e movement, TickType_t durationTicks, mvtEndCallback_t endCallback, uint32_t endToken);
+
+/* Controlled stop of the running move, servos are ordered back to neutral */
+void vMVT_Halt(void);
 
 #endif //__MOVEMENTMANAGER_H__
\ No newline at end of file
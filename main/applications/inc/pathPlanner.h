@@ -0,0 +1,60 @@
+/**
+*******************************************************************************
+* @file 	pathPlanner.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __PATHPLANNER_H__
+#define __PATHPLANNER_H__
+
+/* ____________________________________________________________________________ */
+/* Includes 																	*/
+#include "movementManager.h"
+#include "system_def.h"
+
+/* ____________________________________________________________________________ */
+/* Defines 																		*/
+#define PLAN_GRID_MAX_WIDTH (12U)
+#define PLAN_GRID_MAX_HEIGHT (12U)
+#define PLAN_MAX_TARGETS (6U)
+
+/* ____________________________________________________________________________ */
+/* Enum 																		*/
+typedef enum {
+    PLAN_HEADING_NORTH = 0, /* +y */
+    PLAN_HEADING_EAST, /* +x */
+    PLAN_HEADING_SOUTH,
+    PLAN_HEADING_WEST,
+    /* Do not erase */
+    PLAN_HEADING_NUMBER
+} planHeading_e;
+
+/* ____________________________________________________________________________ */
+/* Struct																	 	*/
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+} planCell_t;
+
+typedef struct {
+    planCell_t cell;
+    planHeading_e heading;
+} planPose_t;
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    const planCell_t* pBlockedCells;
+    uint8_t blockedCount;
+} planGrid_t;
+
+/* ____________________________________________________________________________ */
+/* Public function prototypes 													*/
+/* Planner uses static work buffers, it must be called from a single task */
+bool bPLAN_ComputeRoute(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount, movementType_e* pSteps, uint8_t* pStepCount);
+
+bool bPLAN_LoadRoute(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount);
+
+#endif //__PATHPLANNER_H__
@@ -0,0 +1,41 @@
+/**
+*******************************************************************************
+* @file 	poseTracker.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __POSETRACKER_H__
+#define __POSETRACKER_H__
+
+/* ____________________________________________________________________________ */
+/* Includes 																	*/
+#include "system_def.h"
+
+/* ____________________________________________________________________________ */
+/* Defines 																		*/
+
+/* ____________________________________________________________________________ */
+/* Enum 																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																	 	*/
+typedef struct {
+    float xMm;
+    float yMm;
+    float headingRad; /* Counter-clockwise, 0 along x axis */
+    int64_t timestampUs;
+} pose_t;
+
+/* ____________________________________________________________________________ */
+/* Public function prototypes 													*/
+void vPOSE_Init(void);
+
+void vPOSE_Reset(void);
+
+void vPOSE_GetPose(pose_t* pPose);
+
+void vPOSE_GetPathToStart(float* pDistanceMm, float* pRotationRad);
+
+#endif //__POSETRACKER_H__
@@ -0,0 +1,71 @@
+/**
+*******************************************************************************
+* @file 	remoteManager.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __REMOTEMANAGER_H__
+#define __REMOTEMANAGER_H__
+
+/* ____________________________________________________________________________ */
+/* Includes 																	*/
+#include "servo.h"
+#include "system_def.h"
+
+/* ____________________________________________________________________________ */
+/* Defines 																		*/
+/* Telemetry payload, little endian:
+ *   uint32 uptime (ms) | uint8 sequence length | uint8 sequence step | int32 x (0.1 mm) | int32 y (0.1 mm)
+ *   | int16 heading (0.01 deg) | uint16 link CRC errors | uint16 link RX overflows | uint16 telemetry frames dropped
+ *   | uint8 queue count | per queue, in creation order: uint8 high water mark, uint16 lost items */
+#define RMT_TELEMETRY_HEADER_SIZE (23U)
+#define RMT_TELEMETRY_QUEUE_SIZE (3U)
+/* Calibration payload: uint8 GPIO | SERVO_CAL_POINTS x uint16 pulse (us), from full backward to full forward */
+#define RMT_CALIBRATION_SIZE (1U + (2U * SERVO_CAL_POINTS))
+/* Route payload: uint8 grid width | uint8 grid height | uint8 start x | uint8 start y | uint8 start planHeading_e
+ *   | uint8 target count | per target: uint8 x, uint8 y | per blocked cell, up to the end: uint8 x, uint8 y */
+#define RMT_ROUTE_HEADER_SIZE (6U)
+
+/* ____________________________________________________________________________ */
+/* Enum 																		*/
+/* Frame types of the UART link, see uartLink.h for the framing */
+typedef enum {
+    /* Requests, answered with the same sequence number */
+    RMT_MSG_PING = 0x01,
+    RMT_MSG_SEQUENCE_UPLOAD = 0x10, /* One movementType_e per byte, replaces the sequence */
+    RMT_MSG_SEQUENCE_DOWNLOAD = 0x11, /* Answered with RMT_MSG_SEQUENCE_CONTENT */
+    RMT_MSG_SEQUENCE_LAUNCH = 0x12,
+    RMT_MSG_SEQUENCE_ABORT = 0x13,
+    RMT_MSG_ROUTE_PLAN = 0x14, /* Route payload, compiled by the path planner, replaces the sequence */
+    RMT_MSG_MOVE = 0x20, /* movementType_e, ends by itself as a sequence step does. A stop aborts a running sequence */
+    RMT_MSG_TELEMETRY_PERIOD = 0x30, /* uint16 period in ms, 0 stops the stream */
+    RMT_MSG_SERVO_PULSE = 0x40, /* uint8 GPIO, uint16 raw pulse in us, 0 parks: calibration sweeps only */
+    RMT_MSG_CALIBRATION_UPLOAD = 0x41, /* Calibration payload, stored by the servo driver */
+    RMT_MSG_CALIBRATION_DOWNLOAD = 0x42, /* uint8 GPIO, answered with RMT_MSG_CALIBRATION_CONTENT */
+    /* Robot to host */
+    RMT_MSG_ACK = 0x80, /* uint8 request type, uint8 rmtStatus_e */
+    RMT_MSG_SEQUENCE_CONTENT = 0x91, /* One movementType_e per byte */
+    RMT_MSG_CALIBRATION_CONTENT = 0x92, /* Calibration payload */
+    RMT_MSG_TELEMETRY = 0xA0, /* Sequence number counts telemetry frames */
+} rmtMessage_e;
+
+typedef enum {
+    RMT_STATUS_OK = 0,
+    RMT_STATUS_BAD_PAYLOAD,
+    RMT_STATUS_REJECTED, /* Valid request refused in the current state */
+    RMT_STATUS_UNKNOWN_TYPE,
+    /* Do not erase */
+    RMT_STATUS_NUMBER
+} rmtStatus_e;
+
+/* ____________________________________________________________________________ */
+/* Struct																	 	*/
+
+/* ____________________________________________________________________________ */
+/* Public function prototypes 													*/
+/* Requests reach the managers through their public API, create once they are all ready */
+void vRMT_Process(void* pvParameters);
+
+#endif //__REMOTEMANAGER_H__
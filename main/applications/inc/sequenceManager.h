@@ -16,23 +16,47 @@
 
 /* ____________________________________________________________________________ */
 /* Defines 																		*/
+#define SEQUENCE_MAX_SIZE (50U)
+#define SEQUENCE_DEFAULT_DURATION (MVT_DURATION_DEFAULT) /* Step lasts the duration of its movement profile */
+#define SEQUENCE_MAX_DURATION_TICKS (UINT16_MAX)
 
 /* ____________________________________________________________________________ */
 /* Enum 																		*/
 
 /* ____________________________________________________________________________ */
 /* Struct																	 	*/
+typedef struct {
+    uint8_t length;
+    uint8_t step; /* Running step, from 1, 0 when no sequence runs */
+} seqStatus_t;
 
 /* ____________________________________________________________________________ */
 /* Public function prototypes 													*/
 void vSEQMNGR_Process(void* pvParameters);
 
+const reactorModule_t* pSEQMNGR_GetReactorModule(void);
+
 void vSEQMNGR_AddNewMovement(movementType_e movement);
 
+/* Step lasting durationTicks, SEQUENCE_DEFAULT_DURATION for the movement profile duration */
+void vSEQMNGR_AddTimedMovement(movementType_e movement, uint16_t durationTicks);
+
 void vSEQMNGR_RemoveLastMovement(void);
 
 void vSEQMNGR_LaunchSequence(void);
 
+/* Clears the sequence, the wheels are stopped only when a sequence runs */
 void vSEQMNGR_AbortSequence(void);
 
+bool bSEQMNGR_SetSequence(const movementType_e* pMovements, uint8_t length);
+
+/* pDurationTicks holds one duration per step, NULL for profile durations */
+bool bSEQMNGR_SetTimedSequence(const movementType_e* pMovements, const uint16_t* pDurationTicks, uint8_t length);
+
+/* Copies at most maxLength steps, returns the number of steps copied */
+uint8_t u8SEQMNGR_GetSequence(movementType_e* pMovements, uint8_t maxLength);
+
+/* Non blocking, safe from any task */
+void vSEQMNGR_GetStatus(seqStatus_t* pStatus);
+
 #endif //__SEQUENCEMANAGER_H__
\ No newline at end of file
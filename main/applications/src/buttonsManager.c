@@ -7,54 +7,176 @@
 */
 #include "buttonsManager.h"
 #include "buttons.h"
+#include "deadlineMonitor.h"
+#include "deferredLog.h"
 #include "mapping.h"
+#include "msgBus.h"
 #include "sequenceManager.h"
+#include "servo.h"
 
 #define BUT_MNGR_TAG ("BUT_MNGR")
+#define BUT_MNGR_TEACH_CHORD (BUTTON_CHORD(0U))
+
+static void _init(void);
+static TickType_t _handleEvent(void* pEvent);
+static bool _handleDirection(movementType_e movement, uint32_t triggerBitmap);
+static void _setTeaching(bool teaching);
+static void _endSegment(void);
+
+/* Teach mode: a held direction drives the robot, its hold time becomes the duration of a new step */
+static bool _teaching = false;
+static movementType_e _segmentMovement = MOVEMENT_STOP; /* MOVEMENT_STOP when no direction is held */
+static TickType_t _segmentStartTicks = 0U;
 
 static QueueHandle_t _buttonManagerQueue = NULL;
+static const reactorModule_t _reactorModule = {
+    .name = "Buttons manager",
+    .bootModule = BOOT_MODULE_BUTTONS_MANAGER,
+    .pQueue = &_buttonManagerQueue,
+    .queueLength = BUT_MNGR_QUEUE_LENGTH,
+    .eventSize = sizeof(buttonEvent_t*),
+    .init = _init,
+    .handleEvent = _handleEvent,
+};
 
 void vBUTMNGR_Process(void* pvParameters)
 {
-    buttonEvent_t buttonEvent = { 0 };
-
-    _buttonManagerQueue = xQueueCreate(10, sizeof(buttonEvent_t));
-    bBUT_RegisterButton(BUTTON_GO_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_RESET_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_FORWARD_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_BACKWARD_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_LEFT_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_RIGHT_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-    bBUT_RegisterButton(BUTTON_BACK_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED, _buttonManagerQueue);
-
-    for (;;) {
-        if (xQueueReceive(_buttonManagerQueue, &buttonEvent, portMAX_DELAY) == pdTRUE) {
-            ESP_LOGI(BUT_MNGR_TAG, "Button %d trigged an event %d", buttonEvent.gpio, buttonEvent.triggerBitmap);
-            switch (buttonEvent.gpio) {
-            case BUTTON_GO_GPIO_NUM:
-                vSEQMNGR_LaunchSequence();
-                break;
-            case BUTTON_BACK_GPIO_NUM:
-                vSEQMNGR_RemoveLastMovement();
-                break;
-            case BUTTON_RESET_GPIO_NUM:
-                vSEQMNGR_AbortSequence();
-                break;
-            case BUTTON_FORWARD_GPIO_NUM:
-                vSEQMNGR_AddNewMovement(MOVEMENT_FORWARD);
-                break;
-            case BUTTON_BACKWARD_GPIO_NUM:
-                vSEQMNGR_AddNewMovement(MOVEMENT_BACKWARD);
-                break;
-            case BUTTON_LEFT_GPIO_NUM:
-                vSEQMNGR_AddNewMovement(MOVEMENT_ROTATION_LEFT);
-                break;
-            case BUTTON_RIGHT_GPIO_NUM:
-                vSEQMNGR_AddNewMovement(MOVEMENT_ROTATION_RIGHT);
-                break;
-            default:
-                break;
-            }
+    vREACTOR_RunModule(&_reactorModule);
+}
+
+const reactorModule_t* pBUTMNGR_GetReactorModule(void)
+{
+    return &_reactorModule;
+}
+
+static void _init(void)
+{
+    static const uint32_t teachChordGpios[] = { BUTTON_LEFT_GPIO_NUM, BUTTON_RIGHT_GPIO_NUM };
+
+    _buttonManagerQueue = OS_QUEUE_CREATE("Queue buttons manager", BUT_MNGR_QUEUE_LENGTH, sizeof(buttonEvent_t*));
+    bBUS_Subscribe(BUS_TOPIC_BUTTON, _buttonManagerQueue);
+    /* GO launches on press, the edge to servo benchmark holds it until the servo write */
+    bBUT_RegisterButton(BUTTON_GO_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED);
+    bBUT_RegisterButton(BUTTON_RESET_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED);
+    /* Held directions repeat their step, or drive the robot in teach mode */
+    bBUT_RegisterButton(BUTTON_FORWARD_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_EDGE_RELEASED | BUTTON_TRIGGER_HOLD_REPEAT);
+    bBUT_RegisterButton(BUTTON_BACKWARD_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_EDGE_RELEASED | BUTTON_TRIGGER_HOLD_REPEAT);
+    bBUT_RegisterButton(BUTTON_LEFT_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_EDGE_RELEASED | BUTTON_TRIGGER_HOLD_REPEAT);
+    bBUT_RegisterButton(BUTTON_RIGHT_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_EDGE_RELEASED | BUTTON_TRIGGER_HOLD_REPEAT);
+    /* BACK removes the last step, a double click clears the sequence */
+    bBUT_RegisterButton(BUTTON_BACK_GPIO_NUM, BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_DOUBLE_CLICK);
+    /* LEFT + RIGHT toggles teach mode. Chord keys hold their press back for the chord window: directions can afford
+     * it, a live move and its recorded duration are both shortened by the same delay */
+    bBUT_RegisterChord(BUT_MNGR_TEACH_CHORD, teachChordGpios, sizeof(teachChordGpios) / sizeof(teachChordGpios[0]));
+    /* RESET stops the wheels straight from the ISR, sequence abort follows through the event */
+    vBUT_SetPressIsrCallback(BUTTON_RESET_GPIO_NUM, vSERVO_EmergencyStopFromISR);
+}
+
+static TickType_t _handleEvent(void* pEvent)
+{
+    buttonEvent_t* pButtonEvent = *(buttonEvent_t**)pEvent;
+    /* Only sequence edition and launch continue the deadline chain, live moves skip the sequence stage */
+    bool chained = false;
+
+    DLN_STAMP(DLN_STAGE_BUTTON_MANAGER);
+    DLOGI(BUT_MNGR_TAG, "Button %u trigged an event %u", pButtonEvent->gpio, pButtonEvent->triggerBitmap);
+    switch (pButtonEvent->gpio) {
+    case BUTTON_GO_GPIO_NUM:
+        chained = true;
+        /* Launching ends teach mode, the taught path is played back */
+        _setTeaching(false);
+        vSEQMNGR_LaunchSequence();
+        break;
+    case BUTTON_BACK_GPIO_NUM:
+        chained = true;
+        if (pButtonEvent->triggerBitmap & BUTTON_TRIGGER_DOUBLE_CLICK) {
+            vSEQMNGR_AbortSequence();
+        } else {
+            vSEQMNGR_RemoveLastMovement();
+        }
+        break;
+    case BUTTON_RESET_GPIO_NUM:
+        chained = true;
+        /* Segment held is dropped, the wheels are already stopped from the ISR */
+        _segmentMovement = MOVEMENT_STOP;
+        _setTeaching(false);
+        vSEQMNGR_AbortSequence();
+        break;
+    case BUT_MNGR_TEACH_CHORD:
+        _setTeaching(!_teaching);
+        break;
+    case BUTTON_FORWARD_GPIO_NUM:
+        chained = _handleDirection(MOVEMENT_FORWARD, pButtonEvent->triggerBitmap);
+        break;
+    case BUTTON_BACKWARD_GPIO_NUM:
+        chained = _handleDirection(MOVEMENT_BACKWARD, pButtonEvent->triggerBitmap);
+        break;
+    case BUTTON_LEFT_GPIO_NUM:
+        chained = _handleDirection(MOVEMENT_ROTATION_LEFT, pButtonEvent->triggerBitmap);
+        break;
+    case BUTTON_RIGHT_GPIO_NUM:
+        chained = _handleDirection(MOVEMENT_ROTATION_RIGHT, pButtonEvent->triggerBitmap);
+        break;
+    default:
+        break;
+    }
+    if (!chained) {
+        DLN_ABANDON();
+    }
+    vBUS_Release(pButtonEvent);
+
+    return portMAX_DELAY;
+}
+
+static bool _handleDirection(movementType_e movement, uint32_t triggerBitmap)
+{
+    bool result = false;
+
+    if (!_teaching) {
+        /* One step per press and per repeat while held */
+        result = (triggerBitmap & (BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_HOLD_REPEAT));
+        if (result) {
+            vSEQMNGR_AddNewMovement(movement);
+        }
+    } else if ((triggerBitmap & BUTTON_TRIGGER_EDGE_PRESSED) && (triggerBitmap & BUTTON_TRIGGER_EDGE_RELEASED)) {
+        /* Chord key tapped within the chord window: it never drove the wheels, nothing to record */
+    } else if ((triggerBitmap & BUTTON_TRIGGER_EDGE_PRESSED) && (_segmentMovement == MOVEMENT_STOP)) {
+        /* One segment at a time, other directions pressed meanwhile are ignored */
+        _segmentMovement = movement;
+        _segmentStartTicks = xTaskGetTickCount();
+        vMVT_MoveFor(movement, MVT_DURATION_UNTIL_HALT, NULL, 0U);
+    } else if ((triggerBitmap & BUTTON_TRIGGER_EDGE_RELEASED) && (_segmentMovement == movement)) {
+        _endSegment();
+    }
+
+    return result;
+}
+
+static void _setTeaching(bool teaching)
+{
+    if (teaching != _teaching) {
+        if (teaching) {
+            /* Taught path replaces the sequence */
+            vSEQMNGR_AbortSequence();
+        } else if (_segmentMovement != MOVEMENT_STOP) {
+            _endSegment();
         }
+        _teaching = teaching;
+        DLOGI(BUT_MNGR_TAG, "Teach mode %s", teaching ? "on" : "off");
+    }
+}
+
+static void _endSegment(void)
+{
+    /* Press and release go through the same path, their latencies cancel out in the hold time */
+    TickType_t durationTicks = xTaskGetTickCount() - _segmentStartTicks;
+
+    vMVT_Halt();
+    if (durationTicks == 0U) {
+        durationTicks = 1U;
+    } else if (durationTicks > SEQUENCE_MAX_DURATION_TICKS) {
+        durationTicks = SEQUENCE_MAX_DURATION_TICKS;
     }
+    vSEQMNGR_AddTimedMovement(_segmentMovement, (uint16_t)durationTicks);
+    _segmentMovement = MOVEMENT_STOP;
 }
@@ -9,8 +9,13 @@
 /* ____________________________________________________________________________ */
 /* Includes  																	*/
 #include "movementManager.h"
+#include "deadlineMonitor.h"
 #include "mapping.h"
+#include "power.h"
+#include "reactor.h"
 #include "servo.h"
+#include "stateMachine.h"
+#include "trace.h"
 
 /* ____________________________________________________________________________ */
 /* Defines  																	*/
@@ -29,22 +34,107 @@
 
 /* ____________________________________________________________________________ */
 /* Enum  																		*/
+typedef enum {
+    MOVEMENT_EVENT_MOVE,
+    MOVEMENT_EVENT_HALT,
+    MOVEMENT_EVENT_EMERGENCY_STOPPED,
+    MOVEMENT_EVENT_END_OF_STEP, /* Timeout of the moving state, never queued */
+    /* Do not erase */
+    MOVEMENT_EVENT_NUMBER
+} movementEvent_e;
+
+typedef enum {
+    MOVEMENT_STATE_IDLE = 0, /* Servos at neutral, motion lock released */
+    MOVEMENT_STATE_MOVING, /* Orders applied, the step duration runs */
+    /* Do not erase */
+    MOVEMENT_STATE_NUMBER
+} movementState_e;
 
 /* ____________________________________________________________________________ */
 /* Struct																		*/
 typedef struct {
+    movementEvent_e type;
     movementType_e movement;
-    void (*endCallback)(void);
+    TickType_t durationTicks;
+    mvtEndCallback_t endCallback;
+    uint32_t endToken;
+    uint32_t stopGeneration; /* Emergency stops seen by the sender, older moves are dropped */
 } movementEvent_t;
 
+typedef struct {
+    float leftSpeed;
+    bool leftForward;
+    float rightSpeed;
+    bool rightForward;
+    TickType_t durationTicks;
+} movementProfile_t;
+
 /* ____________________________________________________________________________ */
 /* Static prototypes 															*/
-static void _endMovementTimerCallback(void* timer);
+static void _emergencyStopCallback(BaseType_t* pHigherTaskWoken);
+static void _init(void);
+static TickType_t _handleEvent(void* pEvent);
+static void _enterIdle(void);
+static void _enterMoving(void);
+static bool _acceptMove(void* pEvent);
+static bool _endOfStep(void* pEvent);
+static bool _halt(void* pEvent);
+static bool _emergencyStopped(void* pEvent);
 
 /* ____________________________________________________________________________ */
 /* Static variables 															*/
 static QueueHandle_t _queueForMovement = NULL;
-static TimerHandle_t _timerForMovement = NULL;
+static movementType_e _currentMovement = MOVEMENT_STOP;
+static TickType_t _currentDurationTicks = 0U;
+static mvtEndCallback_t _endCallbackToCall = NULL;
+static uint32_t _endToken = 0U;
+static volatile uint32_t _stopGeneration = 0U;
+static pwrLock_t _motionLock = { 0 };
+static const movementProfile_t _profiles[MOVEMENT_NUMBER] = {
+    [MOVEMENT_STOP] = { SPEED_STOP, true, SPEED_STOP, true, 0U },
+    [MOVEMENT_FORWARD] = { SPEED_FORWARD, true, SPEED_FORWARD, true, FORWARD_DELAY_TICKS },
+    [MOVEMENT_BACKWARD] = { SPEED_BACKWARD, false, SPEED_BACKWARD, false, BACKWARD_DELAY_TICKS },
+    [MOVEMENT_ROTATION_LEFT] = { SPEED_ROTATION, false, SPEED_ROTATION, true, ROTATION_DELAY_TICKS },
+    [MOVEMENT_ROTATION_RIGHT] = { SPEED_ROTATION, true, SPEED_ROTATION, false, ROTATION_DELAY_TICKS },
+};
+static stateMachine_t _machine = { 0 };
+static const smState_t _states[MOVEMENT_STATE_NUMBER] = {
+    [MOVEMENT_STATE_IDLE] = { .name = "Idle", .entry = _enterIdle, .timeoutTicks = portMAX_DELAY, .timeoutEvent = SM_NO_EVENT },
+    /* Timeout armed by the entry, from the movement duration */
+    [MOVEMENT_STATE_MOVING] = { .name = "Moving", .entry = _enterMoving, .timeoutTicks = portMAX_DELAY, .timeoutEvent = MOVEMENT_EVENT_END_OF_STEP },
+};
+/* A move while moving replaces the running one: its end callback is dropped, the new duration starts.
+   A halt ends the running move at once, without calling its end callback, and is ignored when idle */
+static const smTransition_t _transitions[MOVEMENT_STATE_NUMBER][MOVEMENT_EVENT_NUMBER] = {
+    [MOVEMENT_STATE_IDLE] = {
+        [MOVEMENT_EVENT_MOVE] = SM_TO(MOVEMENT_STATE_MOVING, _acceptMove),
+        [MOVEMENT_EVENT_EMERGENCY_STOPPED] = SM_INTERNAL(_emergencyStopped),
+    },
+    [MOVEMENT_STATE_MOVING] = {
+        [MOVEMENT_EVENT_MOVE] = SM_TO(MOVEMENT_STATE_MOVING, _acceptMove),
+        [MOVEMENT_EVENT_HALT] = SM_TO(MOVEMENT_STATE_IDLE, _halt),
+        [MOVEMENT_EVENT_EMERGENCY_STOPPED] = SM_TO(MOVEMENT_STATE_IDLE, _emergencyStopped),
+        [MOVEMENT_EVENT_END_OF_STEP] = SM_TO(MOVEMENT_STATE_IDLE, _endOfStep),
+    },
+};
+static const smDefinition_t _machineDefinition = {
+    .name = "Movement",
+    .traceId = BOOT_MODULE_MOVEMENT_MANAGER,
+    .pStates = _states,
+    .stateNumber = MOVEMENT_STATE_NUMBER,
+    .pTransitions = &_transitions[0][0],
+    .eventNumber = MOVEMENT_EVENT_NUMBER,
+    .initialState = MOVEMENT_STATE_IDLE,
+};
+static const reactorModule_t _reactorModule = {
+    .name = "Movement manager",
+    .bootModule = BOOT_MODULE_MOVEMENT_MANAGER,
+    .pQueue = &_queueForMovement,
+    .queueLength = MOVEMENT_QUEUE_LENGTH,
+    .eventSize = sizeof(movementEvent_t),
+    .init = _init,
+    .handleEvent = _handleEvent,
+};
 
 /* ____________________________________________________________________________ */
 /* ISR handlers 																*/
@@ -53,84 +143,169 @@ static TimerHandle_t _timerForMovement = NULL;
 /* Public functions 															*/
 void vMVT_Process(void* pvParameters)
 {
-    static void (*_endCallbackToCall)(void) = NULL;
-    movementEvent_t movementEvent = { 0 };
-
-    _queueForMovement = xQueueCreate(5U, sizeof(movementEvent));
-    _timerForMovement = xTimerCreate("Timer to end movement", FORWARD_DELAY_TICKS, pdFALSE, NULL, _endMovementTimerCallback);
-
-    bSERVO_RegisterServo(SERVO_LEFT_GPIO_NUM, PULSE_WIDTH_MIN_MS, PULSE_WIDTH_MAX_MS);
-    bSERVO_RegisterServo(SERVO_RIGHT_GPIO_NUM, PULSE_WIDTH_MIN_MS, PULSE_WIDTH_MAX_MS);
+    vREACTOR_RunModule(&_reactorModule);
+}
 
-    for (;;) {
-        xQueueReceive(_queueForMovement, &movementEvent, portMAX_DELAY);
-
-        switch (movementEvent.movement) {
-        case MOVEMENT_STOP:
-            xTimerStop(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-            bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_STOP, true);
-            bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_STOP, true);
-            if (_endCallbackToCall != NULL) {
-                _endCallbackToCall();
-            }
-            break;
-        case MOVEMENT_FORWARD:
-            xTimerChangePeriod(_timerForMovement, FORWARD_DELAY_TICKS, TIMER_API_DEFAULT_TIMEOUT);
-            xTimerReset(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-            bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_FORWARD, true);
-            bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_FORWARD, true);
-            break;
-        case MOVEMENT_BACKWARD:
-            xTimerChangePeriod(_timerForMovement, BACKWARD_DELAY_TICKS, TIMER_API_DEFAULT_TIMEOUT);
-            xTimerReset(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-            bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_BACKWARD, false);
-            bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_BACKWARD, false);
-            break;
-        case MOVEMENT_ROTATION_LEFT:
-            xTimerChangePeriod(_timerForMovement, ROTATION_DELAY_TICKS, TIMER_API_DEFAULT_TIMEOUT);
-            xTimerReset(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-            bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_ROTATION, false);
-            bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_ROTATION, true);
-            break;
-        case MOVEMENT_ROTATION_RIGHT:
-            xTimerChangePeriod(_timerForMovement, ROTATION_DELAY_TICKS, TIMER_API_DEFAULT_TIMEOUT);
-            xTimerReset(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-            bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_ROTATION, true);
-            bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_ROTATION, false);
-            break;
-        default:
-            break;
-        }
+const reactorModule_t* pMVT_GetReactorModule(void)
+{
+    return &_reactorModule;
+}
 
-        _endCallbackToCall = movementEvent.endCallback;
-    }
+void vMVT_Move(movementType_e movement, mvtEndCallback_t endCallback)
+{
+    vMVT_MoveFor(movement, MVT_DURATION_DEFAULT, endCallback, 0U);
 }
 
-void vMVT_Move(movementType_e movement, void (*endCallback)(void))
+void vMVT_MoveFor(movementType_e movement, TickType_t durationTicks, mvtEndCallback_t endCallback, uint32_t endToken)
 {
     movementEvent_t event;
 
+    event.type = MOVEMENT_EVENT_MOVE;
     event.movement = movement;
+    event.durationTicks = durationTicks;
     event.endCallback = endCallback;
+    event.endToken = endToken;
+    event.stopGeneration = _stopGeneration;
 
     if (movement == MOVEMENT_STOP) {
-        xTimerStop(_timerForMovement, TIMER_API_DEFAULT_TIMEOUT);
-        xQueueReset(_queueForMovement);
-        xQueueSendToFront(_queueForMovement, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+        /* Servos are forced to neutral right away, the movement task is notified through the stop callback */
+        vSERVO_EmergencyStop();
     } else {
-        xQueueSend(_queueForMovement, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+        TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_MOVEMENT_MANAGER, event.type);
+        bOS_QueueSend(_queueForMovement, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
     }
 }
 
+void vMVT_Halt(void)
+{
+    movementEvent_t event;
+
+    event.type = MOVEMENT_EVENT_HALT;
+    event.movement = MOVEMENT_STOP;
+    event.durationTicks = 0U;
+    event.endCallback = NULL;
+    event.endToken = 0U;
+    event.stopGeneration = _stopGeneration;
+
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_MOVEMENT_MANAGER, event.type);
+    bOS_QueueSend(_queueForMovement, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+}
+
 /* ____________________________________________________________________________ */
 /* Static functions 															*/
 
-static void _endMovementTimerCallback(void* timer)
+static void _emergencyStopCallback(BaseType_t* pHigherTaskWoken)
 {
     movementEvent_t event;
 
+    event.type = MOVEMENT_EVENT_EMERGENCY_STOPPED;
     event.movement = MOVEMENT_STOP;
+    event.durationTicks = 0U;
     event.endCallback = NULL;
+    event.endToken = 0U;
+    /* Queued moves are flushed by generation: resetting the queue would break the reactor queue set */
+    event.stopGeneration = ++_stopGeneration;
+
+    if (_queueForMovement != NULL) {
+        if (pHigherTaskWoken != NULL) {
+            bOS_QueueSendToFrontFromISR(_queueForMovement, &event, pHigherTaskWoken);
+        } else {
+            bOS_QueueSendToFront(_queueForMovement, &event, 0U);
+        }
+    }
+}
+
+static void _init(void)
+{
+    _queueForMovement = OS_QUEUE_CREATE("Queue movement manager", MOVEMENT_QUEUE_LENGTH, sizeof(movementEvent_t));
+    vPWR_CreateLock(&_motionLock, "movement");
+
+    bSERVO_RegisterServo(SERVO_LEFT_GPIO_NUM, PULSE_WIDTH_MIN_MS, PULSE_WIDTH_MAX_MS);
+    bSERVO_RegisterServo(SERVO_RIGHT_GPIO_NUM, PULSE_WIDTH_MIN_MS, PULSE_WIDTH_MAX_MS);
+    vSERVO_RegisterEmergencyStopCallback(_emergencyStopCallback);
+    vSM_Start(&_machine, &_machineDefinition);
+}
+
+static TickType_t _handleEvent(void* pEvent)
+{
+    movementEvent_t* pMovementEvent = (movementEvent_t*)pEvent;
+    TickType_t result = portMAX_DELAY;
+
+    /* Step durations are module timeouts: the end of a step costs no software timer round trip */
+    if (pMovementEvent == NULL) {
+        result = xSM_HandleTimeout(&_machine);
+    } else if ((pMovementEvent->type != MOVEMENT_EVENT_EMERGENCY_STOPPED) && (pMovementEvent->stopGeneration != _stopGeneration)) {
+        /* Posted before an emergency stop: dropped, the state timeout keeps running */
+        result = xSM_HandleTimeout(&_machine);
+    } else {
+        result = xSM_Dispatch(&_machine, pMovementEvent->type, pMovementEvent);
+    }
+
+    return result;
+}
+
+static void _enterIdle(void)
+{
+    bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, SPEED_STOP, true);
+    bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, SPEED_STOP, true);
+    vPWR_ReleaseLock(&_motionLock);
+}
+
+static void _enterMoving(void)
+{
+    const movementProfile_t* pProfile = &_profiles[_currentMovement];
+
+    /* Step durations are timed at full clock, without light sleep */
+    vPWR_AcquireLock(&_motionLock);
+    vSM_SetTimeout(&_machine, _currentDurationTicks);
+    bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, pProfile->leftSpeed, pProfile->leftForward);
+    bSERVO_SetOrder(SERVO_RIGHT_GPIO_NUM, pProfile->rightSpeed, pProfile->rightForward);
+}
+
+static bool _acceptMove(void* pEvent)
+{
+    movementEvent_t* pMovementEvent = (movementEvent_t*)pEvent;
+    bool result = (pMovementEvent->movement > MOVEMENT_STOP) && (pMovementEvent->movement < MOVEMENT_NUMBER);
+
+    /* Stop orders go through the emergency stop, they are not part of a deadline chain */
+    if (result) {
+        DLN_STAMP(DLN_STAGE_MOVEMENT_MANAGER);
+        _currentMovement = pMovementEvent->movement;
+        _currentDurationTicks = (pMovementEvent->durationTicks == MVT_DURATION_DEFAULT) ? _profiles[_currentMovement].durationTicks : pMovementEvent->durationTicks;
+        _endCallbackToCall = pMovementEvent->endCallback;
+        _endToken = pMovementEvent->endToken;
+    }
+
+    return result;
+}
+
+static bool _endOfStep(void* pEvent)
+{
+    mvtEndCallback_t endCallback = _endCallbackToCall;
+
+    DLN_STAMP(DLN_STAGE_MOVEMENT_END);
+    _endCallbackToCall = NULL;
+    /* Next step is queued by the callback, it is handled after the idle entry has stopped the servos */
+    if (endCallback != NULL) {
+        endCallback(_endToken);
+    }
+
+    return true;
+}
+
+static bool _halt(void* pEvent)
+{
+    /* Idle entry brings the servos back to neutral through the usual orders, no emergency stop */
+    _endCallbackToCall = NULL;
+
+    return true;
+}
+
+static bool _emergencyStopped(void* pEvent)
+{
+    /* Servos are already neutral: pending movements are dropped by generation, the sequence is not chained */
+    _endCallbackToCall = NULL;
+    vSERVO_ReleaseEmergencyStop();
 
-    xQueueSend(_queueForMovement, &event, 0U);
+    return true;
 }
@@ -0,0 +1,366 @@
+/**
+*******************************************************************************
+* @file 	pathPlanner.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+/* ____________________________________________________________________________ */
+/* Includes  																	*/
+#include "pathPlanner.h"
+#include "sequenceManager.h"
+
+/* ____________________________________________________________________________ */
+/* Defines  																	*/
+#define PLAN_TAG ("PLAN")
+
+/* Costs are proportional to movement durations (1 s for each movement today) */
+#define PLAN_COST_TRANSLATION (1U)
+#define PLAN_COST_ROTATION (1U)
+
+#define PLAN_STATE_MAX (PLAN_GRID_MAX_WIDTH * PLAN_GRID_MAX_HEIGHT * PLAN_HEADING_NUMBER)
+#define PLAN_NODE_MAX (PLAN_MAX_TARGETS * PLAN_HEADING_NUMBER)
+#define PLAN_SOURCE_MAX (1U + PLAN_NODE_MAX) /* Start pose then every (target, heading) */
+#define PLAN_COST_INFINITE (0xFFFFU)
+#define PLAN_NO_STATE (0xFFFFU)
+#define PLAN_NO_NODE (0xFFU)
+#define PLAN_ACTION_NUMBER (4U)
+
+#define STATE_INDEX(pGrid, x, y, heading) ((((y) * (pGrid)->width) + (x)) * PLAN_HEADING_NUMBER + (heading))
+#define NODE_INDEX(target, heading) ((target)*PLAN_HEADING_NUMBER + (heading))
+
+/* ____________________________________________________________________________ */
+/* Enum  																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																		*/
+
+/* ____________________________________________________________________________ */
+/* Static prototypes 															*/
+static bool _prepareGrid(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount);
+static bool _isFree(const planGrid_t* pGrid, int16_t x, int16_t y);
+static void _search(const planGrid_t* pGrid, uint16_t sourceState);
+static bool _appendPath(uint16_t sourceState, uint16_t targetState, movementType_e* pSteps, uint8_t capacity, uint8_t* pStepCount);
+static void _heapPush(uint16_t state);
+static uint16_t _heapPop(void);
+static void _heapSiftUp(uint16_t position);
+static void _heapSiftDown(uint16_t position);
+static void _heapSwap(uint16_t positionA, uint16_t positionB);
+
+/* ____________________________________________________________________________ */
+/* Static variables 															*/
+static const int8_t _headingDx[PLAN_HEADING_NUMBER] = { 0, 1, 0, -1 };
+static const int8_t _headingDy[PLAN_HEADING_NUMBER] = { 1, 0, -1, 0 };
+static const movementType_e _actions[PLAN_ACTION_NUMBER] = { MOVEMENT_FORWARD, MOVEMENT_BACKWARD, MOVEMENT_ROTATION_LEFT, MOVEMENT_ROTATION_RIGHT };
+static const uint16_t _actionCosts[PLAN_ACTION_NUMBER] = { PLAN_COST_TRANSLATION, PLAN_COST_TRANSLATION, PLAN_COST_ROTATION, PLAN_COST_ROTATION };
+
+static bool _blocked[PLAN_GRID_MAX_WIDTH * PLAN_GRID_MAX_HEIGHT] = { false };
+static uint16_t _cost[PLAN_STATE_MAX] = { 0 };
+static uint16_t _parent[PLAN_STATE_MAX] = { 0 };
+static movementType_e _parentAction[PLAN_STATE_MAX] = { MOVEMENT_STOP };
+static uint16_t _heap[PLAN_STATE_MAX] = { 0 };
+static uint16_t _heapPosition[PLAN_STATE_MAX] = { 0 };
+static uint16_t _heapSize = 0U;
+static uint16_t _legCost[PLAN_SOURCE_MAX][PLAN_NODE_MAX] = { { 0 } };
+static uint16_t _tourCost[1U << PLAN_MAX_TARGETS][PLAN_NODE_MAX] = { { 0 } };
+static uint8_t _tourParent[1U << PLAN_MAX_TARGETS][PLAN_NODE_MAX] = { { 0 } };
+static movementType_e _route[SEQUENCE_MAX_SIZE] = { MOVEMENT_STOP };
+
+/* ____________________________________________________________________________ */
+/* ISR handlers 																*/
+
+/* ____________________________________________________________________________ */
+/* Public functions 															*/
+bool bPLAN_ComputeRoute(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount, movementType_e* pSteps, uint8_t* pStepCount)
+{
+    uint16_t startState = 0U;
+    uint16_t nodeStates[PLAN_NODE_MAX];
+    uint8_t order[PLAN_MAX_TARGETS];
+    uint8_t nodeCount = targetCount * PLAN_HEADING_NUMBER;
+    uint32_t fullMask = (1U << targetCount) - 1U;
+    uint32_t mask = 0U;
+    uint32_t cost = 0U;
+    uint16_t bestCost = PLAN_COST_INFINITE;
+    uint8_t bestNode = PLAN_NO_NODE;
+    uint8_t node = 0U;
+    uint8_t nextNode = 0U;
+    uint8_t target = 0U;
+    uint8_t orderLength = 0U;
+    uint8_t capacity = *pStepCount;
+    bool result = true;
+
+    *pStepCount = 0U;
+    if (!_prepareGrid(pGrid, pStart, pTargets, targetCount)) {
+        return false;
+    }
+
+    startState = STATE_INDEX(pGrid, pStart->cell.x, pStart->cell.y, pStart->heading);
+    for (node = 0U; node < nodeCount; node++) {
+        target = node / PLAN_HEADING_NUMBER;
+        nodeStates[node] = STATE_INDEX(pGrid, pTargets[target].x, pTargets[target].y, node % PLAN_HEADING_NUMBER);
+    }
+
+    /* Shortest leg costs over (cell, heading) from start and from every node */
+    for (uint8_t source = 0U; source <= nodeCount; source++) {
+        _search(pGrid, (source == 0U) ? startState : nodeStates[source - 1U]);
+        for (node = 0U; node < nodeCount; node++) {
+            _legCost[source][node] = _cost[nodeStates[node]];
+        }
+    }
+
+    /* Visiting order: Held-Karp over (visited targets, current target, heading) */
+    for (mask = 0U; mask <= fullMask; mask++) {
+        for (node = 0U; node < nodeCount; node++) {
+            _tourCost[mask][node] = PLAN_COST_INFINITE;
+            _tourParent[mask][node] = PLAN_NO_NODE;
+        }
+    }
+    for (node = 0U; node < nodeCount; node++) {
+        _tourCost[1U << (node / PLAN_HEADING_NUMBER)][node] = _legCost[0][node];
+    }
+    for (mask = 1U; mask <= fullMask; mask++) {
+        for (node = 0U; node < nodeCount; node++) {
+            if (((mask & (1U << (node / PLAN_HEADING_NUMBER))) == 0U) || (_tourCost[mask][node] == PLAN_COST_INFINITE)) {
+                continue;
+            }
+            for (nextNode = 0U; nextNode < nodeCount; nextNode++) {
+                if (((mask & (1U << (nextNode / PLAN_HEADING_NUMBER))) != 0U) || (_legCost[1U + node][nextNode] == PLAN_COST_INFINITE)) {
+                    continue;
+                }
+                cost = (uint32_t)_tourCost[mask][node] + _legCost[1U + node][nextNode];
+                if (cost < _tourCost[mask | (1U << (nextNode / PLAN_HEADING_NUMBER))][nextNode]) {
+                    _tourCost[mask | (1U << (nextNode / PLAN_HEADING_NUMBER))][nextNode] = cost;
+                    _tourParent[mask | (1U << (nextNode / PLAN_HEADING_NUMBER))][nextNode] = node;
+                }
+            }
+        }
+    }
+    for (node = 0U; node < nodeCount; node++) {
+        if (_tourCost[fullMask][node] < bestCost) {
+            bestCost = _tourCost[fullMask][node];
+            bestNode = node;
+        }
+    }
+    if (bestNode == PLAN_NO_NODE) {
+        ESP_LOGE(PLAN_TAG, "No route reaches every target");
+        return false;
+    }
+
+    /* Walk back the tour to get the order, then expand each leg into movements */
+    mask = fullMask;
+    node = bestNode;
+    orderLength = targetCount;
+    while (node != PLAN_NO_NODE) {
+        order[--orderLength] = node;
+        nextNode = _tourParent[mask][node];
+        mask &= ~(1U << (node / PLAN_HEADING_NUMBER));
+        node = nextNode;
+    }
+    for (uint8_t leg = 0U; (leg < targetCount) && result; leg++) {
+        uint16_t sourceState = (leg == 0U) ? startState : nodeStates[order[leg - 1U]];
+
+        _search(pGrid, sourceState);
+        result = _appendPath(sourceState, nodeStates[order[leg]], pSteps, capacity, pStepCount);
+    }
+    if (result) {
+        ESP_LOGI(PLAN_TAG, "Route computed: %d targets, %d steps (cost %d)", targetCount, *pStepCount, bestCost);
+    } else {
+        ESP_LOGE(PLAN_TAG, "Route does not fit in %d steps", capacity);
+    }
+
+    return result;
+}
+
+bool bPLAN_LoadRoute(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount)
+{
+    uint8_t stepCount = SEQUENCE_MAX_SIZE;
+    bool result = false;
+
+    if (bPLAN_ComputeRoute(pGrid, pStart, pTargets, targetCount, _route, &stepCount)) {
+        result = bSEQMNGR_SetSequence(_route, stepCount);
+    }
+
+    return result;
+}
+
+/* ____________________________________________________________________________ */
+/* Static functions 															*/
+
+static bool _prepareGrid(const planGrid_t* pGrid, const planPose_t* pStart, const planCell_t* pTargets, uint8_t targetCount)
+{
+    bool result = true;
+
+    if ((pGrid->width == 0U) || (pGrid->width > PLAN_GRID_MAX_WIDTH) || (pGrid->height == 0U) || (pGrid->height > PLAN_GRID_MAX_HEIGHT)) {
+        ESP_LOGE(PLAN_TAG, "Invalid grid size %dx%d", pGrid->width, pGrid->height);
+        return false;
+    }
+    if ((targetCount == 0U) || (targetCount > PLAN_MAX_TARGETS)) {
+        ESP_LOGE(PLAN_TAG, "Invalid target number %d", targetCount);
+        return false;
+    }
+
+    memset(_blocked, 0, sizeof(_blocked));
+    for (uint8_t index = 0U; index < pGrid->blockedCount; index++) {
+        if ((pGrid->pBlockedCells[index].x < pGrid->width) && (pGrid->pBlockedCells[index].y < pGrid->height)) {
+            _blocked[pGrid->pBlockedCells[index].y * pGrid->width + pGrid->pBlockedCells[index].x] = true;
+        }
+    }
+
+    result = _isFree(pGrid, pStart->cell.x, pStart->cell.y) && (pStart->heading < PLAN_HEADING_NUMBER);
+    for (uint8_t index = 0U; index < targetCount; index++) {
+        result = result && _isFree(pGrid, pTargets[index].x, pTargets[index].y);
+    }
+    if (!result) {
+        ESP_LOGE(PLAN_TAG, "Start or target outside of grid or blocked");
+    }
+
+    return result;
+}
+
+static bool _isFree(const planGrid_t* pGrid, int16_t x, int16_t y)
+{
+    return (x >= 0) && (x < pGrid->width) && (y >= 0) && (y < pGrid->height) && !_blocked[y * pGrid->width + x];
+}
+
+static void _search(const planGrid_t* pGrid, uint16_t sourceState)
+{
+    uint16_t stateNumber = pGrid->width * pGrid->height * PLAN_HEADING_NUMBER;
+    uint16_t state = 0U;
+    uint16_t nextState = 0U;
+    uint16_t cost = 0U;
+    int16_t x = 0;
+    int16_t y = 0;
+    uint8_t heading = 0U;
+    int8_t direction = 0;
+
+    for (state = 0U; state < stateNumber; state++) {
+        _cost[state] = PLAN_COST_INFINITE;
+        _parent[state] = PLAN_NO_STATE;
+        _heapPosition[state] = PLAN_NO_STATE;
+    }
+    _heapSize = 0U;
+    _cost[sourceState] = 0U;
+    _heapPush(sourceState);
+
+    /* Dijkstra over (cell, heading): rotations are part of the cost */
+    while (_heapSize > 0U) {
+        state = _heapPop();
+        heading = state % PLAN_HEADING_NUMBER;
+        x = (state / PLAN_HEADING_NUMBER) % pGrid->width;
+        y = (state / PLAN_HEADING_NUMBER) / pGrid->width;
+        for (uint8_t action = 0U; action < PLAN_ACTION_NUMBER; action++) {
+            switch (_actions[action]) {
+            case MOVEMENT_FORWARD:
+            case MOVEMENT_BACKWARD:
+                direction = (_actions[action] == MOVEMENT_FORWARD) ? 1 : -1;
+                if (!_isFree(pGrid, x + direction * _headingDx[heading], y + direction * _headingDy[heading])) {
+                    continue;
+                }
+                nextState = STATE_INDEX(pGrid, x + direction * _headingDx[heading], y + direction * _headingDy[heading], heading);
+                break;
+            case MOVEMENT_ROTATION_LEFT:
+                nextState = STATE_INDEX(pGrid, x, y, (heading + PLAN_HEADING_NUMBER - 1U) % PLAN_HEADING_NUMBER);
+                break;
+            case MOVEMENT_ROTATION_RIGHT:
+                nextState = STATE_INDEX(pGrid, x, y, (heading + 1U) % PLAN_HEADING_NUMBER);
+                break;
+            default:
+                continue;
+            }
+            cost = _cost[state] + _actionCosts[action];
+            if (cost < _cost[nextState]) {
+                _cost[nextState] = cost;
+                _parent[nextState] = state;
+                _parentAction[nextState] = _actions[action];
+                if (_heapPosition[nextState] == PLAN_NO_STATE) {
+                    _heapPush(nextState);
+                } else {
+                    _heapSiftUp(_heapPosition[nextState]);
+                }
+            }
+        }
+    }
+}
+
+static bool _appendPath(uint16_t sourceState, uint16_t targetState, movementType_e* pSteps, uint8_t capacity, uint8_t* pStepCount)
+{
+    uint16_t pathLength = 0U;
+    uint16_t state = targetState;
+    uint16_t index = 0U;
+
+    while (state != sourceState) {
+        pathLength++;
+        state = _parent[state];
+    }
+    if ((*pStepCount + pathLength) > capacity) {
+        return false;
+    }
+
+    state = targetState;
+    index = *pStepCount + pathLength;
+    while (state != sourceState) {
+        pSteps[--index] = _parentAction[state];
+        state = _parent[state];
+    }
+    *pStepCount += pathLength;
+
+    return true;
+}
+
+static void _heapPush(uint16_t state)
+{
+    _heap[_heapSize] = state;
+    _heapPosition[state] = _heapSize;
+    _heapSize++;
+    _heapSiftUp(_heapSize - 1U);
+}
+
+static uint16_t _heapPop(void)
+{
+    uint16_t state = _heap[0];
+
+    _heapSize--;
+    _heapSwap(0U, _heapSize);
+    _heapPosition[state] = PLAN_NO_STATE;
+    _heapSiftDown(0U);
+
+    return state;
+}
+
+static void _heapSiftUp(uint16_t position)
+{
+    while ((position > 0U) && (_cost[_heap[(position - 1U) / 2U]] > _cost[_heap[position]])) {
+        _heapSwap(position, (position - 1U) / 2U);
+        position = (position - 1U) / 2U;
+    }
+}
+
+static void _heapSiftDown(uint16_t position)
+{
+    uint16_t smallest = position;
+    uint16_t child = 0U;
+
+    for (;;) {
+        for (child = 2U * position + 1U; (child <= 2U * position + 2U) && (child < _heapSize); child++) {
+            if (_cost[_heap[child]] < _cost[_heap[smallest]]) {
+                smallest = child;
+            }
+        }
+        if (smallest == position) {
+            break;
+        }
+        _heapSwap(position, smallest);
+        position = smallest;
+    }
+}
+
+static void _heapSwap(uint16_t positionA, uint16_t positionB)
+{
+    uint16_t state = _heap[positionA];
+
+    _heap[positionA] = _heap[positionB];
+    _heap[positionB] = state;
+    _heapPosition[_heap[positionA]] = positionA;
+    _heapPosition[_heap[positionB]] = positionB;
+}
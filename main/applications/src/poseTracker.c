@@ -0,0 +1,176 @@
+/**
+*******************************************************************************
+* @file 	poseTracker.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+/* ____________________________________________________________________________ */
+/* Includes  																	*/
+#include "poseTracker.h"
+#include "esp_timer.h"
+#include "mapping.h"
+#include "servo.h"
+#include <math.h>
+
+/* ____________________________________________________________________________ */
+/* Defines  																	*/
+#define POSE_TAG ("POSE")
+
+/* Wheel speed is assumed linear with commanded speed, as the servo calibration tables make it */
+#define POSE_WHEEL_MAX_SPEED_MM_S (MECH_WHEEL_MAX_RPM * (float)M_PI * MECH_WHEEL_DIAMETER_MM / 60.0F)
+
+#define POSE_STRAIGHT_LINE_THRESHOLD_RAD_S (1e-4F)
+#define US_TO_S(us) ((float)(us) / 1000000.0F)
+
+/* ____________________________________________________________________________ */
+/* Enum  																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																		*/
+typedef struct {
+    pose_t pose;
+    float leftSpeedMmS;
+    float rightSpeedMmS;
+} poseState_t;
+
+/* ____________________________________________________________________________ */
+/* Static prototypes 															*/
+static void _servoOrderHook(uint32_t gpio, float speed, bool forward, int64_t timestampUs);
+static void _integrate(poseState_t* pState, int64_t timestampUs);
+static void _readState(poseState_t* pState);
+static void _writeState(const poseState_t* pState);
+static float _normalizeAngle(float angleRad);
+
+/* ____________________________________________________________________________ */
+/* Static variables 															*/
+static SemaphoreHandle_t _writerMutex = NULL;
+static volatile uint32_t _stateSequence = 0U;
+static poseState_t _state = { 0 };
+
+/* ____________________________________________________________________________ */
+/* ISR handlers 																*/
+
+/* ____________________________________________________________________________ */
+/* Public functions 															*/
+void vPOSE_Init(void)
+{
+    _writerMutex = OS_MUTEX_CREATE("Mutex pose tracker");
+    vPOSE_Reset();
+
+    if (!bSERVO_RegisterOrderHook(_servoOrderHook)) {
+        ESP_LOGE(POSE_TAG, "Cannot register servo order hook");
+    }
+}
+
+void vPOSE_Reset(void)
+{
+    poseState_t state;
+
+    xSemaphoreTake(_writerMutex, portMAX_DELAY);
+    _readState(&state);
+    state.pose.xMm = 0.0F;
+    state.pose.yMm = 0.0F;
+    state.pose.headingRad = 0.0F;
+    state.pose.timestampUs = esp_timer_get_time();
+    _writeState(&state);
+    xSemaphoreGive(_writerMutex);
+}
+
+void vPOSE_GetPose(pose_t* pPose)
+{
+    poseState_t state;
+
+    _readState(&state);
+    /* Extrapolate with wheel speeds applied since last order */
+    _integrate(&state, esp_timer_get_time());
+    memcpy(pPose, &state.pose, sizeof(state.pose));
+}
+
+void vPOSE_GetPathToStart(float* pDistanceMm, float* pRotationRad)
+{
+    pose_t pose;
+
+    vPOSE_GetPose(&pose);
+    *pDistanceMm = sqrtf(pose.xMm * pose.xMm + pose.yMm * pose.yMm);
+    *pRotationRad = _normalizeAngle(atan2f(-pose.yMm, -pose.xMm) - pose.headingRad);
+}
+
+/* ____________________________________________________________________________ */
+/* Static functions 															*/
+
+static void _servoOrderHook(uint32_t gpio, float speed, bool forward, int64_t timestampUs)
+{
+    poseState_t state;
+    float wheelSpeedMmS = (forward ? speed : -speed) * POSE_WHEEL_MAX_SPEED_MM_S / 100.0F;
+
+    if ((gpio == SERVO_LEFT_GPIO_NUM) || (gpio == SERVO_RIGHT_GPIO_NUM)) {
+        xSemaphoreTake(_writerMutex, portMAX_DELAY);
+        _readState(&state);
+        _integrate(&state, timestampUs);
+        if (gpio == SERVO_LEFT_GPIO_NUM) {
+            state.leftSpeedMmS = wheelSpeedMmS;
+        } else {
+            state.rightSpeedMmS = wheelSpeedMmS;
+        }
+        _writeState(&state);
+        xSemaphoreGive(_writerMutex);
+    }
+}
+
+static void _integrate(poseState_t* pState, int64_t timestampUs)
+{
+    float dt = US_TO_S(timestampUs - pState->pose.timestampUs);
+    float linearSpeed = (pState->leftSpeedMmS + pState->rightSpeedMmS) / 2.0F;
+    float angularSpeed = (pState->rightSpeedMmS - pState->leftSpeedMmS) / MECH_WHEEL_TRACK_MM;
+    float heading = pState->pose.headingRad;
+    float newHeading = heading + angularSpeed * dt;
+
+    if (dt > 0.0F) {
+        if (fabsf(angularSpeed) < POSE_STRAIGHT_LINE_THRESHOLD_RAD_S) {
+            pState->pose.xMm += linearSpeed * dt * cosf(heading);
+            pState->pose.yMm += linearSpeed * dt * sinf(heading);
+        } else {
+            /* Exact arc for constant wheel speeds */
+            pState->pose.xMm += (linearSpeed / angularSpeed) * (sinf(newHeading) - sinf(heading));
+            pState->pose.yMm -= (linearSpeed / angularSpeed) * (cosf(newHeading) - cosf(heading));
+        }
+        pState->pose.headingRad = _normalizeAngle(newHeading);
+        pState->pose.timestampUs = timestampUs;
+    }
+}
+
+static void _readState(poseState_t* pState)
+{
+    uint32_t sequence;
+
+    /* Seqlock reader: retry while a write is in progress or happened during the copy */
+    do {
+        sequence = _stateSequence;
+        __sync_synchronize();
+        memcpy(pState, &_state, sizeof(_state));
+        __sync_synchronize();
+    } while (((sequence & 1U) != 0U) || (sequence != _stateSequence));
+}
+
+static void _writeState(const poseState_t* pState)
+{
+    _stateSequence++;
+    __sync_synchronize();
+    memcpy(&_state, pState, sizeof(_state));
+    __sync_synchronize();
+    _stateSequence++;
+}
+
+static float _normalizeAngle(float angleRad)
+{
+    while (angleRad > (float)M_PI) {
+        angleRad -= 2.0F * (float)M_PI;
+    }
+    while (angleRad <= -(float)M_PI) {
+        angleRad += 2.0F * (float)M_PI;
+    }
+
+    return angleRad;
+}
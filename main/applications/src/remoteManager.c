@@ -0,0 +1,416 @@
+/**
+*******************************************************************************
+* @file 	remoteManager.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+/* ____________________________________________________________________________ */
+/* Includes  																	*/
+#include "remoteManager.h"
+#include "deferredLog.h"
+#include "esp_timer.h"
+#include "inputLog.h"
+#include "movementManager.h"
+#include "pathPlanner.h"
+#include "poseTracker.h"
+#include "sequenceManager.h"
+#include "uartLink.h"
+
+/* ____________________________________________________________________________ */
+/* Defines  																	*/
+#define RMT_MNGR_TAG ("RMT_MNGR")
+#define RMT_TELEMETRY_MAX_QUEUES ((LINK_MAX_PAYLOAD_SIZE - RMT_TELEMETRY_HEADER_SIZE) / RMT_TELEMETRY_QUEUE_SIZE)
+#define RMT_RAD_TO_CENTIDEG (5729.578F)
+#define RMT_ROUTE_MAX_BLOCKED_CELLS ((LINK_MAX_PAYLOAD_SIZE - RMT_ROUTE_HEADER_SIZE) / 2U)
+
+/* ____________________________________________________________________________ */
+/* Enum  																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																		*/
+
+_Static_assert(RMT_CALIBRATION_SIZE <= LINK_MAX_PAYLOAD_SIZE, "A calibration table must fit in one frame");
+_Static_assert(LINK_MAX_PAYLOAD_SIZE <= ILOG_FRAME_MAX_PAYLOAD_SIZE, "A frame must fit in one input log record");
+
+/* ____________________________________________________________________________ */
+/* Static prototypes 															*/
+static void _handleFrame(const linkFrame_t* pFrame, bool injected);
+#if SYSTEM_INPUT_LOG_ENABLED
+static void _recordFrame(const linkFrame_t* pFrame);
+static void _injectFrame(uint8_t type, const uint8_t* pPayload, uint8_t length);
+#endif
+static rmtStatus_e _uploadSequence(const linkView_t* pPayload);
+static void _downloadSequence(uint8_t sequence, bool reply);
+static rmtStatus_e _planRoute(const linkView_t* pPayload);
+static rmtStatus_e _move(const linkView_t* pPayload);
+static rmtStatus_e _setTelemetryPeriod(const linkView_t* pPayload);
+static rmtStatus_e _setServoPulse(const linkView_t* pPayload);
+static rmtStatus_e _uploadCalibration(const linkView_t* pPayload);
+static bool _downloadCalibration(const linkView_t* pPayload, uint8_t sequence, bool reply);
+static bool _isSequenceRunning(void);
+static void _sendTelemetry(void);
+static TickType_t _ticksToTelemetry(void);
+static uint8_t _putUint16(uint8_t* pBuffer, uint8_t offset, uint16_t value);
+static uint8_t _putUint32(uint8_t* pBuffer, uint8_t offset, uint32_t value);
+
+/* ____________________________________________________________________________ */
+/* Static variables 															*/
+static TickType_t _telemetryPeriodTicks = 0U;
+static TickType_t _lastTelemetryTicks = 0U;
+static uint8_t _telemetryCount = 0U;
+
+/* ____________________________________________________________________________ */
+/* ISR handlers 																*/
+
+/* ____________________________________________________________________________ */
+/* Public functions 															*/
+void vRMT_Process(void* pvParameters)
+{
+    linkFrame_t frame;
+
+#if SYSTEM_INPUT_LOG_ENABLED
+    vILOG_SetFrameInjector(_injectFrame);
+#endif
+    vLINK_Init();
+    ESP_LOGI(RMT_MNGR_TAG, "Listening at %u bauds", LINK_BAUD_RATE);
+
+    for (;;) {
+        if (bLINK_Receive(&frame, _ticksToTelemetry())) {
+            _handleFrame(&frame, false);
+        }
+        if ((_telemetryPeriodTicks > 0U) && (_ticksToTelemetry() == 0U)) {
+            /* Fixed rate, a late frame does not make the next ones come in a burst */
+            _lastTelemetryTicks += _telemetryPeriodTicks;
+            if ((xTaskGetTickCount() - _lastTelemetryTicks) >= _telemetryPeriodTicks) {
+                _lastTelemetryTicks = xTaskGetTickCount();
+            }
+            _sendTelemetry();
+        }
+    }
+}
+
+/* ____________________________________________________________________________ */
+/* Static functions 															*/
+/* Injected frames come from a replay: handled as received, nobody waits for the replies */
+static void _handleFrame(const linkFrame_t* pFrame, bool injected)
+{
+    rmtStatus_e status = RMT_STATUS_OK;
+    uint8_t ack[2] = { 0 };
+    bool acknowledge = true;
+
+    if (!injected && ILOG_IS_REPLAYING()) {
+        /* A replay owns the inputs: live requests would be mixed with the recorded ones */
+        status = RMT_STATUS_REJECTED;
+    } else {
+#if SYSTEM_INPUT_LOG_ENABLED
+        _recordFrame(pFrame);
+#endif
+        switch (pFrame->type) {
+        case RMT_MSG_PING:
+            break;
+        case RMT_MSG_SEQUENCE_UPLOAD:
+            status = _uploadSequence(&pFrame->payload);
+            break;
+        case RMT_MSG_SEQUENCE_DOWNLOAD:
+            _downloadSequence(pFrame->sequence, !injected);
+            acknowledge = false;
+            break;
+        case RMT_MSG_SEQUENCE_LAUNCH:
+            vSEQMNGR_LaunchSequence();
+            break;
+        case RMT_MSG_SEQUENCE_ABORT:
+            vSEQMNGR_AbortSequence();
+            break;
+        case RMT_MSG_ROUTE_PLAN:
+            status = _planRoute(&pFrame->payload);
+            break;
+        case RMT_MSG_MOVE:
+            status = _move(&pFrame->payload);
+            break;
+        case RMT_MSG_TELEMETRY_PERIOD:
+            status = _setTelemetryPeriod(&pFrame->payload);
+            break;
+        case RMT_MSG_SERVO_PULSE:
+            status = _setServoPulse(&pFrame->payload);
+            break;
+        case RMT_MSG_CALIBRATION_UPLOAD:
+            status = _uploadCalibration(&pFrame->payload);
+            break;
+        case RMT_MSG_CALIBRATION_DOWNLOAD:
+            /* Acknowledged only when there is no table to send back */
+            acknowledge = !_downloadCalibration(&pFrame->payload, pFrame->sequence, !injected);
+            status = acknowledge ? RMT_STATUS_REJECTED : RMT_STATUS_OK;
+            break;
+        default:
+            status = RMT_STATUS_UNKNOWN_TYPE;
+            break;
+        }
+    }
+
+    DLOGI(RMT_MNGR_TAG, "Request 0x%02X (%u bytes): status %u", pFrame->type, pFrame->payload.length, status);
+    if (acknowledge && !injected) {
+        ack[0] = pFrame->type;
+        ack[1] = (uint8_t)status;
+        bLINK_Send(RMT_MSG_ACK, pFrame->sequence, ack, sizeof(ack), pdMS_TO_TICKS(RMT_REPLY_TIMEOUT_MS));
+    }
+}
+
+#if SYSTEM_INPUT_LOG_ENABLED
+static void _recordFrame(const linkFrame_t* pFrame)
+{
+    uint8_t payload[LINK_MAX_PAYLOAD_SIZE];
+
+    /* The payload may wrap around the receive ring, records hold it in one piece */
+    for (uint8_t offset = 0U; offset < pFrame->payload.length; offset++) {
+        payload[offset] = u8LINK_GetByte(&pFrame->payload, offset);
+    }
+    ILOG_FRAME(pFrame->type, payload, pFrame->payload.length);
+}
+
+static void _injectFrame(uint8_t type, const uint8_t* pPayload, uint8_t length)
+{
+    linkFrame_t frame = {
+        .type = type,
+        .sequence = 0U,
+        .payload = { .pFirst = pPayload, .pSecond = NULL, .firstLength = length, .length = length },
+    };
+
+    _handleFrame(&frame, true);
+}
+#endif
+
+static rmtStatus_e _uploadSequence(const linkView_t* pPayload)
+{
+    movementType_e movements[SEQUENCE_MAX_SIZE];
+    rmtStatus_e status = (pPayload->length <= SEQUENCE_MAX_SIZE) ? RMT_STATUS_OK : RMT_STATUS_BAD_PAYLOAD;
+
+    /* Steps are decoded from the receive ring, stop is not a step */
+    for (uint8_t index = 0U; (index < pPayload->length) && (status == RMT_STATUS_OK); index++) {
+        movements[index] = (movementType_e)u8LINK_GetByte(pPayload, index);
+        if ((movements[index] == MOVEMENT_STOP) || (movements[index] >= MOVEMENT_NUMBER)) {
+            status = RMT_STATUS_BAD_PAYLOAD;
+        }
+    }
+    if ((status == RMT_STATUS_OK) && !bSEQMNGR_SetSequence(movements, pPayload->length)) {
+        status = RMT_STATUS_REJECTED;
+    }
+
+    return status;
+}
+
+static void _downloadSequence(uint8_t sequence, bool reply)
+{
+    movementType_e movements[SEQUENCE_MAX_SIZE];
+    uint8_t payload[SEQUENCE_MAX_SIZE];
+    uint8_t length = u8SEQMNGR_GetSequence(movements, SEQUENCE_MAX_SIZE);
+
+    for (uint8_t index = 0U; index < length; index++) {
+        payload[index] = (uint8_t)movements[index];
+    }
+    if (reply) {
+        bLINK_Send(RMT_MSG_SEQUENCE_CONTENT, sequence, payload, length, pdMS_TO_TICKS(RMT_REPLY_TIMEOUT_MS));
+    }
+}
+
+static rmtStatus_e _planRoute(const linkView_t* pPayload)
+{
+    planCell_t targets[PLAN_MAX_TARGETS];
+    planCell_t blockedCells[RMT_ROUTE_MAX_BLOCKED_CELLS];
+    planGrid_t grid = { 0 };
+    planPose_t start = { 0 };
+    uint8_t targetCount = u8LINK_GetByte(pPayload, 5U);
+    uint8_t offset = RMT_ROUTE_HEADER_SIZE;
+    rmtStatus_e status = RMT_STATUS_OK;
+
+    if ((pPayload->length < RMT_ROUTE_HEADER_SIZE) || (targetCount == 0U) || (targetCount > PLAN_MAX_TARGETS)
+        || (pPayload->length < (RMT_ROUTE_HEADER_SIZE + (2U * targetCount))) || ((pPayload->length % 2U) != 0U)
+        || (u8LINK_GetByte(pPayload, 4U) >= PLAN_HEADING_NUMBER)) {
+        status = RMT_STATUS_BAD_PAYLOAD;
+    } else {
+        grid.width = u8LINK_GetByte(pPayload, 0U);
+        grid.height = u8LINK_GetByte(pPayload, 1U);
+        start.cell.x = u8LINK_GetByte(pPayload, 2U);
+        start.cell.y = u8LINK_GetByte(pPayload, 3U);
+        start.heading = (planHeading_e)u8LINK_GetByte(pPayload, 4U);
+        for (uint8_t target = 0U; target < targetCount; target++, offset += 2U) {
+            targets[target].x = u8LINK_GetByte(pPayload, offset);
+            targets[target].y = u8LINK_GetByte(pPayload, offset + 1U);
+        }
+        for (; offset < pPayload->length; offset += 2U) {
+            blockedCells[grid.blockedCount].x = u8LINK_GetByte(pPayload, offset);
+            blockedCells[grid.blockedCount].y = u8LINK_GetByte(pPayload, offset + 1U);
+            grid.blockedCount++;
+        }
+        grid.pBlockedCells = blockedCells;
+        /* Rejected for a grid out of bounds, an unreachable target or a route too long. A running sequence is
+         * replaced, as by an upload. Planned on the calling task, this one or the replay task: both share the
+         * planner buffers, live requests are refused while a replay runs so they never plan together */
+        if (!bPLAN_LoadRoute(&grid, &start, targets, targetCount)) {
+            status = RMT_STATUS_REJECTED;
+        }
+    }
+
+    return status;
+}
+
+static rmtStatus_e _move(const linkView_t* pPayload)
+{
+    movementType_e movement = (movementType_e)u8LINK_GetByte(pPayload, 0U);
+    rmtStatus_e status = RMT_STATUS_OK;
+
+    if ((pPayload->length != 1U) || (movement >= MOVEMENT_NUMBER)) {
+        status = RMT_STATUS_BAD_PAYLOAD;
+    } else if (_isSequenceRunning()) {
+        /* A live move would cut the running step and break the sequence chain. A stop aborts the sequence: stopped
+         * on its own, the step would never end and the sequence would stay running */
+        if (movement == MOVEMENT_STOP) {
+            vSEQMNGR_AbortSequence();
+        } else {
+            status = RMT_STATUS_REJECTED;
+        }
+    } else {
+        vMVT_Move(movement, NULL);
+    }
+
+    return status;
+}
+
+static rmtStatus_e _setTelemetryPeriod(const linkView_t* pPayload)
+{
+    uint16_t periodMs = u16LINK_GetUint16(pPayload, 0U);
+    rmtStatus_e status = RMT_STATUS_OK;
+
+    if ((pPayload->length != 2U) || ((periodMs > 0U) && (periodMs < RMT_TELEMETRY_MIN_PERIOD_MS))) {
+        status = RMT_STATUS_BAD_PAYLOAD;
+    } else {
+        _telemetryPeriodTicks = pdMS_TO_TICKS(periodMs);
+        if ((periodMs > 0U) && (_telemetryPeriodTicks == 0U)) {
+            _telemetryPeriodTicks = 1U;
+        }
+        _lastTelemetryTicks = xTaskGetTickCount();
+    }
+
+    return status;
+}
+
+static rmtStatus_e _setServoPulse(const linkView_t* pPayload)
+{
+    rmtStatus_e status = RMT_STATUS_OK;
+
+    if (pPayload->length != 3U) {
+        status = RMT_STATUS_BAD_PAYLOAD;
+    } else if (_isSequenceRunning()
+        || !bSERVO_SetPulse(u8LINK_GetByte(pPayload, 0U), u16LINK_GetUint16(pPayload, 1U))) {
+        /* Unknown pin, pulse out of the servo range, emergency stop latched or a sequence driving the wheels */
+        status = RMT_STATUS_REJECTED;
+    }
+
+    return status;
+}
+
+static rmtStatus_e _uploadCalibration(const linkView_t* pPayload)
+{
+    servoCalibration_t calibration;
+    rmtStatus_e status = RMT_STATUS_OK;
+
+    if (pPayload->length != RMT_CALIBRATION_SIZE) {
+        status = RMT_STATUS_BAD_PAYLOAD;
+    } else {
+        for (uint8_t point = 0U; point < SERVO_CAL_POINTS; point++) {
+            calibration.pulseUs[point] = u16LINK_GetUint16(pPayload, 1U + (2U * point));
+        }
+        /* The driver checks the table and refuses it while a servo is driven */
+        if (!bSERVO_SetCalibration(u8LINK_GetByte(pPayload, 0U), &calibration)) {
+            status = RMT_STATUS_REJECTED;
+        }
+    }
+
+    return status;
+}
+
+static bool _downloadCalibration(const linkView_t* pPayload, uint8_t sequence, bool reply)
+{
+    servoCalibration_t calibration;
+    uint8_t payload[RMT_CALIBRATION_SIZE];
+    uint8_t length = 0U;
+    bool result = (pPayload->length == 1U) && bSERVO_GetCalibration(u8LINK_GetByte(pPayload, 0U), &calibration);
+
+    if (result && reply) {
+        payload[length++] = u8LINK_GetByte(pPayload, 0U);
+        for (uint8_t point = 0U; point < SERVO_CAL_POINTS; point++) {
+            length = _putUint16(payload, length, calibration.pulseUs[point]);
+        }
+        bLINK_Send(RMT_MSG_CALIBRATION_CONTENT, sequence, payload, length, pdMS_TO_TICKS(RMT_REPLY_TIMEOUT_MS));
+    }
+
+    return result;
+}
+
+static bool _isSequenceRunning(void)
+{
+    seqStatus_t sequenceStatus;
+
+    vSEQMNGR_GetStatus(&sequenceStatus);
+    return sequenceStatus.step > 0U;
+}
+
+static void _sendTelemetry(void)
+{
+    uint8_t payload[LINK_MAX_PAYLOAD_SIZE];
+    osQueueStats_t queueStats[RMT_TELEMETRY_MAX_QUEUES];
+    seqStatus_t sequenceStatus;
+    linkStats_t linkStats;
+    pose_t pose;
+    uint8_t queueNumber = u8OS_GetQueueStats(queueStats, RMT_TELEMETRY_MAX_QUEUES);
+    uint8_t length = 0U;
+
+    /* Snapshots only: no request is sent to the control tasks */
+    vSEQMNGR_GetStatus(&sequenceStatus);
+    vPOSE_GetPose(&pose);
+    vLINK_GetStats(&linkStats);
+
+    length = _putUint32(payload, length, (uint32_t)(esp_timer_get_time() / 1000LL));
+    payload[length++] = sequenceStatus.length;
+    payload[length++] = sequenceStatus.step;
+    length = _putUint32(payload, length, (uint32_t)(int32_t)(pose.xMm * 10.0F));
+    length = _putUint32(payload, length, (uint32_t)(int32_t)(pose.yMm * 10.0F));
+    length = _putUint16(payload, length, (uint16_t)(int16_t)(pose.headingRad * RMT_RAD_TO_CENTIDEG));
+    length = _putUint16(payload, length, (uint16_t)linkStats.crcErrors);
+    length = _putUint16(payload, length, (uint16_t)linkStats.rxOverflows);
+    length = _putUint16(payload, length, (uint16_t)linkStats.txDropped);
+    payload[length++] = queueNumber;
+    for (uint8_t index = 0U; index < queueNumber; index++) {
+        payload[length++] = (uint8_t)queueStats[index].highWaterMark;
+        length = _putUint16(payload, length, (uint16_t)(queueStats[index].failedSends + queueStats[index].timeouts));
+    }
+
+    /* Never waits: a frame still in flight means the host reads slower than the stream, this one is dropped */
+    bLINK_Send(RMT_MSG_TELEMETRY, _telemetryCount++, payload, length, 0U);
+}
+
+static TickType_t _ticksToTelemetry(void)
+{
+    TickType_t elapsedTicks = xTaskGetTickCount() - _lastTelemetryTicks;
+    TickType_t result = portMAX_DELAY;
+
+    if (_telemetryPeriodTicks > 0U) {
+        result = (elapsedTicks < _telemetryPeriodTicks) ? (_telemetryPeriodTicks - elapsedTicks) : 0U;
+    }
+
+    return result;
+}
+
+static uint8_t _putUint16(uint8_t* pBuffer, uint8_t offset, uint16_t value)
+{
+    pBuffer[offset] = (uint8_t)(value & 0xFFU);
+    pBuffer[offset + 1U] = (uint8_t)(value >> 8);
+    return offset + 2U;
+}
+
+static uint8_t _putUint32(uint8_t* pBuffer, uint8_t offset, uint32_t value)
+{
+    offset = _putUint16(pBuffer, offset, (uint16_t)(value & 0xFFFFU));
+    return _putUint16(pBuffer, offset, (uint16_t)(value >> 16));
+}
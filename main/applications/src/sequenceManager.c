@@ -9,11 +9,14 @@
 /* ____________________________________________________________________________ */
 /* Includes  																	*/
 #include "sequenceManager.h"
+#include "deadlineMonitor.h"
+#include "deferredLog.h"
+#include "stateMachine.h"
+#include "trace.h"
 
 /* ____________________________________________________________________________ */
 /* Defines  																	*/
 #define SEQ_MNGR_TAG ("SEQ_MNGR")
-#define SEQUENCE_MAX_SIZE (50U)
 
 /* ____________________________________________________________________________ */
 /* Enum  																		*/
@@ -23,25 +26,123 @@ typedef enum {
     LAUNCH_SEQUENCE,
     ABORT_SEQUENCE,
     END_OF_CURRENT_MOVEMENT,
+    SET_SEQUENCE,
+    GET_SEQUENCE,
+    /* Do not erase */
+    SEQUENCE_EVENT_NUMBER
 } sequenceEvent_e;
 
+typedef enum {
+    SEQUENCE_STATE_IDLE = 0, /* Sequence can be edited, no step runs */
+    SEQUENCE_STATE_RUNNING, /* A step runs, the end of movement starts the next one */
+    /* Do not erase */
+    SEQUENCE_STATE_NUMBER
+} sequenceState_e;
+
 /* ____________________________________________________________________________ */
 /* Struct																		*/
 typedef struct {
-    sequenceEvent_e type;
     movementType_e movement;
+    uint16_t durationTicks;
+} sequenceStep_t;
+
+typedef struct {
+    const movementType_e* pMovements;
+    const uint16_t* pDurationTicks; /* NULL for profile durations */
+    uint8_t length;
+} sequenceContent_t;
+
+typedef struct {
+    movementType_e* pMovements;
+    uint8_t maxLength;
+} sequenceBuffer_t;
+
+typedef struct {
+    sequenceEvent_e type;
+    queueContext_t responseQueue;
+    union {
+        sequenceStep_t step;
+        sequenceContent_t content;
+        sequenceBuffer_t buffer;
+        uint32_t stepToken; /* End of movement: token of the step that ended */
+    };
 } sequenceEvent_t;
 
 /* ____________________________________________________________________________ */
 /* Static prototypes 															*/
-void endOfMovementCallback(void);
+void endOfMovementCallback(uint32_t stepToken);
+static void _init(void);
+static void _publishStatus(void);
+static TickType_t _handleEvent(void* pSequenceEvent);
+static void _enterRunning(void);
+static void _exitRunning(void);
+static void _startNextStep(void);
+static bool _addMovement(void* pEvent);
+static bool _removeLastMovement(void* pEvent);
+static bool _launch(void* pEvent);
+static bool _abort(void* pEvent);
+static bool _clear(void* pEvent);
+static bool _endOfStep(void* pEvent);
+static bool _setSequence(void* pEvent);
+static bool _replaceSequence(void* pEvent);
+static bool _loadSequence(sequenceEvent_t* pEvent, bool stopRunningStep);
+static bool _getSequence(void* pEvent);
 
 /* ____________________________________________________________________________ */
 /* Static variables 															*/
 static QueueHandle_t _queueForSequence = NULL;
 static movementType_e _sequence[SEQUENCE_MAX_SIZE] = { [0 ... SEQUENCE_MAX_SIZE - 1] = MOVEMENT_STOP };
+/* Step durations are kept as tick deltas, 2 bytes per step */
+static uint16_t _durationTicks[SEQUENCE_MAX_SIZE] = { [0 ... SEQUENCE_MAX_SIZE - 1] = SEQUENCE_DEFAULT_DURATION };
 static uint8_t _sequenceLength = 0U;
 static uint8_t _sequenceReadIndex = 0U;
+static uint32_t _stepToken = 0U; /* Given to each started step, ends of earlier steps are stale */
+static seqStatus_t _status = { 0 };
+static portMUX_TYPE _statusMux = portMUX_INITIALIZER_UNLOCKED;
+static stateMachine_t _machine = { 0 };
+static const smState_t _states[SEQUENCE_STATE_NUMBER] = {
+    [SEQUENCE_STATE_IDLE] = { .name = "Idle", .timeoutTicks = portMAX_DELAY, .timeoutEvent = SM_NO_EVENT },
+    [SEQUENCE_STATE_RUNNING] = { .name = "Running", .entry = _enterRunning, .exit = _exitRunning, .timeoutTicks = portMAX_DELAY, .timeoutEvent = SM_NO_EVENT },
+};
+/* An end of movement received while idle belongs to an aborted or replaced sequence, it is ignored */
+static const smTransition_t _transitions[SEQUENCE_STATE_NUMBER][SEQUENCE_EVENT_NUMBER] = {
+    [SEQUENCE_STATE_IDLE] = {
+        [ADD_NEW_MOVEMENT] = SM_INTERNAL(_addMovement),
+        [REMOVE_LAST_MOVEMENT] = SM_INTERNAL(_removeLastMovement),
+        [LAUNCH_SEQUENCE] = SM_TO(SEQUENCE_STATE_RUNNING, _launch),
+        [ABORT_SEQUENCE] = SM_INTERNAL(_clear),
+        [SET_SEQUENCE] = SM_INTERNAL(_setSequence),
+        [GET_SEQUENCE] = SM_INTERNAL(_getSequence),
+    },
+    /* Relaunch restarts from the first step, the running movement is replaced without a stop */
+    [SEQUENCE_STATE_RUNNING] = {
+        [ADD_NEW_MOVEMENT] = SM_INTERNAL(_addMovement),
+        [REMOVE_LAST_MOVEMENT] = SM_INTERNAL(_removeLastMovement),
+        [LAUNCH_SEQUENCE] = SM_TO(SEQUENCE_STATE_RUNNING, NULL),
+        [ABORT_SEQUENCE] = SM_TO(SEQUENCE_STATE_IDLE, _abort),
+        [END_OF_CURRENT_MOVEMENT] = SM_TO(SEQUENCE_STATE_IDLE, _endOfStep),
+        [SET_SEQUENCE] = SM_TO(SEQUENCE_STATE_IDLE, _replaceSequence),
+        [GET_SEQUENCE] = SM_INTERNAL(_getSequence),
+    },
+};
+static const smDefinition_t _machineDefinition = {
+    .name = "Sequence",
+    .traceId = BOOT_MODULE_SEQUENCE_MANAGER,
+    .pStates = _states,
+    .stateNumber = SEQUENCE_STATE_NUMBER,
+    .pTransitions = &_transitions[0][0],
+    .eventNumber = SEQUENCE_EVENT_NUMBER,
+    .initialState = SEQUENCE_STATE_IDLE,
+};
+static const reactorModule_t _reactorModule = {
+    .name = "Sequence manager",
+    .bootModule = BOOT_MODULE_SEQUENCE_MANAGER,
+    .pQueue = &_queueForSequence,
+    .queueLength = SEQUENCE_QUEUE_LENGTH,
+    .eventSize = sizeof(sequenceEvent_t),
+    .init = _init,
+    .handleEvent = _handleEvent,
+};
 
 /* ____________________________________________________________________________ */
 /* ISR handlers 																*/
@@ -50,63 +151,29 @@ static uint8_t _sequenceReadIndex = 0U;
 /* Public functions 															*/
 void vSEQMNGR_Process(void* pvParameters)
 {
-    sequenceEvent_t event = { 0 };
-
-    _queueForSequence = xQueueCreate(5U, sizeof(event));
-
-    for (;;) {
-        xQueueReceive(_queueForSequence, &event, portMAX_DELAY);
-
-        switch (event.type) {
-        case ADD_NEW_MOVEMENT:
-            _sequence[_sequenceLength++] = event.movement;
-            ESP_LOGI(SEQ_MNGR_TAG, "New movement added: %d (%d steps)", event.movement, _sequenceLength);
-            break;
-        case REMOVE_LAST_MOVEMENT:
-            if (_sequenceLength > 0U) {
-                _sequenceLength--;
-                ESP_LOGI(SEQ_MNGR_TAG, "Last movement has been removed (%d steps left)", _sequenceLength);
-            } else {
-                ESP_LOGE(SEQ_MNGR_TAG, "Impossible to remove last movement, sequence is empty");
-            }
-            break;
-        case ABORT_SEQUENCE:
-            vMVT_Move(MOVEMENT_STOP, NULL);
-            _sequenceLength = 0U;
-            ESP_LOGI(SEQ_MNGR_TAG, "Sequence aborted");
-            break;
-        case LAUNCH_SEQUENCE:
-            _sequenceReadIndex = 0U;
-            if (_sequenceLength > 0U) {
-                vMVT_Move(_sequence[_sequenceReadIndex++], endOfMovementCallback);
-                ESP_LOGI(SEQ_MNGR_TAG, "Sequence launched (%d steps)", _sequenceLength);
-            } else {
-                ESP_LOGE(SEQ_MNGR_TAG, "Impossible to launch sequence, it is empty");
-            }
-            break;
-        case END_OF_CURRENT_MOVEMENT:
-            if (_sequenceReadIndex < _sequenceLength) {
-                ESP_LOGI(SEQ_MNGR_TAG, "Next movement: %d (index %d)", _sequence[_sequenceReadIndex], _sequenceReadIndex);
-                vMVT_Move(_sequence[_sequenceReadIndex++], endOfMovementCallback);
-            } else {
-                _sequenceReadIndex = 0U;
-                ESP_LOGI(SEQ_MNGR_TAG, "END OF SEQUENCE");
-            }
-            break;
-        default:
-            break;
-        }
-    }
+    vREACTOR_RunModule(&_reactorModule);
+}
+
+const reactorModule_t* pSEQMNGR_GetReactorModule(void)
+{
+    return &_reactorModule;
 }
 
 void vSEQMNGR_AddNewMovement(movementType_e movement)
+{
+    vSEQMNGR_AddTimedMovement(movement, SEQUENCE_DEFAULT_DURATION);
+}
+
+void vSEQMNGR_AddTimedMovement(movementType_e movement, uint16_t durationTicks)
 {
     sequenceEvent_t event;
 
     event.type = ADD_NEW_MOVEMENT;
-    event.movement = movement;
+    event.step.movement = movement;
+    event.step.durationTicks = durationTicks;
 
-    xQueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SEQUENCE_MANAGER, event.type);
+    bOS_QueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
 }
 
 void vSEQMNGR_RemoveLastMovement(void)
@@ -115,7 +182,8 @@ void vSEQMNGR_RemoveLastMovement(void)
 
     event.type = REMOVE_LAST_MOVEMENT;
 
-    xQueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SEQUENCE_MANAGER, event.type);
+    bOS_QueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
 }
 
 void vSEQMNGR_LaunchSequence(void)
@@ -124,7 +192,8 @@ void vSEQMNGR_LaunchSequence(void)
 
     event.type = LAUNCH_SEQUENCE;
 
-    xQueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SEQUENCE_MANAGER, event.type);
+    bOS_QueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
 }
 
 void vSEQMNGR_AbortSequence(void)
@@ -133,17 +202,248 @@ void vSEQMNGR_AbortSequence(void)
 
     event.type = ABORT_SEQUENCE;
 
-    xQueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SEQUENCE_MANAGER, event.type);
+    bOS_QueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+}
+
+bool bSEQMNGR_SetSequence(const movementType_e* pMovements, uint8_t length)
+{
+    return bSEQMNGR_SetTimedSequence(pMovements, NULL, length);
+}
+
+bool bSEQMNGR_SetTimedSequence(const movementType_e* pMovements, const uint16_t* pDurationTicks, uint8_t length)
+{
+    sequenceEvent_t event;
+    bool result = false;
+
+    event.type = SET_SEQUENCE;
+    event.content.pMovements = pMovements;
+    event.content.pDurationTicks = pDurationTicks;
+    event.content.length = length;
+
+    if (!bOS_SendToTaskAndWaitResponse(_queueForSequence, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(SEQ_MNGR_TAG, "Cannot get response from task");
+    }
+    return result;
+}
+
+uint8_t u8SEQMNGR_GetSequence(movementType_e* pMovements, uint8_t maxLength)
+{
+    sequenceEvent_t event;
+    uint8_t result = 0U;
+
+    event.type = GET_SEQUENCE;
+    event.buffer.pMovements = pMovements;
+    event.buffer.maxLength = maxLength;
+
+    if (!bOS_SendToTaskAndWaitResponse(_queueForSequence, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(SEQ_MNGR_TAG, "Cannot get response from task");
+    }
+    return result;
+}
+
+void vSEQMNGR_GetStatus(seqStatus_t* pStatus)
+{
+    portENTER_CRITICAL(&_statusMux);
+    memcpy(pStatus, &_status, sizeof(_status));
+    portEXIT_CRITICAL(&_statusMux);
 }
 
 /* ____________________________________________________________________________ */
 /* Static functions 															*/
 
-void endOfMovementCallback(void)
+void endOfMovementCallback(uint32_t stepToken)
 {
     sequenceEvent_t event;
 
     event.type = END_OF_CURRENT_MOVEMENT;
+    event.stepToken = stepToken;
+
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SEQUENCE_MANAGER, event.type);
+    bOS_QueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+}
+
+static void _init(void)
+{
+    _queueForSequence = OS_QUEUE_CREATE("Queue sequence manager", SEQUENCE_QUEUE_LENGTH, sizeof(sequenceEvent_t));
+    vSM_Start(&_machine, &_machineDefinition);
+}
+
+static void _publishStatus(void)
+{
+    portENTER_CRITICAL(&_statusMux);
+    _status.length = _sequenceLength;
+    _status.step = _sequenceReadIndex;
+    portEXIT_CRITICAL(&_statusMux);
+}
+
+static TickType_t _handleEvent(void* pSequenceEvent)
+{
+    sequenceEvent_t* pEvent = (sequenceEvent_t*)pSequenceEvent;
+    TickType_t result = portMAX_DELAY;
+
+    if (pEvent == NULL) {
+        result = xSM_HandleTimeout(&_machine);
+    } else if ((pEvent->type == END_OF_CURRENT_MOVEMENT) && (pEvent->stepToken != _stepToken)) {
+        /* Step ended before a relaunch or an abort and launch was handled, chaining on it would skip a step */
+        result = xSM_HandleTimeout(&_machine);
+    } else {
+        /* Only launches and step transitions continue the deadline chain up to a servo write, the hop is stamped
+         * when a step starts */
+        if ((pEvent->type != LAUNCH_SEQUENCE) && (pEvent->type != END_OF_CURRENT_MOVEMENT)) {
+            DLN_ABANDON();
+        }
+        result = xSM_Dispatch(&_machine, pEvent->type, pEvent);
+        if (u8SM_GetState(&_machine) == SEQUENCE_STATE_IDLE) {
+            DLN_ABANDON();
+        }
+    }
+    _publishStatus();
+
+    return result;
+}
+
+static void _enterRunning(void)
+{
+    _sequenceReadIndex = 0U;
+    DLOGI(SEQ_MNGR_TAG, "Sequence launched (%d steps)", _sequenceLength);
+    _startNextStep();
+}
+
+static void _exitRunning(void)
+{
+    _sequenceReadIndex = 0U;
+}
+
+static void _startNextStep(void)
+{
+    DLN_STAMP(DLN_STAGE_SEQUENCE_MANAGER);
+    TRACE_EVENT(TRACE_ID_SEQUENCE_STEP, _sequenceReadIndex, _sequence[_sequenceReadIndex]);
+    vMVT_MoveFor(_sequence[_sequenceReadIndex], _durationTicks[_sequenceReadIndex], endOfMovementCallback, ++_stepToken);
+    _sequenceReadIndex++;
+}
+
+static bool _addMovement(void* pEvent)
+{
+    sequenceEvent_t* pSequenceEvent = (sequenceEvent_t*)pEvent;
+
+    if (_sequenceLength < SEQUENCE_MAX_SIZE) {
+        _sequence[_sequenceLength] = pSequenceEvent->step.movement;
+        _durationTicks[_sequenceLength++] = pSequenceEvent->step.durationTicks;
+        DLOGI(SEQ_MNGR_TAG, "New movement added: %d for %d ticks (%d steps)", pSequenceEvent->step.movement, pSequenceEvent->step.durationTicks, _sequenceLength);
+    } else {
+        DLOGE(SEQ_MNGR_TAG, "Impossible to add movement, sequence is full");
+    }
+
+    return true;
+}
+
+static bool _removeLastMovement(void* pEvent)
+{
+    /* Steps already started cannot be removed */
+    if (_sequenceLength > _sequenceReadIndex) {
+        _sequenceLength--;
+        DLOGI(SEQ_MNGR_TAG, "Last movement has been removed (%d steps left)", _sequenceLength);
+    } else {
+        DLOGE(SEQ_MNGR_TAG, "Impossible to remove last movement, no step left to remove");
+    }
+
+    return true;
+}
+
+static bool _launch(void* pEvent)
+{
+    bool result = (_sequenceLength > 0U);
+
+    if (!result) {
+        DLOGE(SEQ_MNGR_TAG, "Impossible to launch sequence, it is empty");
+    }
+
+    return result;
+}
+
+static bool _abort(void* pEvent)
+{
+    /* Leaving the running state: its step is stopped */
+    vMVT_Move(MOVEMENT_STOP, NULL);
+
+    return _clear(pEvent);
+}
+
+static bool _clear(void* pEvent)
+{
+    /* No step runs: a live or teach move is not ours to stop */
+    _sequenceLength = 0U;
+    DLOGI(SEQ_MNGR_TAG, "Sequence aborted");
+
+    return true;
+}
+
+static bool _endOfStep(void* pEvent)
+{
+    bool result = (_sequenceReadIndex >= _sequenceLength);
+
+    /* Staying in the running state is the next step, leaving it is the end of the sequence */
+    if (result) {
+        DLOGI(SEQ_MNGR_TAG, "END OF SEQUENCE");
+    } else {
+        DLOGI(SEQ_MNGR_TAG, "Next movement: %d (index %d)", _sequence[_sequenceReadIndex], _sequenceReadIndex);
+        _startNextStep();
+    }
+
+    return result;
+}
+
+static bool _setSequence(void* pEvent)
+{
+    return _loadSequence((sequenceEvent_t*)pEvent, false);
+}
+
+static bool _replaceSequence(void* pEvent)
+{
+    /* Running sequence is replaced, do not let it chain on new content */
+    return _loadSequence((sequenceEvent_t*)pEvent, true);
+}
+
+static bool _loadSequence(sequenceEvent_t* pEvent, bool stopRunningStep)
+{
+    /* Content is read from the requester buffers, only while it still waits for the response */
+    bool result = bOS_IsResponseAwaited(&pEvent->responseQueue);
+
+    if (!result) {
+        DLOGE(SEQ_MNGR_TAG, "Impossible to load sequence, request expired");
+    } else if (pEvent->content.length > SEQUENCE_MAX_SIZE) {
+        result = false;
+        DLOGE(SEQ_MNGR_TAG, "Impossible to load sequence, %d steps is too long", pEvent->content.length);
+    } else {
+        memcpy(_sequence, pEvent->content.pMovements, pEvent->content.length * sizeof(movementType_e));
+        for (uint8_t step = 0U; step < pEvent->content.length; step++) {
+            _durationTicks[step] = (pEvent->content.pDurationTicks != NULL) ? pEvent->content.pDurationTicks[step] : SEQUENCE_DEFAULT_DURATION;
+        }
+        _sequenceLength = pEvent->content.length;
+        /* After the copy, the stop may block on a full queue */
+        if (stopRunningStep) {
+            vMVT_Move(MOVEMENT_STOP, NULL);
+        }
+        DLOGI(SEQ_MNGR_TAG, "New sequence loaded (%d steps)", _sequenceLength);
+    }
+    vOS_QueueSendSafe(&pEvent->responseQueue, &result);
+
+    return result;
+}
+
+static bool _getSequence(void* pEvent)
+{
+    sequenceEvent_t* pSequenceEvent = (sequenceEvent_t*)pEvent;
+    uint8_t length = (_sequenceLength < pSequenceEvent->buffer.maxLength) ? _sequenceLength : pSequenceEvent->buffer.maxLength;
+
+    /* Requester buffer is gone once it stopped waiting */
+    if (bOS_IsResponseAwaited(&pSequenceEvent->responseQueue)) {
+        memcpy(pSequenceEvent->buffer.pMovements, _sequence, length * sizeof(movementType_e));
+        vOS_QueueSendSafe(&pSequenceEvent->responseQueue, &length);
+    } else {
+        DLOGE(SEQ_MNGR_TAG, "Impossible to get sequence, request expired");
+    }
 
-    xQueueSend(_queueForSequence, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    return true;
 }
@@ -0,0 +1,20 @@
+/**
+******************************************************************************
+* @file 	benchmark.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "system_def.h"
+
+/* Registers the servo order hook, call before any servo order is applied */
+void vBENCH_Init(void);
+
+/* Runs the suite once, results are printed as "@B {json}" lines, see tools/bench_compare.py */
+void vBENCH_Process(void* pvParameters);
+
+#endif //__BENCHMARK_H__
@@ -0,0 +1,489 @@
+/**
+******************************************************************************
+* @file 	benchmark.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "benchmark.h"
+#include "buttons.h"
+#include "buttonsManager.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "leds.h"
+#include "mapping.h"
+#include "movementManager.h"
+#include "power.h"
+#include "sequenceManager.h"
+#include "servo.h"
+#include "xtensa/hal.h"
+
+#if SYSTEM_BENCHMARK_ENABLED
+
+/* Define */
+#define TAG_BENCH ("BENCH")
+#define BENCH_ECHO_QUEUE_LENGTH (1U)
+#define BENCH_LED_COLOR (0x00FF00U)
+#define BENCH_EDGE_PRESS_LEVEL (1U) /* Buttons are active high */
+#define BENCH_EDGE_PERIOD_TICKS (pdMS_TO_TICKS(1000U / BENCH_EDGE_RATE_HZ))
+#define BENCH_NAME_LENGTH (48U)
+#define BENCH_TICK_PERIOD_US (BENCH_TICK_PERIOD_MS * 1000U)
+#define BENCH_PROBE_STACK_SIZE (2048U)
+#define US_PER_SECOND (1000000U)
+
+/* Enum */
+typedef enum {
+    BENCH_UNIT_CYCLES = 0, /* CPU cycle counter, start and end on the same core */
+    BENCH_UNIT_US, /* esp_timer, for spans crossing tasks that may run on both cores */
+    /* Do not erase */
+    BENCH_UNIT_NUMBER
+} benchUnit_e;
+
+/* Struct */
+typedef struct {
+    queueContext_t responseQueue;
+    uint32_t value;
+} benchEchoEvent_t;
+
+/* Static prototypes */
+static void _echoProcess(void* pvParameters);
+static void _benchRoundTrip(void);
+static void _benchQueues(void);
+static void _benchServoOrder(void);
+static void _benchLedUpdate(void);
+static void _benchEdgeToServo(void);
+static void _benchEdgeToIsr(void);
+static void _benchServoTick(void);
+static void _orderHook(uint32_t gpio, float speed, bool forward, int64_t timestampUs);
+static void _edgeIsrCallback(BaseType_t* pHigherTaskWoken);
+static void _tickProbeProcess(void* pvParameters);
+static void _loadProcess(void* pvParameters);
+static void _beginRun(void);
+static void _stopCycles(uint32_t startCycles, BaseType_t startCore);
+static void _addSample(uint32_t value);
+static void _report(const char* name, benchUnit_e unit);
+static uint32_t _percentile(uint32_t percent);
+static int _compareSamples(const void* pA, const void* pB);
+
+/* Static variables */
+static const char* _unitNames[BENCH_UNIT_NUMBER] = {
+    [BENCH_UNIT_CYCLES] = "cycles",
+    [BENCH_UNIT_US] = "us",
+};
+static const reactorModule_t* (*const _moduleGetters[])(void) = {
+    pBUT_GetReactorModule,
+    pSERVO_GetReactorModule,
+    pLED_GetReactorModule,
+    pMVT_GetReactorModule,
+    pSEQMNGR_GetReactorModule,
+    pBUTMNGR_GetReactorModule,
+};
+static uint32_t _samples[BENCH_SAMPLES] = { 0 };
+static uint32_t _sampleCount = 0U;
+static uint32_t _droppedCount = 0U;
+static QueueHandle_t _echoQueue = NULL;
+static TaskHandle_t _benchTask = NULL;
+static bool _edgePending = false;
+static int64_t _edgeStartUs = 0;
+static uint32_t _edgeLatencyUs = 0U;
+static portMUX_TYPE _edgeMux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE _loadMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool _loadRunning = false;
+
+/* Public functions */
+void vBENCH_Init(void)
+{
+    if (!bSERVO_RegisterOrderHook(_orderHook)) {
+        ESP_LOGE(TAG_BENCH, "Cannot register servo order hook");
+    }
+}
+
+void vBENCH_Process(void* pvParameters)
+{
+    _benchTask = xTaskGetCurrentTaskHandle();
+    _echoQueue = OS_QUEUE_CREATE("Queue bench echo", BENCH_ECHO_QUEUE_LENGTH, sizeof(benchEchoEvent_t));
+    OS_TASK_CREATE(_echoProcess, "Bench echo", BENCH_TASK_STACK_SIZE, BENCH_ECHO_TASK_PRIORITY, BENCH_TASK_CORE);
+
+    ESP_LOGI(TAG_BENCH, "Benchmark started, %u samples per measure", BENCH_SAMPLES);
+    printf("@B {\"name\":\"config\",\"cpu_mhz\":%u,\"tick_hz\":%u,\"single_task_reactor\":%u,\"static_allocation\":%u,\"core_pinning\":%u,\"motion_core\":%u,\"gpio_isr_core\":%u}\n",
+        CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, (uint32_t)configTICK_RATE_HZ, SYSTEM_SINGLE_TASK_REACTOR, SYSTEM_STATIC_ALLOCATION, SYSTEM_CORE_PINNING_ENABLED,
+        SERVO_TASK_CORE, GPIO_ISR_CORE);
+    _benchRoundTrip();
+    _benchQueues();
+    _benchServoOrder();
+    _benchLedUpdate();
+    _benchEdgeToServo();
+    _benchEdgeToIsr();
+    _benchServoTick();
+    ESP_LOGI(TAG_BENCH, "Benchmark done");
+
+    vTaskDelete(NULL);
+}
+
+/* Static functions */
+static void _echoProcess(void* pvParameters)
+{
+    benchEchoEvent_t event;
+
+    for (;;) {
+        if (xQueueReceive(_echoQueue, &event, portMAX_DELAY) == pdTRUE) {
+            vOS_QueueSendSafe(&event.responseQueue, &event.value);
+        }
+    }
+}
+
+static void _benchRoundTrip(void)
+{
+    benchEchoEvent_t event = { 0 };
+    uint32_t response = 0U;
+    uint32_t startCycles = 0U;
+    BaseType_t startCore = 0;
+
+    _beginRun();
+    for (uint32_t sample = 0U; sample < BENCH_SAMPLES; sample++) {
+        event.value = sample;
+        startCore = xPortGetCoreID();
+        startCycles = xthal_get_ccount();
+        if (bOS_SendToTaskAndWaitResponse(_echoQueue, &event, &event.responseQueue, &response, sizeof(response), TASK_DEFAULT_REPONSE_TIME_TICKS) && (response == sample)) {
+            _stopCycles(startCycles, startCore);
+        } else {
+            _droppedCount++;
+        }
+    }
+    _report("round_trip", BENCH_UNIT_CYCLES);
+}
+
+static void _benchQueues(void)
+{
+    uint8_t item[REACTOR_EVENT_BUFFER_SIZE] __attribute__((aligned(8))) = { 0 };
+    char name[BENCH_NAME_LENGTH];
+    const reactorModule_t* pModule = NULL;
+    QueueHandle_t queue = NULL;
+    uint32_t startCycles = 0U;
+    BaseType_t startCore = 0;
+    uint32_t sample = 0U;
+
+    /* Scratch queue with the geometry of each module queue, the real ones are live */
+    for (uint8_t module = 0U; module < (sizeof(_moduleGetters) / sizeof(_moduleGetters[0])); module++) {
+        pModule = _moduleGetters[module]();
+        queue = xQueueCreate(pModule->queueLength, pModule->eventSize);
+        if (queue == NULL) {
+            ESP_LOGE(TAG_BENCH, "Cannot create scratch queue for %s", pModule->name);
+            continue;
+        }
+
+        /* Fill then drain, so that every post and receive sees a realistic depth */
+        _beginRun();
+        for (sample = 0U; sample < BENCH_SAMPLES;) {
+            while ((sample < BENCH_SAMPLES) && (uxQueueSpacesAvailable(queue) > 0U)) {
+                startCore = xPortGetCoreID();
+                startCycles = xthal_get_ccount();
+                if (bOS_QueueSend(queue, item, 0U)) {
+                    _stopCycles(startCycles, startCore);
+                } else {
+                    _droppedCount++;
+                }
+                sample++;
+            }
+            xQueueReset(queue);
+        }
+        snprintf(name, sizeof(name), "queue_post/%s", pModule->name);
+        _report(name, BENCH_UNIT_CYCLES);
+
+        _beginRun();
+        for (sample = 0U; sample < BENCH_SAMPLES;) {
+            while (uxQueueSpacesAvailable(queue) > 0U) {
+                xQueueSend(queue, item, 0U);
+            }
+            while ((sample < BENCH_SAMPLES) && (uxQueueMessagesWaiting(queue) > 0U)) {
+                startCore = xPortGetCoreID();
+                startCycles = xthal_get_ccount();
+                if (xQueueReceive(queue, item, 0U) == pdTRUE) {
+                    _stopCycles(startCycles, startCore);
+                } else {
+                    _droppedCount++;
+                }
+                sample++;
+            }
+        }
+        snprintf(name, sizeof(name), "queue_receive/%s", pModule->name);
+        _report(name, BENCH_UNIT_CYCLES);
+
+        vQueueDelete(queue);
+    }
+}
+
+static void _benchServoOrder(void)
+{
+    uint32_t startCycles = 0U;
+    BaseType_t startCore = 0;
+
+    /* Neutral order, the wheels do not move */
+    _beginRun();
+    for (uint32_t sample = 0U; sample < BENCH_SAMPLES; sample++) {
+        startCore = xPortGetCoreID();
+        startCycles = xthal_get_ccount();
+        if (bSERVO_SetOrder(SERVO_LEFT_GPIO_NUM, 0.0F, true)) {
+            _stopCycles(startCycles, startCore);
+        } else {
+            _droppedCount++;
+        }
+    }
+    _report("servo_order", BENCH_UNIT_CYCLES);
+}
+
+static void _benchLedUpdate(void)
+{
+    uint8_t ledHandle = u8LED_RegisterLed(LED_LEFT_R_GPIO_NUM, LED_LEFT_G_GPIO_NUM, LED_LEFT_B_GPIO_NUM);
+    uint32_t startCycles = 0U;
+    BaseType_t startCore = 0;
+
+    if (ledHandle == LED_NO_HANDLE) {
+        ESP_LOGE(TAG_BENCH, "Cannot register LED");
+    } else {
+        /* LEDs task has the higher priority: the update is applied before the call returns */
+        _beginRun();
+        for (uint32_t sample = 0U; sample < BENCH_SAMPLES; sample++) {
+            startCore = xPortGetCoreID();
+            startCycles = xthal_get_ccount();
+            vLED_SetLedSolid(ledHandle, ((sample % 2U) == 0U) ? BENCH_LED_COLOR : 0U, false, 0U);
+            _stopCycles(startCycles, startCore);
+        }
+        vLED_SetLedOff(ledHandle, false, 0U);
+        _report("led_color_update", BENCH_UNIT_CYCLES);
+    }
+}
+
+static void _benchEdgeToServo(void)
+{
+    static const movementType_e sequence[] = { MOVEMENT_FORWARD };
+    gpio_config_t gpioConfig = { 0 };
+    TickType_t lastWakeTime = 0U;
+    bool timedOut = false;
+
+    /* Generator output is wired to the GO button input */
+    gpioConfig.pin_bit_mask = BIT64(BENCH_EDGE_GPIO_NUM);
+    gpioConfig.mode = GPIO_MODE_OUTPUT;
+    gpio_config(&gpioConfig);
+    gpio_set_level(BENCH_EDGE_GPIO_NUM, !BENCH_EDGE_PRESS_LEVEL);
+
+    _beginRun();
+    lastWakeTime = xTaskGetTickCount();
+    for (uint32_t sample = 0U; sample < BENCH_EDGE_SAMPLES; sample++) {
+        /* Each abort empties the sequence */
+        bSEQMNGR_SetSequence(sequence, sizeof(sequence) / sizeof(sequence[0]));
+
+        portENTER_CRITICAL(&_edgeMux);
+        _edgeStartUs = esp_timer_get_time();
+        _edgePending = true;
+        portEXIT_CRITICAL(&_edgeMux);
+        gpio_set_level(BENCH_EDGE_GPIO_NUM, BENCH_EDGE_PRESS_LEVEL);
+
+        timedOut = (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BENCH_EDGE_TIMEOUT_MS)) == 0U);
+        portENTER_CRITICAL(&_edgeMux);
+        timedOut = timedOut && _edgePending;
+        _edgePending = false;
+        portEXIT_CRITICAL(&_edgeMux);
+        if (timedOut) {
+            _droppedCount++;
+        } else {
+            _addSample(_edgeLatencyUs);
+        }
+
+        vSEQMNGR_AbortSequence();
+        gpio_set_level(BENCH_EDGE_GPIO_NUM, !BENCH_EDGE_PRESS_LEVEL);
+        vTaskDelayUntil(&lastWakeTime, BENCH_EDGE_PERIOD_TICKS);
+    }
+    _report("edge_to_servo_write", BENCH_UNIT_US);
+}
+
+static void _benchEdgeToIsr(void)
+{
+    TickType_t lastWakeTime = 0U;
+    bool timedOut = false;
+
+    /* Sequence is empty after the previous measure, the presses launch nothing */
+    vBUT_SetPressIsrCallback(BENCH_EDGE_TARGET_GPIO_NUM, _edgeIsrCallback);
+    _beginRun();
+    lastWakeTime = xTaskGetTickCount();
+    for (uint32_t sample = 0U; sample < BENCH_EDGE_SAMPLES; sample++) {
+        portENTER_CRITICAL(&_edgeMux);
+        _edgeStartUs = esp_timer_get_time();
+        _edgePending = true;
+        portEXIT_CRITICAL(&_edgeMux);
+        gpio_set_level(BENCH_EDGE_GPIO_NUM, BENCH_EDGE_PRESS_LEVEL);
+
+        timedOut = (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BENCH_EDGE_TIMEOUT_MS)) == 0U);
+        portENTER_CRITICAL(&_edgeMux);
+        timedOut = timedOut && _edgePending;
+        _edgePending = false;
+        portEXIT_CRITICAL(&_edgeMux);
+        if (timedOut) {
+            _droppedCount++;
+        } else {
+            _addSample(_edgeLatencyUs);
+        }
+
+        gpio_set_level(BENCH_EDGE_GPIO_NUM, !BENCH_EDGE_PRESS_LEVEL);
+        vTaskDelayUntil(&lastWakeTime, BENCH_EDGE_PERIOD_TICKS);
+    }
+    vBUT_SetPressIsrCallback(BENCH_EDGE_TARGET_GPIO_NUM, NULL);
+    _report("edge_to_isr", BENCH_UNIT_US);
+}
+
+static void _benchServoTick(void)
+{
+    pwrLock_t pwrLock = { 0 };
+
+    /* Probe in place of the servo task, synthetic load on the service core: placement shows in the lateness */
+    vPWR_CreateLock(&pwrLock, "bench");
+    vPWR_AcquireLock(&pwrLock);
+    _beginRun();
+    _loadRunning = true;
+    OS_TASK_CREATE(_loadProcess, "Bench load", BENCH_PROBE_STACK_SIZE, BENCH_TASK_PRIORITY, SYSTEM_PRO_CORE);
+    OS_TASK_CREATE(_tickProbeProcess, "Bench tick", BENCH_PROBE_STACK_SIZE, SERVO_TASK_PRIORITY, SERVO_TASK_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    _loadRunning = false;
+    vPWR_ReleaseLock(&pwrLock);
+    _report("servo_tick_lateness", BENCH_UNIT_US);
+}
+
+static void _edgeIsrCallback(BaseType_t* pHigherTaskWoken)
+{
+    int64_t nowUs = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&_edgeMux);
+    if (_edgePending) {
+        _edgeLatencyUs = (uint32_t)(nowUs - _edgeStartUs);
+        _edgePending = false;
+        vTaskNotifyGiveFromISR(_benchTask, pHigherTaskWoken);
+    }
+    portEXIT_CRITICAL_ISR(&_edgeMux);
+}
+
+static void _tickProbeProcess(void* pvParameters)
+{
+    TickType_t lastWakeTime = xTaskGetTickCount();
+    int64_t originUs = 0;
+    int64_t lateUs = 0;
+
+    /* First wake up sets the schedule origin, on a tick boundary */
+    vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(BENCH_TICK_PERIOD_MS));
+    originUs = esp_timer_get_time();
+    for (uint32_t sample = 1U; sample <= BENCH_SAMPLES; sample++) {
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(BENCH_TICK_PERIOD_MS));
+        lateUs = esp_timer_get_time() - (originUs + ((int64_t)sample * BENCH_TICK_PERIOD_US));
+        _addSample((lateUs > 0) ? (uint32_t)lateUs : 0U);
+    }
+
+    xTaskNotifyGive(_benchTask);
+    vTaskDelete(NULL);
+}
+
+static void _loadProcess(void* pvParameters)
+{
+    int64_t startUs = 0;
+
+    /* Interrupts off stretches, as a flash write or a long driver critical section would do */
+    while (_loadRunning) {
+        for (uint32_t burst = 0U; burst < BENCH_LOAD_BURSTS; burst++) {
+            portENTER_CRITICAL(&_loadMux);
+            startUs = esp_timer_get_time();
+            while ((esp_timer_get_time() - startUs) < BENCH_LOAD_CRITICAL_US) {
+            }
+            portEXIT_CRITICAL(&_loadMux);
+        }
+        vTaskDelay(1U);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void _orderHook(uint32_t gpio, float speed, bool forward, int64_t timestampUs)
+{
+    bool notify = false;
+
+    /* First moving order after the injected edge, stop orders belong to the abort */
+    portENTER_CRITICAL(&_edgeMux);
+    if (_edgePending && (speed > 0.0F)) {
+        _edgeLatencyUs = (uint32_t)(timestampUs - _edgeStartUs);
+        _edgePending = false;
+        notify = true;
+    }
+    portEXIT_CRITICAL(&_edgeMux);
+
+    if (notify) {
+        xTaskNotifyGive(_benchTask);
+    }
+}
+
+static void _beginRun(void)
+{
+    _sampleCount = 0U;
+    _droppedCount = 0U;
+}
+
+static void _stopCycles(uint32_t startCycles, BaseType_t startCore)
+{
+    uint32_t cycles = xthal_get_ccount() - startCycles;
+
+    /* Cycle counters of the two cores are not synchronized */
+    if (xPortGetCoreID() == startCore) {
+        _addSample(cycles);
+    } else {
+        _droppedCount++;
+    }
+}
+
+static void _addSample(uint32_t value)
+{
+    if (_sampleCount < BENCH_SAMPLES) {
+        _samples[_sampleCount++] = value;
+    }
+}
+
+static void _report(const char* name, benchUnit_e unit)
+{
+    uint64_t total = 0U;
+    uint32_t mean = 0U;
+    uint32_t perSecond = 0U;
+
+    qsort(_samples, _sampleCount, sizeof(_samples[0]), _compareSamples);
+    for (uint32_t sample = 0U; sample < _sampleCount; sample++) {
+        total += _samples[sample];
+    }
+    if (_sampleCount > 0U) {
+        mean = (uint32_t)(total / _sampleCount);
+    }
+    if (mean > 0U) {
+        perSecond = ((unit == BENCH_UNIT_CYCLES) ? (CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * US_PER_SECOND) : US_PER_SECOND) / mean;
+    }
+
+    printf("@B {\"name\":\"%s\",\"unit\":\"%s\",\"count\":%u,\"dropped\":%u,\"min\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u,\"mean\":%u,\"per_second\":%u}\n",
+        name, _unitNames[unit], _sampleCount, _droppedCount, _percentile(0U), _percentile(50U), _percentile(90U), _percentile(99U), _percentile(100U), mean, perSecond);
+}
+
+static uint32_t _percentile(uint32_t percent)
+{
+    uint32_t rank = 0U;
+    uint32_t result = 0U;
+
+    /* Nearest rank on sorted samples */
+    if (_sampleCount > 0U) {
+        rank = (_sampleCount * percent + 99U) / 100U;
+        result = _samples[(rank > 0U) ? (rank - 1U) : 0U];
+    }
+
+    return result;
+}
+
+static int _compareSamples(const void* pA, const void* pB)
+{
+    uint32_t a = *(const uint32_t*)pA;
+    uint32_t b = *(const uint32_t*)pB;
+
+    return (a > b) - (a < b);
+}
+
+#endif
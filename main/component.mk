@@ -5,12 +5,14 @@
 
 COMPONENT_ADD_INCLUDEDIRS := . \
 applications/inc \
+benchmark/inc \
 drivers/inc \
 hil/inc \
 utils/inc \
 
 COMPONENT_SRCDIRS := . \
 applications/src \
+benchmark/src \
 drivers/src \
 hil/src \
 utils/src \
@@ -9,6 +9,8 @@
 #ifndef __BUTTONS_H__
 #define __BUTTONS_H__
 
+#include "msgBus.h"
+#include "reactor.h"
 #include "system_def.h"
 
 #define BUTTON_TRIGGER_NONE (0)
@@ -17,14 +19,53 @@
 #define BUTTON_TRIGGER_SHORT_PRESS (BIT(2))
 #define BUTTON_TRIGGER_LONG_PRESS (BIT(3))
 #define BUTTON_TRIGGER_VERY_LONG_PRESS (BIT(4))
+#define BUTTON_TRIGGER_DOUBLE_CLICK (BIT(5)) /* With the second press, when the first one was a click */
+#define BUTTON_TRIGGER_HOLD_REPEAT (BIT(6)) /* While held, see BUTTON_HOLD_REPEAT_DELAY_MS and BUTTON_HOLD_REPEAT_PERIOD_MS */
+#define BUTTON_TRIGGER_CHORD (BIT(7)) /* Published as the chord pseudo GPIO, see bBUT_RegisterChord() */
 
+/* Chords are published as pseudo GPIOs, above the matrix keys */
+#define BUTTON_CHORD_MAX_NUMBER (4U)
+#define BUTTON_CHORD_MAX_KEYS (4U)
+#define BUTTON_CHORD_BASE (128U)
+#define BUTTON_CHORD(index) (BUTTON_CHORD_BASE + (index))
+
+/* Matrix keypad keys are registered and published as pseudo GPIOs, above any real one */
+#define BUTTON_MATRIX_MAX_ROWS (4U)
+#define BUTTON_MATRIX_MAX_COLUMNS (4U)
+#define BUTTON_MATRIX_KEY_BASE (64U)
+#define BUTTON_MATRIX_KEY(row, column) (BUTTON_MATRIX_KEY_BASE + ((row) * BUTTON_MATRIX_MAX_COLUMNS) + (column))
+
+/* Rows are open drain outputs, columns inputs with pull-up (GPIO 34 to 39 have none): a pressed key links its row and column */
+typedef struct {
+    uint8_t rowGpios[BUTTON_MATRIX_MAX_ROWS];
+    uint8_t columnGpios[BUTTON_MATRIX_MAX_COLUMNS];
+    uint8_t rowNumber;
+    uint8_t columnNumber;
+} buttonMatrixConfig_t;
+
+/* Published on BUS_TOPIC_BUTTON */
 typedef struct {
     uint32_t gpio;
     uint32_t triggerBitmap;
 } buttonEvent_t;
 
+typedef void (*buttonIsrCallback_t)(BaseType_t* pHigherTaskWoken);
+
 void vBUT_Process(void* pvParameters);
 
-bool bBUT_RegisterButton(uint32_t gpio, uint32_t triggerBitmap, QueueHandle_t eventQueue);
+const reactorModule_t* pBUT_GetReactorModule(void);
+
+bool bBUT_RegisterButton(uint32_t gpio, uint32_t triggerBitmap);
+
+/* Once, before its keys are registered with bBUT_RegisterButton(BUTTON_MATRIX_KEY(row, column), ...) */
+bool bBUT_ConfigureMatrix(const buttonMatrixConfig_t* pMatrixConfig);
+
+/* Keys registered first. Pressed within BUTTON_CHORD_WINDOW_MS, they publish one BUTTON_TRIGGER_CHORD event and nothing
+ * else until released. Their own presses are held back for the window: pick keys whose press is not latency sensitive.
+ * Keys with a press ISR callback are refused, it would run on every press of the chord */
+bool bBUT_RegisterChord(uint32_t chord, const uint32_t* pGpios, uint8_t gpioNumber);
+
+/* Refused for chord keys */
+void vBUT_SetPressIsrCallback(uint32_t gpio, buttonIsrCallback_t callback);
 
 #endif //__BUTTONS_H__
\ No newline at end of file
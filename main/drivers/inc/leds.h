@@ -11,6 +11,7 @@
 
 /* ____________________________________________________________________________ */
 /* Includes 																	*/
+#include "reactor.h"
 #include "system_def.h"
 
 /* ____________________________________________________________________________ */
@@ -28,6 +29,8 @@
 /* Public function prototypes 													*/
 void vLED_Process(void* pvParameters);
 
+const reactorModule_t* pLED_GetReactorModule(void);
+
 uint8_t u8LED_RegisterLed(uint32_t rGpio, uint32_t gGpio, uint32_t bGpio);
 
 void vLED_SetLedSolid(uint8_t ledHandle, uint32_t color, bool fade, uint32_t delayToFadeMs);
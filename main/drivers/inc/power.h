@@ -0,0 +1,70 @@
+/**
+*******************************************************************************
+* @file 	power.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __POWER_H__
+#define __POWER_H__
+
+/* ____________________________________________________________________________ */
+/* Includes 																	*/
+#include "system_def.h"
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+#include "esp_pm.h"
+#endif
+
+/* ____________________________________________________________________________ */
+/* Defines 																		*/
+
+/* ____________________________________________________________________________ */
+/* Enum 																		*/
+typedef enum {
+    PWR_CHARGE_STATE_DISCHARGING = 0, /* On battery, or charger plugged with a full battery */
+    PWR_CHARGE_STATE_CHARGING,
+    /* Do not erase */
+    PWR_CHARGE_STATE_NUMBER
+} pwrChargeState_e;
+
+/* ____________________________________________________________________________ */
+/* Struct																	 	*/
+/* Published on BUS_TOPIC_CHARGE on each change */
+typedef struct {
+    pwrChargeState_e state;
+    int64_t sinceUs; /* esp_timer time of the last change */
+    uint32_t previousStateDurationS;
+    uint32_t chargeCount; /* Charges started since boot */
+} pwrChargeReport_t;
+
+/* Full CPU frequency and no light sleep while held */
+typedef struct {
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+    esp_pm_lock_handle_t cpuLock;
+    esp_pm_lock_handle_t sleepLock;
+#endif
+    bool held;
+} pwrLock_t;
+
+/* ____________________________________________________________________________ */
+/* Public function prototypes 													*/
+void vPWR_Init(void);
+
+void vPWR_CreateLock(pwrLock_t* pLock, const char* name);
+
+/* Acquire and release are idempotent, a lock is owned by a single task */
+void vPWR_AcquireLock(pwrLock_t* pLock);
+
+void vPWR_ReleaseLock(pwrLock_t* pLock);
+
+/* Edge interrupts are lost in light sleep: the pin is switched to a level interrupt on the level it does not have,
+ * call again from its ISR to re-arm on the opposite level. No effect without power management. */
+void vPWR_ArmGpioWakeup(uint32_t gpio);
+
+/* RX edges counted for the wakeup are lost. No effect without power management. */
+void vPWR_ArmUartWakeup(uint32_t uartNum, uint32_t edgeThreshold);
+
+void vPWR_GetChargeReport(pwrChargeReport_t* pReport);
+
+#endif //__POWER_H__
@@ -11,23 +11,69 @@
 
 /* ____________________________________________________________________________ */
 /* Includes 																	*/
+#include "reactor.h"
 #include "system_def.h"
 
 /* ____________________________________________________________________________ */
 /* Defines 																		*/
+#define SERVO_MAX_ORDER_HOOKS (2U)
+#define SERVO_EMERGENCY_STOP_BUDGET_US (50U)
+#define SERVO_CAL_STEP_PERCENT (10U)
+#define SERVO_CAL_POINTS ((200U / SERVO_CAL_STEP_PERCENT) + 1U)
+#define SERVO_CAL_NEUTRAL_INDEX (SERVO_CAL_POINTS / 2U)
 
 /* ____________________________________________________________________________ */
 /* Enum 																		*/
 
 /* ____________________________________________________________________________ */
 /* Struct																	 	*/
+typedef void (*servoOrderHook_t)(uint32_t gpio, float speed, bool forward, int64_t timestampUs);
+typedef void (*servoStopCallback_t)(BaseType_t* pHigherTaskWoken); /* pHigherTaskWoken is NULL outside ISR */
+
+/* Pulse widths of signed speeds, from -100% (full backward) to +100% every SERVO_CAL_STEP_PERCENT, non decreasing */
+typedef struct {
+    uint16_t pulseUs[SERVO_CAL_POINTS];
+} servoCalibration_t;
+
+typedef struct {
+    uint32_t stopCount;
+    uint32_t lastLatencyUs;
+    uint32_t worstLatencyUs;
+    uint32_t overrunCount;
+} servoStopStats_t;
 
 /* ____________________________________________________________________________ */
 /* Public function prototypes 													*/
 void vSERVO_Process(void* pvParameters);
 
+const reactorModule_t* pSERVO_GetReactorModule(void);
+
+/* Servos of the same period share an MCPWM timer, up to 12 servos and 6 different periods */
 bool bSERVO_RegisterServo(uint32_t gpio, float minPulseMs, float maxPulseMs);
 
+/* Parks the output and frees its generator, and its timer once no servo uses it */
+bool bSERVO_UnregisterServo(uint32_t gpio);
+
 bool bSERVO_SetOrder(uint32_t gpio, float speed, bool forward);
 
+bool bSERVO_RegisterOrderHook(servoOrderHook_t hook);
+
+void vSERVO_RegisterEmergencyStopCallback(servoStopCallback_t callback);
+
+void vSERVO_EmergencyStop(void);
+
+void vSERVO_EmergencyStopFromISR(BaseType_t* pHigherTaskWoken);
+
+void vSERVO_ReleaseEmergencyStop(void);
+
+void vSERVO_GetEmergencyStopStats(servoStopStats_t* pStats);
+
+/* Raw pulse, for calibration: no table, no order hook. 0 parks the output */
+bool bSERVO_SetPulse(uint32_t gpio, uint32_t pulseUs);
+
+/* Stored in NVS, only while every output is parked: the flash write stalls the servo task */
+bool bSERVO_SetCalibration(uint32_t gpio, const servoCalibration_t* pCalibration);
+
+bool bSERVO_GetCalibration(uint32_t gpio, servoCalibration_t* pCalibration);
+
 #endif //__SERVO_H__
\ No newline at end of file
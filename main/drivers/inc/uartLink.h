@@ -0,0 +1,70 @@
+/**
+*******************************************************************************
+* @file 	uartLink.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __UARTLINK_H__
+#define __UARTLINK_H__
+
+/* ____________________________________________________________________________ */
+/* Includes 																	*/
+#include "system_def.h"
+
+/* ____________________________________________________________________________ */
+/* Defines 																		*/
+/* Frame: start | payload length | type | sequence | payload | CRC16 (LSB first)
+ * CRC16 CCITT (0x1021, init 0xFFFF) covers length, type, sequence and payload */
+#define LINK_FRAME_START (0xA5U)
+#define LINK_FRAME_HEADER_SIZE (4U)
+#define LINK_FRAME_CRC_SIZE (2U)
+#define LINK_MAX_PAYLOAD_SIZE (64U)
+#define LINK_MAX_FRAME_SIZE (LINK_FRAME_HEADER_SIZE + LINK_MAX_PAYLOAD_SIZE + LINK_FRAME_CRC_SIZE)
+
+/* ____________________________________________________________________________ */
+/* Enum 																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																	 	*/
+/* Payload left in place in the receive ring, in two parts when it wraps around the end */
+typedef struct {
+    const uint8_t* pFirst;
+    const uint8_t* pSecond;
+    uint8_t firstLength;
+    uint8_t length;
+} linkView_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t sequence;
+    linkView_t payload;
+} linkFrame_t;
+
+typedef struct {
+    uint32_t rxFrames;
+    uint32_t txFrames;
+    uint32_t crcErrors;
+    uint32_t skippedBytes; /* Outside of any valid frame */
+    uint32_t rxOverflows; /* Driver buffer full, bytes lost */
+    uint32_t txDropped; /* Previous frames still in flight at the end of the send timeout */
+} linkStats_t;
+
+/* ____________________________________________________________________________ */
+/* Public function prototypes 													*/
+void vLINK_Init(void);
+
+/* Single reader: the frame payload stays valid until the next call */
+bool bLINK_Receive(linkFrame_t* pFrame, TickType_t timeout);
+
+/* Waits up to timeout for the previous frames to leave the UART, the frame is dropped otherwise */
+bool bLINK_Send(uint8_t type, uint8_t sequence, const uint8_t* pPayload, uint8_t length, TickType_t timeout);
+
+uint8_t u8LINK_GetByte(const linkView_t* pView, uint8_t offset);
+
+uint16_t u16LINK_GetUint16(const linkView_t* pView, uint8_t offset);
+
+void vLINK_GetStats(linkStats_t* pStats);
+
+#endif //__UARTLINK_H__
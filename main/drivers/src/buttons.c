@@ -7,15 +7,32 @@
 */
 
 #include "buttons.h"
+#include "deadlineMonitor.h"
 #include "driver/gpio.h"
+#include "esp32/rom/ets_sys.h"
+#include "inputLog.h"
+#include "power.h"
+#include "reactor.h"
+#include "stateMachine.h"
+#include "trace.h"
 
 /* Define */
 #define TAG_BUTTON ("BUT")
 #define BUTTON_PRESSED_SHORT_DURATION_TICKS (pdMS_TO_TICKS(50U))
 #define BUTTON_PRESSED_LONG_DURATION_TICKS (pdMS_TO_TICKS(3000U))
 #define BUTTON_PRESSED_VERY_LONG_DURATION_TICKS (pdMS_TO_TICKS(10000U))
-#define MAX_BUTTON_NUMBER (10U)
-#define CHECK_BUTTONS_DELAY_TICKS (pdMS_TO_TICKS(100U))
+#define MAX_BUTTON_NUMBER (10U + (BUTTON_MATRIX_MAX_ROWS * BUTTON_MATRIX_MAX_COLUMNS))
+#define BUTTON_HOLD_TRIGGERS (BUTTON_TRIGGER_SHORT_PRESS | BUTTON_TRIGGER_LONG_PRESS | BUTTON_TRIGGER_VERY_LONG_PRESS)
+#define BUTTON_CLICK_MAX_TICKS (pdMS_TO_TICKS(BUTTON_CLICK_MAX_MS))
+#define BUTTON_DOUBLE_CLICK_WINDOW_TICKS (pdMS_TO_TICKS(BUTTON_DOUBLE_CLICK_WINDOW_MS))
+#define BUTTON_HOLD_REPEAT_DELAY_TICKS (pdMS_TO_TICKS(BUTTON_HOLD_REPEAT_DELAY_MS))
+#define BUTTON_HOLD_REPEAT_PERIOD_TICKS (pdMS_TO_TICKS(BUTTON_HOLD_REPEAT_PERIOD_MS))
+#define BUTTON_CHORD_WINDOW_TICKS (pdMS_TO_TICKS(BUTTON_CHORD_WINDOW_MS))
+#define BUTTON_KEY_MAX (BUTTON_MATRIX_KEY(BUTTON_MATRIX_MAX_ROWS - 1U, BUTTON_MATRIX_MAX_COLUMNS - 1U) + 1U)
+#define BUTTON_MATRIX_SCAN_PERIOD_TICKS (pdMS_TO_TICKS(10U))
+#define BUTTON_MATRIX_DEBOUNCE_SCANS (3U) /* Samples differing from the key state before it changes, below the short press */
+#define BUTTON_MATRIX_SETTLE_US (5U) /* Column lines charge through the pull-ups once a row is released */
+#define TICK_IS_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
 
 /* Enum */
 
@@ -26,19 +43,35 @@ typedef enum {
     BUTTON_ACTION_NUMBER
 } buttonAction_e;
 
+/* One gesture machine per button, fed with its edges */
 typedef enum {
-    BUTTON_STATE_RELEASED = 0,
-    BUTTON_STATE_PRESSED_SHORT,
-    BUTTON_STATE_PRESSED_LONG,
-    BUTTON_STATE_PRESSED_VERY_LONG,
+    GESTURE_STATE_RELEASED = 0,
+    GESTURE_STATE_CHORD_WAIT, /* Chord key pressed, its press held back until the chord completes or the window ends */
+    GESTURE_STATE_PRESSED, /* Press published, timeout at the next hold threshold or repeat */
+    GESTURE_STATE_CLICKED, /* Released after a click, timeout at the end of the double click window */
+    GESTURE_STATE_CHORDED, /* Part of a published chord, silent until released */
     /* Do not erase */
-    BUTTON_STATE_NUMBER
-} buttonState_e;
+    GESTURE_STATE_NUMBER
+} gestureState_e;
+
+/* Edges are classified before dispatch: the target state follows from the event alone */
+typedef enum {
+    GESTURE_EVENT_PRESS = 0,
+    GESTURE_EVENT_CHORD_KEY_PRESS, /* Press of a key belonging to a chord */
+    GESTURE_EVENT_RELEASE,
+    GESTURE_EVENT_CLICK_RELEASE, /* Release ending a click that may start a double click */
+    GESTURE_EVENT_CHORD, /* All keys of a chord pressed within the window */
+    GESTURE_EVENT_TIMEOUT, /* Never queued */
+    /* Do not erase */
+    GESTURE_EVENT_NUMBER
+} gestureEvent_e;
 
 typedef enum {
     BUTTON_EVENT_ISR = 0,
     BUTTON_EVENT_CONFIG,
-    BUTTON_EVENT_CHECK
+    BUTTON_EVENT_CHORD_CONFIG,
+    BUTTON_EVENT_MATRIX_CONFIG,
+    BUTTON_EVENT_MATRIX_WAKE
 } buttonEvent_e;
 
 /* Struct */
@@ -51,180 +84,478 @@ typedef struct {
 typedef struct {
     uint32_t gpio;
     uint32_t triggerRegister;
-    QueueHandle_t eventQueue;
     queueContext_t responseQueue;
 } buttonConfig_t;
 
 typedef struct {
     buttonConfig_t config;
-    buttonAction_e lastAction;
-    buttonState_e currentState;
-    TickType_t lastActionTimestamp;
-    uint32_t eventsTriggered;
+    stateMachine_t gesture;
+    bool isChordKey;
+    TickType_t pressTimestamp;
+    TickType_t nextRepeatTimestamp;
+    uint32_t eventsTriggered; /* Published since the press, DOUBLE_CLICK marks a second click */
 } buttonContext_t;
 
+typedef struct {
+    uint32_t chord;
+    uint32_t gpios[BUTTON_CHORD_MAX_KEYS];
+    uint8_t gpioNumber;
+    queueContext_t responseQueue;
+} buttonChordConfig_t;
+
+typedef struct {
+    uint32_t chord;
+    uint8_t keyIndexes[BUTTON_CHORD_MAX_KEYS]; /* In the buttons list */
+    uint8_t keyNumber;
+} buttonChord_t;
+
+typedef struct {
+    buttonMatrixConfig_t config;
+    queueContext_t responseQueue;
+} buttonMatrixEvent_t;
+
 typedef struct {
     buttonEvent_e type;
     union {
         buttonIsrEvent_t isr;
         buttonConfig_t config;
+        buttonChordConfig_t chord;
+        buttonMatrixEvent_t matrix;
     };
 } buttonQueueEvent_t;
 
+typedef struct {
+    buttonMatrixConfig_t config;
+    bool configured;
+    bool scanning; /* Column interrupts disabled meanwhile */
+    TickType_t nextScanTicks;
+    uint8_t keysDown[BUTTON_MATRIX_MAX_ROWS]; /* Debounced, one bit per column */
+    uint8_t debounceCount[BUTTON_MATRIX_MAX_ROWS][BUTTON_MATRIX_MAX_COLUMNS];
+} buttonMatrix_t;
+
 /* Static prototypes */
 static void _buttonsISR(void* gpioNum);
+static void _matrixISR(void* pArg);
+static void _handleEdge(uint32_t gpio, uint32_t level, BaseType_t* pHigherTaskWoken);
+static void _raiseEdge(uint32_t gpio, uint32_t level);
+static void _installIsrService(void* pResult);
+static bool _installIsrServiceOnce(void);
+static bool _isKnownInput(uint32_t gpio);
+static bool _configureChord(const buttonChordConfig_t* pConfig);
+static bool _configureMatrix(const buttonMatrixConfig_t* pConfig);
+static bool _scanMatrix(void);
+static void _stopMatrixScan(void);
+static void _init(void);
+static TickType_t _handleEvent(void* pEvent);
 static bool _getButtonFromGpio(uint32_t gpio, buttonContext_t** pButton);
-static bool _notifyToUpperLayer(uint32_t triggerBitmap, buttonConfig_t* pButtonConfig);
+static bool _dispatchEdge(buttonContext_t* pButton, buttonAction_e action);
+static void _dispatchGesture(buttonContext_t* pButton, uint8_t event);
+static void _completeChords(void);
+static bool _publish(uint32_t triggerBitmap);
+static uint32_t _getHoldTrigger(TickType_t heldTicks);
+static void _armHoldTimeout(void);
+static void _enterPressed(void);
+static bool _press(void* pEvent);
+static bool _holdBackPress(void* pEvent);
+static bool _publishPress(void* pEvent);
+static bool _tap(void* pEvent);
+static bool _release(void* pEvent);
+static bool _doubleClick(void* pEvent);
+static bool _holdTimeout(void* pEvent);
+static bool _notifyToUpperLayer(uint32_t triggerBitmap, uint32_t gpio);
 
 /* Static variables */
 static QueueHandle_t _queueForButtons = NULL;
 static buttonContext_t _buttonsList[MAX_BUTTON_NUMBER] = { 0 };
 static uint8_t _buttonNumber = 0;
+static volatile buttonIsrCallback_t _pressIsrCallbacks[GPIO_NUM_MAX] = { NULL };
+static volatile uint64_t _chordKeyMask = 0U; /* GPIO chord keys, their presses cannot have an ISR callback */
+static bool _isrServiceInstalled = false;
+static portMUX_TYPE _raiseMux = portMUX_INITIALIZER_UNLOCKED;
+static buttonMatrix_t _matrix = { 0 };
+static buttonChord_t _chords[BUTTON_CHORD_MAX_NUMBER] = { 0 };
+static uint8_t _chordNumber = 0U;
+/* Button of the gesture machine being run, its actions have no other context */
+static buttonContext_t* _pGestureButton = NULL;
+static bool _gesturePublished = false;
+static const smState_t _gestureStates[GESTURE_STATE_NUMBER] = {
+    [GESTURE_STATE_RELEASED] = { .name = "Released", .timeoutTicks = portMAX_DELAY, .timeoutEvent = SM_NO_EVENT },
+    [GESTURE_STATE_CHORD_WAIT] = { .name = "Chord wait", .timeoutTicks = BUTTON_CHORD_WINDOW_TICKS, .timeoutEvent = GESTURE_EVENT_TIMEOUT },
+    /* Timeout armed by the entry, from the thresholds still ahead */
+    [GESTURE_STATE_PRESSED] = { .name = "Pressed", .entry = _enterPressed, .timeoutTicks = portMAX_DELAY, .timeoutEvent = GESTURE_EVENT_TIMEOUT },
+    [GESTURE_STATE_CLICKED] = { .name = "Clicked", .timeoutTicks = BUTTON_DOUBLE_CLICK_WINDOW_TICKS, .timeoutEvent = GESTURE_EVENT_TIMEOUT },
+    [GESTURE_STATE_CHORDED] = { .name = "Chorded", .timeoutTicks = portMAX_DELAY, .timeoutEvent = SM_NO_EVENT },
+};
+/* Repeated edges (press while pressed, release while released) fall in empty cells and are ignored */
+static const smTransition_t _gestureTransitions[GESTURE_STATE_NUMBER][GESTURE_EVENT_NUMBER] = {
+    [GESTURE_STATE_RELEASED] = {
+        [GESTURE_EVENT_PRESS] = SM_TO(GESTURE_STATE_PRESSED, _press),
+        [GESTURE_EVENT_CHORD_KEY_PRESS] = SM_TO(GESTURE_STATE_CHORD_WAIT, _holdBackPress),
+    },
+    /* Released within the window: the press and the release are published together */
+    [GESTURE_STATE_CHORD_WAIT] = {
+        [GESTURE_EVENT_RELEASE] = SM_TO(GESTURE_STATE_RELEASED, _tap),
+        [GESTURE_EVENT_CLICK_RELEASE] = SM_TO(GESTURE_STATE_CLICKED, _tap),
+        [GESTURE_EVENT_CHORD] = SM_TO(GESTURE_STATE_CHORDED, NULL),
+        [GESTURE_EVENT_TIMEOUT] = SM_TO(GESTURE_STATE_PRESSED, _publishPress),
+    },
+    [GESTURE_STATE_PRESSED] = {
+        [GESTURE_EVENT_RELEASE] = SM_TO(GESTURE_STATE_RELEASED, _release),
+        [GESTURE_EVENT_CLICK_RELEASE] = SM_TO(GESTURE_STATE_CLICKED, _release),
+        [GESTURE_EVENT_TIMEOUT] = SM_INTERNAL(_holdTimeout),
+    },
+    /* A press within the window is the second click, chord keys included */
+    [GESTURE_STATE_CLICKED] = {
+        [GESTURE_EVENT_PRESS] = SM_TO(GESTURE_STATE_PRESSED, _doubleClick),
+        [GESTURE_EVENT_CHORD_KEY_PRESS] = SM_TO(GESTURE_STATE_PRESSED, _doubleClick),
+        [GESTURE_EVENT_TIMEOUT] = SM_TO(GESTURE_STATE_RELEASED, NULL),
+    },
+    [GESTURE_STATE_CHORDED] = {
+        [GESTURE_EVENT_RELEASE] = SM_TO(GESTURE_STATE_RELEASED, NULL),
+        [GESTURE_EVENT_CLICK_RELEASE] = SM_TO(GESTURE_STATE_RELEASED, NULL),
+    },
+};
+static const smDefinition_t _gestureDefinition = {
+    .name = "Button gesture",
+    .traceId = BOOT_MODULE_BUTTONS,
+    .pStates = _gestureStates,
+    .stateNumber = GESTURE_STATE_NUMBER,
+    .pTransitions = &_gestureTransitions[0][0],
+    .eventNumber = GESTURE_EVENT_NUMBER,
+    .initialState = GESTURE_STATE_RELEASED,
+};
+static const reactorModule_t _reactorModule = {
+    .name = "Driver buttons",
+    .bootModule = BOOT_MODULE_BUTTONS,
+    .pQueue = &_queueForButtons,
+    .queueLength = BUTTONS_QUEUE_LENGTH,
+    .eventSize = sizeof(buttonQueueEvent_t),
+    .init = _init,
+    .handleEvent = _handleEvent,
+};
 
 /* ISR handlers */
 static void _buttonsISR(void* gpioNum)
 {
     BaseType_t higherTaskWoken = pdFALSE;
+
+    vPWR_ArmGpioWakeup((uint32_t)(uintptr_t)gpioNum);
+    /* A replay owns the inputs: live edges would be mixed with the recorded ones */
+    if (!ILOG_IS_REPLAYING()) {
+        _handleEdge((uint32_t)(uintptr_t)gpioNum, gpio_get_level((uint32_t)(uintptr_t)gpioNum), &higherTaskWoken);
+    }
+
+    if (higherTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void _matrixISR(void* pArg)
+{
+    BaseType_t higherTaskWoken = pdFALSE;
+    buttonQueueEvent_t event;
+
+    /* First press only: the task scans until all keys are released, then enables the interrupts again */
+    for (uint8_t column = 0U; column < _matrix.config.columnNumber; column++) {
+        gpio_intr_disable(_matrix.config.columnGpios[column]);
+        vPWR_ArmGpioWakeup(_matrix.config.columnGpios[column]);
+    }
+    event.type = BUTTON_EVENT_MATRIX_WAKE;
+    if (_queueForButtons != NULL) {
+        TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_BUTTONS, event.type);
+        bOS_QueueSendFromISR(_queueForButtons, &event, &higherTaskWoken);
+    }
+
+    if (higherTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/* Public functions */
+void vBUT_Process(void* pvParameters)
+{
+    vREACTOR_RunModule(&_reactorModule);
+}
+
+const reactorModule_t* pBUT_GetReactorModule(void)
+{
+    return &_reactorModule;
+}
+
+bool bBUT_RegisterButton(uint32_t gpio, uint32_t triggerBitmap)
+{
+    buttonQueueEvent_t newButton;
+    bool result = false;
+
+    newButton.type = BUTTON_EVENT_CONFIG;
+    newButton.config.gpio = gpio;
+    newButton.config.triggerRegister = triggerBitmap;
+    if (!bOS_SendToTaskAndWaitResponse(_queueForButtons, &newButton, &newButton.config.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_BUTTON, "Cannot get response from task");
+    }
+    return result;
+}
+
+bool bBUT_ConfigureMatrix(const buttonMatrixConfig_t* pMatrixConfig)
+{
+    buttonQueueEvent_t matrixEvent;
+    bool result = false;
+
+    matrixEvent.type = BUTTON_EVENT_MATRIX_CONFIG;
+    memcpy(&matrixEvent.matrix.config, pMatrixConfig, sizeof(matrixEvent.matrix.config));
+    if (!bOS_SendToTaskAndWaitResponse(_queueForButtons, &matrixEvent, &matrixEvent.matrix.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_BUTTON, "Cannot get response from task");
+    }
+    return result;
+}
+
+bool bBUT_RegisterChord(uint32_t chord, const uint32_t* pGpios, uint8_t gpioNumber)
+{
+    buttonQueueEvent_t chordEvent;
+    bool result = false;
+
+    if (gpioNumber <= BUTTON_CHORD_MAX_KEYS) {
+        chordEvent.type = BUTTON_EVENT_CHORD_CONFIG;
+        chordEvent.chord.chord = chord;
+        memcpy(chordEvent.chord.gpios, pGpios, gpioNumber * sizeof(pGpios[0]));
+        chordEvent.chord.gpioNumber = gpioNumber;
+        if (!bOS_SendToTaskAndWaitResponse(_queueForButtons, &chordEvent, &chordEvent.chord.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+            ESP_LOGE(TAG_BUTTON, "Cannot get response from task");
+        }
+    }
+    return result;
+}
+
+void vBUT_SetPressIsrCallback(uint32_t gpio, buttonIsrCallback_t callback)
+{
+    if ((gpio < GPIO_NUM_MAX) && ((callback == NULL) || !(_chordKeyMask & BIT64(gpio)))) {
+        _pressIsrCallbacks[gpio] = callback;
+    } else if (gpio < GPIO_NUM_MAX) {
+        ESP_LOGE(TAG_BUTTON, "GPIO %u is a chord key, its press cannot have an ISR callback", gpio);
+    }
+}
+
+static void _installIsrService(void* pResult)
+{
+    *(esp_err_t*)pResult = gpio_install_isr_service(0);
+}
+
+/* From the interrupt or, on replay, from a critical section */
+static void _handleEdge(uint32_t gpio, uint32_t level, BaseType_t* pHigherTaskWoken)
+{
     buttonQueueEvent_t event;
 
+    DLN_STAMP_FROM_ISR(DLN_STAGE_ISR_EDGE);
+    ILOG_EDGE(gpio, level);
     event.type = BUTTON_EVENT_ISR;
-    event.isr.gpio = (uint32_t)gpioNum;
-    if (gpio_get_level((uint32_t)gpioNum) == 0) {
+    event.isr.gpio = gpio;
+    TRACE_EVENT(TRACE_ID_BUTTON_ISR, gpio, level);
+    if (level == 0) {
         event.isr.action = BUTTON_ACTION_RELEASE;
     } else {
         event.isr.action = BUTTON_ACTION_PRESS;
+        /* Time critical reaction, called before the event reaches the task */
+        if ((gpio < GPIO_NUM_MAX) && (_pressIsrCallbacks[gpio] != NULL)) {
+            _pressIsrCallbacks[gpio](pHigherTaskWoken);
+        }
     }
 
     if (_queueForButtons != NULL) {
-        xQueueSendFromISR(_queueForButtons, &event, &higherTaskWoken);
+        TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_BUTTONS, event.type);
+        bOS_QueueSendFromISR(_queueForButtons, &event, pHigherTaskWoken);
+    }
+}
+
+/* Edges found by a task (matrix scan, replay), interrupts masked as the GPIO interrupt would have them */
+static void _raiseEdge(uint32_t gpio, uint32_t level)
+{
+    BaseType_t higherTaskWoken = pdFALSE;
+
+    if (gpio < BUTTON_KEY_MAX) {
+        portENTER_CRITICAL(&_raiseMux);
+        _handleEdge(gpio, level, &higherTaskWoken);
+        portEXIT_CRITICAL(&_raiseMux);
     }
 
     if (higherTaskWoken == pdTRUE) {
-        portYIELD_FROM_ISR();
+        taskYIELD();
     }
 }
 
-/* Public functions */
-void vBUT_Process(void* pvParameters)
+static bool _installIsrServiceOnce(void)
+{
+    esp_err_t isrServiceResult = ESP_OK;
+
+    if (!_isrServiceInstalled) {
+        /* Power driver installs it first for the charge status pin */
+        if (!bOS_RunOnCore(GPIO_ISR_CORE, _installIsrService, &isrServiceResult)) {
+            isrServiceResult = ESP_FAIL;
+        }
+        _isrServiceInstalled = ((isrServiceResult == ESP_OK) || (isrServiceResult == ESP_ERR_INVALID_STATE));
+    }
+
+    return _isrServiceInstalled;
+}
+
+static bool _isKnownInput(uint32_t gpio)
+{
+    uint32_t key = gpio - BUTTON_MATRIX_KEY_BASE;
+
+    return (gpio < GPIO_NUM_MAX)
+        || (_matrix.configured && (gpio >= BUTTON_MATRIX_KEY_BASE) && (gpio < BUTTON_KEY_MAX)
+            && ((key / BUTTON_MATRIX_MAX_COLUMNS) < _matrix.config.rowNumber) && ((key % BUTTON_MATRIX_MAX_COLUMNS) < _matrix.config.columnNumber));
+}
+
+static bool _configureChord(const buttonChordConfig_t* pConfig)
+{
+    buttonChord_t* pChord = &_chords[_chordNumber];
+    buttonContext_t* pButton = NULL;
+    bool result = (_chordNumber < BUTTON_CHORD_MAX_NUMBER) && (pConfig->chord >= BUTTON_CHORD_BASE)
+        && (pConfig->chord < BUTTON_CHORD(BUTTON_CHORD_MAX_NUMBER)) && (pConfig->gpioNumber > 1U);
+
+    /* Keys must be registered buttons. A press ISR callback would act on every press of a key meant to be chorded */
+    for (uint8_t key = 0U; result && (key < pConfig->gpioNumber); key++) {
+        result = _getButtonFromGpio(pConfig->gpios[key], &pButton)
+            && ((pConfig->gpios[key] >= GPIO_NUM_MAX) || (_pressIsrCallbacks[pConfig->gpios[key]] == NULL));
+        if (result) {
+            pChord->keyIndexes[key] = (uint8_t)(pButton - _buttonsList);
+        }
+    }
+    if (result) {
+        pChord->chord = pConfig->chord;
+        pChord->keyNumber = pConfig->gpioNumber;
+        for (uint8_t key = 0U; key < pChord->keyNumber; key++) {
+            _buttonsList[pChord->keyIndexes[key]].isChordKey = true;
+            if (pConfig->gpios[key] < GPIO_NUM_MAX) {
+                _chordKeyMask |= BIT64(pConfig->gpios[key]);
+            }
+        }
+        _chordNumber++;
+    }
+
+    return result;
+}
+
+static bool _configureMatrix(const buttonMatrixConfig_t* pConfig)
 {
-    buttonQueueEvent_t buttonEvent = { 0 };
-    buttonContext_t* pCurrentButton = NULL;
     gpio_config_t gpioConfig = { 0 };
-    TickType_t taskBlockTime = portMAX_DELAY;
-    uint8_t buttonCounter = 0;
-    uint32_t currentEventsTriggered = BUTTON_TRIGGER_NONE;
-    bool result = false;
-    static bool _isrServiceInstalled = false;
-
-    _queueForButtons = xQueueCreate(10, sizeof(buttonEvent));
-
-    for (;;) {
-        if (xQueueReceive(_queueForButtons, &buttonEvent, taskBlockTime) == pdTRUE) {
-            switch (buttonEvent.type) {
-            case BUTTON_EVENT_CONFIG:
-                if (_buttonNumber < MAX_BUTTON_NUMBER) {
-                    /* add button in list */
-                    memcpy(&_buttonsList[_buttonNumber].config, &buttonEvent.config, sizeof(buttonEvent.config));
-                    _buttonsList[_buttonNumber].currentState = BUTTON_STATE_RELEASED;
-                    _buttonsList[_buttonNumber].lastAction = BUTTON_ACTION_RELEASE;
-                    _buttonsList[_buttonNumber].lastActionTimestamp = 0U;
-                    _buttonsList[_buttonNumber].eventsTriggered = 0U;
-                    _buttonNumber++;
-                    /* configure new gpio and isr */
-                    gpioConfig.pin_bit_mask = BIT64(buttonEvent.config.gpio);
-                    gpioConfig.mode = GPIO_MODE_INPUT;
-                    gpioConfig.pull_down_en = GPIO_PULLDOWN_ENABLE;
-                    gpioConfig.pull_up_en = GPIO_PULLUP_DISABLE;
-                    gpioConfig.intr_type = GPIO_INTR_ANYEDGE;
-                    gpio_config(&gpioConfig);
-                    if (!_isrServiceInstalled) {
-                        _isrServiceInstalled = (gpio_install_isr_service(0) == ESP_OK);
-                    }
-                    gpio_isr_handler_add(buttonEvent.config.gpio, _buttonsISR, (void*)buttonEvent.config.gpio);
-                    result = true;
-                } else {
-                    result = false;
-                }
-                vOS_QueueSendSafe(&buttonEvent.config.responseQueue, &result);
-                break;
-
-            case BUTTON_EVENT_ISR:
-                if (_getButtonFromGpio(buttonEvent.isr.gpio, &pCurrentButton)) {
-                    switch (buttonEvent.isr.action) {
-                    case BUTTON_ACTION_PRESS:
-                        /* Reset current events triggered */
-                        pCurrentButton->eventsTriggered = BUTTON_TRIGGER_NONE;
-                        currentEventsTriggered = BUTTON_TRIGGER_EDGE_PRESSED;
-                        break;
-                    case BUTTON_ACTION_RELEASE:
-                        currentEventsTriggered = BUTTON_TRIGGER_EDGE_RELEASED;
-                        if ((xTaskGetTickCount() - pCurrentButton->lastActionTimestamp) > BUTTON_PRESSED_VERY_LONG_DURATION_TICKS) {
-                            currentEventsTriggered |= BUTTON_TRIGGER_VERY_LONG_PRESS;
-                        } else if ((xTaskGetTickCount() - pCurrentButton->lastActionTimestamp) > BUTTON_PRESSED_LONG_DURATION_TICKS) {
-                            currentEventsTriggered |= BUTTON_TRIGGER_LONG_PRESS;
-                        } else if ((xTaskGetTickCount() - pCurrentButton->lastActionTimestamp) > BUTTON_PRESSED_SHORT_DURATION_TICKS) {
-                            currentEventsTriggered |= BUTTON_TRIGGER_SHORT_PRESS;
-                        }
-                        break;
-                    default:
-                        break;
-                    }
-                    /* Mask events triggered with register in conf and with events not already triggered in the past */
-                    currentEventsTriggered &= pCurrentButton->config.triggerRegister;
-                    currentEventsTriggered &= ~pCurrentButton->eventsTriggered;
-                    /* Save new events triggered */
-                    pCurrentButton->eventsTriggered |= currentEventsTriggered;
-                    /* Save action context */
-                    pCurrentButton->lastActionTimestamp = xTaskGetTickCount();
-                    pCurrentButton->lastAction = buttonEvent.isr.action;
-                    /* Notify upper layer */
-                    _notifyToUpperLayer(currentEventsTriggered, &pCurrentButton->config);
-                }
+    bool result = !_matrix.configured && (pConfig->rowNumber > 0U) && (pConfig->rowNumber <= BUTTON_MATRIX_MAX_ROWS)
+        && (pConfig->columnNumber > 0U) && (pConfig->columnNumber <= BUTTON_MATRIX_MAX_COLUMNS);
+
+    if (result) {
+        memcpy(&_matrix.config, pConfig, sizeof(_matrix.config));
+        /* Idle with all rows low: any press pulls its column down */
+        for (uint8_t row = 0U; row < pConfig->rowNumber; row++) {
+            gpioConfig.pin_bit_mask |= BIT64(pConfig->rowGpios[row]);
+        }
+        gpioConfig.mode = GPIO_MODE_OUTPUT_OD;
+        gpioConfig.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        gpioConfig.pull_up_en = GPIO_PULLUP_DISABLE;
+        gpioConfig.intr_type = GPIO_INTR_DISABLE;
+        gpio_config(&gpioConfig);
+        for (uint8_t row = 0U; row < pConfig->rowNumber; row++) {
+            gpio_set_level(pConfig->rowGpios[row], 0U);
+        }
+        gpioConfig.pin_bit_mask = 0U;
+        for (uint8_t column = 0U; column < pConfig->columnNumber; column++) {
+            gpioConfig.pin_bit_mask |= BIT64(pConfig->columnGpios[column]);
+        }
+        gpioConfig.mode = GPIO_MODE_INPUT;
+        gpioConfig.pull_up_en = GPIO_PULLUP_ENABLE;
+        gpioConfig.intr_type = GPIO_INTR_NEGEDGE;
+        gpio_config(&gpioConfig);
+        result = _installIsrServiceOnce();
+    }
+    if (result) {
+        for (uint8_t column = 0U; column < pConfig->columnNumber; column++) {
+            gpio_isr_handler_add(pConfig->columnGpios[column], _matrixISR, NULL);
+            /* Presses wake the chip from light sleep */
+            vPWR_ArmGpioWakeup(pConfig->columnGpios[column]);
+        }
+        _matrix.configured = true;
+        ESP_LOGI(TAG_BUTTON, "Matrix keypad %ux%u", pConfig->rowNumber, pConfig->columnNumber);
+    }
 
-                break;
+    return result;
+}
+
+/* Returns false once no key is down nor changing */
+static bool _scanMatrix(void)
+{
+    uint8_t sample[BUTTON_MATRIX_MAX_ROWS] = { 0 };
+    uint8_t ambiguousRows = 0U;
+    bool pressed = false;
+    bool active = false;
+
+    /* One row low at a time, the others released: each pressed key of the row pulls its column down */
+    for (uint8_t row = 0U; row < _matrix.config.rowNumber; row++) {
+        gpio_set_level(_matrix.config.rowGpios[row], 1U);
+    }
+    for (uint8_t row = 0U; row < _matrix.config.rowNumber; row++) {
+        gpio_set_level(_matrix.config.rowGpios[row], 0U);
+        ets_delay_us(BUTTON_MATRIX_SETTLE_US);
+        for (uint8_t column = 0U; column < _matrix.config.columnNumber; column++) {
+            if (gpio_get_level(_matrix.config.columnGpios[column]) == 0) {
+                sample[row] |= BIT(column);
+            }
+        }
+        gpio_set_level(_matrix.config.rowGpios[row], 1U);
+    }
+    for (uint8_t row = 0U; row < _matrix.config.rowNumber; row++) {
+        gpio_set_level(_matrix.config.rowGpios[row], 0U);
+    }
 
-            default:
-                break;
+    /* Without diodes, three keys on the corners of a rectangle make the fourth one read pressed. Rows sharing
+     * two columns are ambiguous: they only accept releases until the rectangle opens */
+    for (uint8_t row = 0U; row < _matrix.config.rowNumber; row++) {
+        for (uint8_t otherRow = row + 1U; otherRow < _matrix.config.rowNumber; otherRow++) {
+            if (__builtin_popcount(sample[row] & sample[otherRow]) > 1) {
+                ambiguousRows |= BIT(row) | BIT(otherRow);
             }
         }
-        /* In any case, check other buttons state */
-        taskBlockTime = portMAX_DELAY;
-        for (buttonCounter = 0U; buttonCounter < _buttonNumber; buttonCounter++) {
-            if (_buttonsList[buttonCounter].lastAction == BUTTON_ACTION_PRESS) {
-                taskBlockTime = CHECK_BUTTONS_DELAY_TICKS;
-                currentEventsTriggered = BUTTON_TRIGGER_NONE;
-                if ((xTaskGetTickCount() - _buttonsList[buttonCounter].lastActionTimestamp) > BUTTON_PRESSED_VERY_LONG_DURATION_TICKS) {
-                    currentEventsTriggered |= BUTTON_TRIGGER_VERY_LONG_PRESS;
-                } else if ((xTaskGetTickCount() - _buttonsList[buttonCounter].lastActionTimestamp) > BUTTON_PRESSED_LONG_DURATION_TICKS) {
-                    currentEventsTriggered |= BUTTON_TRIGGER_LONG_PRESS;
-                } else if ((xTaskGetTickCount() - _buttonsList[buttonCounter].lastActionTimestamp) > BUTTON_PRESSED_SHORT_DURATION_TICKS) {
-                    currentEventsTriggered |= BUTTON_TRIGGER_SHORT_PRESS;
+    }
+
+    for (uint8_t row = 0U; row < _matrix.config.rowNumber; row++) {
+        if ((ambiguousRows & BIT(row)) != 0U) {
+            sample[row] &= _matrix.keysDown[row];
+        }
+        for (uint8_t column = 0U; column < _matrix.config.columnNumber; column++) {
+            pressed = ((sample[row] & BIT(column)) != 0U);
+            if (pressed == ((_matrix.keysDown[row] & BIT(column)) != 0U)) {
+                _matrix.debounceCount[row][column] = 0U;
+            } else if (++_matrix.debounceCount[row][column] >= BUTTON_MATRIX_DEBOUNCE_SCANS) {
+                _matrix.debounceCount[row][column] = 0U;
+                _matrix.keysDown[row] ^= BIT(column);
+                /* Same path as the GPIO buttons from here. A replay owns the inputs, as for the GPIO interrupts */
+                if (!ILOG_IS_REPLAYING()) {
+                    _raiseEdge(BUTTON_MATRIX_KEY(row, column), pressed ? 1U : 0U);
                 }
-                /* Mask events triggered with register in conf and with events not already triggered in the past */
-                currentEventsTriggered &= _buttonsList[buttonCounter].config.triggerRegister;
-                currentEventsTriggered &= ~_buttonsList[buttonCounter].eventsTriggered;
-                /* Save new events triggered */
-                _buttonsList[buttonCounter].eventsTriggered |= currentEventsTriggered;
-                /* Notify upper layer */
-                _notifyToUpperLayer(currentEventsTriggered, &_buttonsList[buttonCounter].config);
             }
+            active |= (_matrix.debounceCount[row][column] > 0U);
         }
+        active |= (_matrix.keysDown[row] != 0U);
     }
+
+    return active;
 }
 
-bool bBUT_RegisterButton(uint32_t gpio, uint32_t triggerBitmap, QueueHandle_t eventQueue)
+static void _stopMatrixScan(void)
 {
-    buttonQueueEvent_t newButton;
-    bool result = false;
+    bool pressed = false;
 
-    newButton.type = BUTTON_EVENT_CONFIG;
-    newButton.config.gpio = gpio;
-    newButton.config.triggerRegister = triggerBitmap;
-    newButton.config.eventQueue = eventQueue;
-    if (!bOS_SendToTaskAndWaitResponse(_queueForButtons, &newButton, &newButton.config.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
-        ESP_LOGE(TAG_BUTTON, "Cannot get response from task");
+    _matrix.scanning = false;
+    for (uint8_t column = 0U; column < _matrix.config.columnNumber; column++) {
+        gpio_intr_enable(_matrix.config.columnGpios[column]);
+        vPWR_ArmGpioWakeup(_matrix.config.columnGpios[column]);
+        pressed |= (gpio_get_level(_matrix.config.columnGpios[column]) == 0);
+    }
+    /* A press since the last scan left no edge to interrupt on */
+    if (pressed) {
+        for (uint8_t column = 0U; column < _matrix.config.columnNumber; column++) {
+            gpio_intr_disable(_matrix.config.columnGpios[column]);
+        }
+        _matrix.scanning = true;
     }
-    return result;
 }
 
 static bool _getButtonFromGpio(uint32_t gpio, buttonContext_t** pButton)
@@ -241,19 +572,307 @@ static bool _getButtonFromGpio(uint32_t gpio, buttonContext_t** pButton)
     return result;
 }
 
-static bool _notifyToUpperLayer(uint32_t triggerBitmap, buttonConfig_t* pButtonConfig)
+/* Returns true when the edge published an event */
+static bool _dispatchEdge(buttonContext_t* pButton, buttonAction_e action)
+{
+    uint8_t event = GESTURE_EVENT_PRESS;
+
+    if (action == BUTTON_ACTION_PRESS) {
+        event = pButton->isChordKey ? GESTURE_EVENT_CHORD_KEY_PRESS : GESTURE_EVENT_PRESS;
+    } else if ((pButton->config.triggerRegister & BUTTON_TRIGGER_DOUBLE_CLICK)
+        && !(pButton->eventsTriggered & BUTTON_TRIGGER_DOUBLE_CLICK)
+        && ((xTaskGetTickCount() - pButton->pressTimestamp) <= BUTTON_CLICK_MAX_TICKS)) {
+        event = GESTURE_EVENT_CLICK_RELEASE;
+    } else {
+        event = GESTURE_EVENT_RELEASE;
+    }
+
+    _gesturePublished = false;
+    _dispatchGesture(pButton, event);
+    if (event == GESTURE_EVENT_CHORD_KEY_PRESS) {
+        _completeChords();
+    }
+
+    return _gesturePublished;
+}
+
+static void _dispatchGesture(buttonContext_t* pButton, uint8_t event)
+{
+    _pGestureButton = pButton;
+    xSM_Dispatch(&pButton->gesture, event, NULL);
+    _pGestureButton = NULL;
+}
+
+/* A chord completes when all its keys wait at once, they all were pressed within the window */
+static void _completeChords(void)
+{
+    bool complete = false;
+
+    for (uint8_t chord = 0U; chord < _chordNumber; chord++) {
+        complete = true;
+        for (uint8_t key = 0U; complete && (key < _chords[chord].keyNumber); key++) {
+            complete = (u8SM_GetState(&_buttonsList[_chords[chord].keyIndexes[key]].gesture) == GESTURE_STATE_CHORD_WAIT);
+        }
+        if (complete) {
+            for (uint8_t key = 0U; key < _chords[chord].keyNumber; key++) {
+                _dispatchGesture(&_buttonsList[_chords[chord].keyIndexes[key]], GESTURE_EVENT_CHORD);
+            }
+            _gesturePublished = true;
+            _notifyToUpperLayer(BUTTON_TRIGGER_CHORD, _chords[chord].chord);
+        }
+    }
+}
+
+static bool _publish(uint32_t triggerBitmap)
 {
-    buttonEvent_t upperLayerEvent;
     bool result = false;
 
-    upperLayerEvent.triggerBitmap = triggerBitmap;
-    if (upperLayerEvent.triggerBitmap != BUTTON_TRIGGER_NONE) {
-        upperLayerEvent.gpio = pButtonConfig->gpio;
-        if (pButtonConfig->eventQueue != NULL) {
-            xQueueSend(pButtonConfig->eventQueue, &upperLayerEvent, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
-            result = true;
+    triggerBitmap &= _pGestureButton->config.triggerRegister;
+    _pGestureButton->eventsTriggered |= triggerBitmap;
+    result = _notifyToUpperLayer(triggerBitmap, _pGestureButton->config.gpio);
+    _gesturePublished |= result;
+
+    return result;
+}
+
+/* Longest hold threshold passed, the classification only ever publishes one of them at a time */
+static uint32_t _getHoldTrigger(TickType_t heldTicks)
+{
+    uint32_t result = BUTTON_TRIGGER_NONE;
+
+    if (heldTicks > BUTTON_PRESSED_VERY_LONG_DURATION_TICKS) {
+        result = BUTTON_TRIGGER_VERY_LONG_PRESS;
+    } else if (heldTicks > BUTTON_PRESSED_LONG_DURATION_TICKS) {
+        result = BUTTON_TRIGGER_LONG_PRESS;
+    } else if (heldTicks > BUTTON_PRESSED_SHORT_DURATION_TICKS) {
+        result = BUTTON_TRIGGER_SHORT_PRESS;
+    }
+
+    return result;
+}
+
+/* Wakes the task at the next registered threshold or repeat only, no polling while a button is held */
+static void _armHoldTimeout(void)
+{
+    static const TickType_t thresholds[] = { BUTTON_PRESSED_SHORT_DURATION_TICKS, BUTTON_PRESSED_LONG_DURATION_TICKS, BUTTON_PRESSED_VERY_LONG_DURATION_TICKS };
+    static const uint32_t triggers[] = { BUTTON_TRIGGER_SHORT_PRESS, BUTTON_TRIGGER_LONG_PRESS, BUTTON_TRIGGER_VERY_LONG_PRESS };
+    buttonContext_t* pButton = _pGestureButton;
+    TickType_t now = xTaskGetTickCount();
+    TickType_t heldTicks = now - pButton->pressTimestamp;
+    TickType_t timeoutTicks = portMAX_DELAY;
+
+    for (uint8_t threshold = 0U; threshold < (sizeof(thresholds) / sizeof(thresholds[0])); threshold++) {
+        if ((pButton->config.triggerRegister & triggers[threshold]) && !(pButton->eventsTriggered & triggers[threshold])
+            && (heldTicks <= thresholds[threshold]) && ((thresholds[threshold] + 1U - heldTicks) < timeoutTicks)) {
+            timeoutTicks = thresholds[threshold] + 1U - heldTicks;
+        }
+    }
+    if (pButton->config.triggerRegister & BUTTON_TRIGGER_HOLD_REPEAT) {
+        if (!TICK_IS_BEFORE(now, pButton->nextRepeatTimestamp)) {
+            timeoutTicks = 0U;
+        } else if ((pButton->nextRepeatTimestamp - now) < timeoutTicks) {
+            timeoutTicks = pButton->nextRepeatTimestamp - now;
+        }
+    }
+    vSM_SetTimeout(&pButton->gesture, timeoutTicks);
+}
+
+static void _enterPressed(void)
+{
+    _armHoldTimeout();
+}
+
+static bool _press(void* pEvent)
+{
+    _holdBackPress(pEvent);
+    _publish(BUTTON_TRIGGER_EDGE_PRESSED);
+
+    return true;
+}
+
+static bool _holdBackPress(void* pEvent)
+{
+    _pGestureButton->pressTimestamp = xTaskGetTickCount();
+    _pGestureButton->nextRepeatTimestamp = _pGestureButton->pressTimestamp + BUTTON_HOLD_REPEAT_DELAY_TICKS;
+    _pGestureButton->eventsTriggered = BUTTON_TRIGGER_NONE;
+
+    return true;
+}
+
+static bool _publishPress(void* pEvent)
+{
+    _publish(BUTTON_TRIGGER_EDGE_PRESSED);
+
+    return true;
+}
+
+static bool _tap(void* pEvent)
+{
+    _publish(BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_EDGE_RELEASED | _getHoldTrigger(xTaskGetTickCount() - _pGestureButton->pressTimestamp));
+
+    return true;
+}
+
+static bool _release(void* pEvent)
+{
+    /* Hold threshold passed since the last timeout, not published yet */
+    uint32_t holdTrigger = _getHoldTrigger(xTaskGetTickCount() - _pGestureButton->pressTimestamp) & ~_pGestureButton->eventsTriggered;
+
+    _publish(BUTTON_TRIGGER_EDGE_RELEASED | holdTrigger);
+
+    return true;
+}
+
+static bool _doubleClick(void* pEvent)
+{
+    _holdBackPress(pEvent);
+    _publish(BUTTON_TRIGGER_EDGE_PRESSED | BUTTON_TRIGGER_DOUBLE_CLICK);
+    /* Marks the second click even if unregistered: it does not start another double click */
+    _pGestureButton->eventsTriggered |= BUTTON_TRIGGER_DOUBLE_CLICK;
+
+    return true;
+}
+
+static bool _holdTimeout(void* pEvent)
+{
+    buttonContext_t* pButton = _pGestureButton;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t triggers = _getHoldTrigger(now - pButton->pressTimestamp) & ~pButton->eventsTriggered;
+
+    if ((pButton->config.triggerRegister & BUTTON_TRIGGER_HOLD_REPEAT) && !TICK_IS_BEFORE(now, pButton->nextRepeatTimestamp)) {
+        triggers |= BUTTON_TRIGGER_HOLD_REPEAT;
+        /* Fixed rate, a late repeat does not make the next ones come in a burst */
+        pButton->nextRepeatTimestamp += BUTTON_HOLD_REPEAT_PERIOD_TICKS;
+        if (!TICK_IS_BEFORE(now, pButton->nextRepeatTimestamp)) {
+            pButton->nextRepeatTimestamp = now + BUTTON_HOLD_REPEAT_PERIOD_TICKS;
+        }
+    }
+    _publish(triggers);
+    _armHoldTimeout();
+
+    return true;
+}
+
+static bool _notifyToUpperLayer(uint32_t triggerBitmap, uint32_t gpio)
+{
+    buttonEvent_t* pUpperLayerEvent = NULL;
+    bool result = false;
+
+    if (triggerBitmap != BUTTON_TRIGGER_NONE) {
+        pUpperLayerEvent = BUS_ALLOC(BUS_TOPIC_BUTTON, buttonEvent_t);
+        if (pUpperLayerEvent != NULL) {
+            pUpperLayerEvent->gpio = gpio;
+            pUpperLayerEvent->triggerBitmap = triggerBitmap;
+            result = (u8BUS_Publish(pUpperLayerEvent) > 0U);
         }
     }
 
     return result;
+}
+
+static void _init(void)
+{
+    _queueForButtons = OS_QUEUE_CREATE("Queue buttons", BUTTONS_QUEUE_LENGTH, sizeof(buttonQueueEvent_t));
+#if SYSTEM_INPUT_LOG_ENABLED
+    vILOG_SetEdgeInjector(_raiseEdge);
+#endif
+}
+
+static TickType_t _handleEvent(void* pEvent)
+{
+    buttonQueueEvent_t* pButtonEvent = (buttonQueueEvent_t*)pEvent;
+    buttonContext_t* pCurrentButton = NULL;
+    gpio_config_t gpioConfig = { 0 };
+    TickType_t taskBlockTime = portMAX_DELAY;
+    TickType_t gestureBlockTime = portMAX_DELAY;
+    uint8_t buttonCounter = 0;
+    bool result = false;
+
+    if (pButtonEvent != NULL) {
+        switch (pButtonEvent->type) {
+        case BUTTON_EVENT_CONFIG:
+            result = (_buttonNumber < MAX_BUTTON_NUMBER) && _isKnownInput(pButtonEvent->config.gpio);
+            if (result) {
+                /* add button in list */
+                memcpy(&_buttonsList[_buttonNumber].config, &pButtonEvent->config, sizeof(pButtonEvent->config));
+                _buttonsList[_buttonNumber].isChordKey = false;
+                _buttonsList[_buttonNumber].pressTimestamp = 0U;
+                _buttonsList[_buttonNumber].nextRepeatTimestamp = 0U;
+                _buttonsList[_buttonNumber].eventsTriggered = 0U;
+                vSM_Start(&_buttonsList[_buttonNumber].gesture, &_gestureDefinition);
+                _buttonNumber++;
+            }
+            /* Matrix keys are served by the column interrupts and the scan */
+            if (result && (pButtonEvent->config.gpio < GPIO_NUM_MAX)) {
+                /* configure new gpio and isr */
+                gpioConfig.pin_bit_mask = BIT64(pButtonEvent->config.gpio);
+                gpioConfig.mode = GPIO_MODE_INPUT;
+                gpioConfig.pull_down_en = GPIO_PULLDOWN_ENABLE;
+                gpioConfig.pull_up_en = GPIO_PULLUP_DISABLE;
+                gpioConfig.intr_type = GPIO_INTR_ANYEDGE;
+                gpio_config(&gpioConfig);
+                _installIsrServiceOnce();
+                gpio_isr_handler_add(pButtonEvent->config.gpio, _buttonsISR, (void*)(uintptr_t)pButtonEvent->config.gpio);
+                /* Presses wake the chip from light sleep */
+                vPWR_ArmGpioWakeup(pButtonEvent->config.gpio);
+            }
+            vOS_QueueSendSafe(&pButtonEvent->config.responseQueue, &result);
+            break;
+
+        case BUTTON_EVENT_CHORD_CONFIG:
+            result = _configureChord(&pButtonEvent->chord);
+            vOS_QueueSendSafe(&pButtonEvent->chord.responseQueue, &result);
+            break;
+
+        case BUTTON_EVENT_MATRIX_CONFIG:
+            result = _configureMatrix(&pButtonEvent->matrix.config);
+            vOS_QueueSendSafe(&pButtonEvent->matrix.responseQueue, &result);
+            break;
+
+        case BUTTON_EVENT_MATRIX_WAKE:
+            if (!_matrix.scanning) {
+                _matrix.scanning = true;
+                _matrix.nextScanTicks = xTaskGetTickCount();
+            }
+            break;
+
+        case BUTTON_EVENT_ISR:
+            DLN_STAMP(DLN_STAGE_BUTTON_TASK);
+            /* Edges without a gesture published right away end their deadline chain here */
+            if (!_getButtonFromGpio(pButtonEvent->isr.gpio, &pCurrentButton) || !_dispatchEdge(pCurrentButton, pButtonEvent->isr.action)) {
+                DLN_ABANDON();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /* In any case, run the gesture timeouts: the task only wakes up at the next one */
+    for (buttonCounter = 0U; buttonCounter < _buttonNumber; buttonCounter++) {
+        _pGestureButton = &_buttonsList[buttonCounter];
+        gestureBlockTime = xSM_HandleTimeout(&_buttonsList[buttonCounter].gesture);
+        _pGestureButton = NULL;
+        if (gestureBlockTime < taskBlockTime) {
+            taskBlockTime = gestureBlockTime;
+        }
+    }
+
+    /* Timed scans while a key is down, the column interrupts take over once all are released */
+    if (_matrix.scanning && !TICK_IS_BEFORE(xTaskGetTickCount(), _matrix.nextScanTicks)) {
+        /* Fixed rate, a late scan does not make the next ones come in a burst */
+        _matrix.nextScanTicks += BUTTON_MATRIX_SCAN_PERIOD_TICKS;
+        if (!TICK_IS_BEFORE(xTaskGetTickCount(), _matrix.nextScanTicks)) {
+            _matrix.nextScanTicks = xTaskGetTickCount() + BUTTON_MATRIX_SCAN_PERIOD_TICKS;
+        }
+        if (!_scanMatrix()) {
+            _stopMatrixScan();
+        }
+    }
+    if (_matrix.scanning && ((_matrix.nextScanTicks - xTaskGetTickCount()) < taskBlockTime)) {
+        taskBlockTime = _matrix.nextScanTicks - xTaskGetTickCount();
+    }
+
+    return taskBlockTime;
 }
\ No newline at end of file
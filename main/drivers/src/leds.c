@@ -11,6 +11,8 @@
 #include "leds.h"
 #include "driver/ledc.h"
 #include "mapping.h"
+#include "reactor.h"
+#include "trace.h"
 
 /* ____________________________________________________________________________ */
 /* Defines  																	*/
@@ -73,6 +75,8 @@ typedef struct {
 /* ____________________________________________________________________________ */
 /* Static prototypes 															*/
 static void _setLed(uint8_t handle, uint32_t rgbColor, bool fade, uint32_t fadeDelayMs);
+static void _init(void);
+static TickType_t _handleEvent(void* pEvent);
 
 /* ____________________________________________________________________________ */
 /* Static variables 															*/
@@ -97,6 +101,15 @@ static ledc_channel_config_t _channelConfig = {
 static uint8_t _ledIndex = 0;
 static float _gainPerColor[MAX_PINS_PER_LED] = { RED_GAIN, GREEN_GAIN, BLUE_GAIN };
 static ledBlinkContext_t _ledsContext[MAX_REGISTERED_LEDS] = { 0 };
+static const reactorModule_t _reactorModule = {
+    .name = "Driver LEDs",
+    .bootModule = BOOT_MODULE_LEDS,
+    .pQueue = &_queueForLeds,
+    .queueLength = LEDS_QUEUE_LENGTH,
+    .eventSize = sizeof(ledEvent_t),
+    .init = _init,
+    .handleEvent = _handleEvent,
+};
 
 /* ____________________________________________________________________________ */
 /* ISR handlers 																*/
@@ -106,75 +119,12 @@ static ledBlinkContext_t _ledsContext[MAX_REGISTERED_LEDS] = { 0 };
 
 void vLED_Process(void* pvParameters)
 {
-    ledEvent_t event = { 0 };
-    _queueForLeds = xQueueCreate(10, sizeof(ledEvent_t));
-    uint8_t ledIndex = 0;
-    bool atLeastOneLedBlinking = false;
-    TickType_t ticksToBlock = portMAX_DELAY;
-
-    ledc_timer_config(&_ledTimer);
-    ledc_fade_func_install(0);
-
-    for (;;) {
-        if (xQueueReceive(_queueForLeds, &event, ticksToBlock) == pdTRUE) {
-            switch (event.type) {
-            case EVENT_REGISTER:
-                if ((event.config.rGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
-                    _channelConfig.gpio_num = event.config.rGpio;
-                    ledc_channel_config(&_channelConfig);
-                    _ledChannels[_ledIndex][PIN_RED_INDEX] = _channelConfig.channel++;
-                }
-                if ((event.config.gGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
-                    _channelConfig.gpio_num = event.config.gGpio;
-                    ledc_channel_config(&_channelConfig);
-                    _ledChannels[_ledIndex][PIN_GREEN_INDEX] = _channelConfig.channel++;
-                }
-                if ((event.config.bGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
-                    _channelConfig.gpio_num = event.config.bGpio;
-                    ledc_channel_config(&_channelConfig);
-                    _ledChannels[_ledIndex][PIN_BLUE_INDEX] = _channelConfig.channel++;
-                }
-                vOS_QueueSendSafe(&event.responseQueue, &_ledIndex);
-                _ledIndex++;
-                break;
-
-            case EVENT_SET_BLINKING:
-                memcpy(&_ledsContext[event.ledHandle].ledParams, &event.params, sizeof(event.params));
-                _ledsContext[event.ledHandle].nextActionTimestamp = xTaskGetTickCount() + pdMS_TO_TICKS(_ledsContext[event.ledHandle].ledParams.blinkPeriodMs / 2);
-                _ledsContext[event.ledHandle].nextColor = LED_COLOR_BLACK;
-                ticksToBlock = CHECK_BLINKING_PERIOD_TICKS;
-                _setLed(event.ledHandle, event.params.rgbColor, event.params.fade, event.params.delayToFade);
-                break;
-
-            case EVENT_SET_SOLID:
-                _ledsContext[event.ledHandle].ledParams.blinkCount = 0;
-                _setLed(event.ledHandle, event.params.rgbColor, event.params.fade, event.params.delayToFade);
-                break;
-
-            default:
-                break;
-            }
-        }
+    vREACTOR_RunModule(&_reactorModule);
+}
 
-        /* In any case, check blinking leds */
-        atLeastOneLedBlinking = false;
-        for (ledIndex = 0; ledIndex < MAX_REGISTERED_LEDS; ledIndex++) {
-            if (_ledsContext[ledIndex].ledParams.blinkCount != 0) {
-                atLeastOneLedBlinking = true;
-                if (xTaskGetTickCount() > _ledsContext[ledIndex].nextActionTimestamp) {
-                    _setLed(ledIndex, _ledsContext[ledIndex].nextColor, _ledsContext[ledIndex].ledParams.fade, _ledsContext[ledIndex].ledParams.delayToFade);
-                    if ((_ledsContext[ledIndex].ledParams.blinkCount != BLINK_CONTINIOUSLY) && (_ledsContext[ledIndex].nextColor == LED_COLOR_BLACK)) {
-                        _ledsContext[ledIndex].ledParams.blinkCount--;
-                    }
-                    _ledsContext[ledIndex].nextActionTimestamp = xTaskGetTickCount() + pdMS_TO_TICKS(_ledsContext[ledIndex].ledParams.blinkPeriodMs / 2);
-                    _ledsContext[ledIndex].nextColor = (_ledsContext[ledIndex].nextColor == LED_COLOR_BLACK) ? _ledsContext[ledIndex].ledParams.rgbColor : LED_COLOR_BLACK;
-                }
-            }
-        }
-        if (!atLeastOneLedBlinking) {
-            ticksToBlock = portMAX_DELAY;
-        }
-    }
+const reactorModule_t* pLED_GetReactorModule(void)
+{
+    return &_reactorModule;
 }
 
 uint8_t u8LED_RegisterLed(uint32_t rGpio, uint32_t gGpio, uint32_t bGpio)
@@ -205,7 +155,8 @@ void vLED_SetLedSolid(uint8_t ledHandle, uint32_t color, bool fade, uint32_t del
     event.params.fade = fade;
     event.params.delayToFade = delayToFadeMs;
 
-    xQueueSend(_queueForLeds, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_LEDS, event.type);
+    bOS_QueueSend(_queueForLeds, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
 }
 
 void vLED_SetLedBlinking(uint8_t ledHandle, uint32_t color, bool fade, uint32_t delayToFadeMs, uint32_t periodMs, uint32_t blinkCount)
@@ -220,7 +171,8 @@ void vLED_SetLedBlinking(uint8_t ledHandle, uint32_t color, bool fade, uint32_t
     event.params.fade = fade;
     event.params.delayToFade = delayToFadeMs;
 
-    xQueueSend(_queueForLeds, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_LEDS, event.type);
+    bOS_QueueSend(_queueForLeds, &event, WRITE_IN_QUEUE_DEFAULT_TIMEOUT);
 }
 
 void vLED_SetLedOff(uint8_t ledHandle, bool fade, uint32_t delayToFadeMs)
@@ -248,3 +200,74 @@ static void _setLed(uint8_t handle, uint32_t rgbColor, bool fade, uint32_t fadeD
         }
     }
 }
+
+static void _init(void)
+{
+    _queueForLeds = OS_QUEUE_CREATE("Queue LEDs", LEDS_QUEUE_LENGTH, sizeof(ledEvent_t));
+    ledc_timer_config(&_ledTimer);
+    ledc_fade_func_install(0);
+}
+
+static TickType_t _handleEvent(void* pEvent)
+{
+    ledEvent_t* pLedEvent = (ledEvent_t*)pEvent;
+    uint8_t ledIndex = 0;
+    bool atLeastOneLedBlinking = false;
+
+    if (pLedEvent != NULL) {
+        switch (pLedEvent->type) {
+        case EVENT_REGISTER:
+            if ((pLedEvent->config.rGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
+                _channelConfig.gpio_num = pLedEvent->config.rGpio;
+                ledc_channel_config(&_channelConfig);
+                _ledChannels[_ledIndex][PIN_RED_INDEX] = _channelConfig.channel++;
+            }
+            if ((pLedEvent->config.gGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
+                _channelConfig.gpio_num = pLedEvent->config.gGpio;
+                ledc_channel_config(&_channelConfig);
+                _ledChannels[_ledIndex][PIN_GREEN_INDEX] = _channelConfig.channel++;
+            }
+            if ((pLedEvent->config.bGpio != LED_NO_PIN) && (_channelConfig.channel < LEDC_CHANNEL_MAX)) {
+                _channelConfig.gpio_num = pLedEvent->config.bGpio;
+                ledc_channel_config(&_channelConfig);
+                _ledChannels[_ledIndex][PIN_BLUE_INDEX] = _channelConfig.channel++;
+            }
+            vOS_QueueSendSafe(&pLedEvent->responseQueue, &_ledIndex);
+            _ledIndex++;
+            break;
+
+        case EVENT_SET_BLINKING:
+            memcpy(&_ledsContext[pLedEvent->ledHandle].ledParams, &pLedEvent->params, sizeof(pLedEvent->params));
+            _ledsContext[pLedEvent->ledHandle].nextActionTimestamp = xTaskGetTickCount() + pdMS_TO_TICKS(_ledsContext[pLedEvent->ledHandle].ledParams.blinkPeriodMs / 2);
+            _ledsContext[pLedEvent->ledHandle].nextColor = LED_COLOR_BLACK;
+            _setLed(pLedEvent->ledHandle, pLedEvent->params.rgbColor, pLedEvent->params.fade, pLedEvent->params.delayToFade);
+            break;
+
+        case EVENT_SET_SOLID:
+            _ledsContext[pLedEvent->ledHandle].ledParams.blinkCount = 0;
+            _setLed(pLedEvent->ledHandle, pLedEvent->params.rgbColor, pLedEvent->params.fade, pLedEvent->params.delayToFade);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /* In any case, check blinking leds */
+    atLeastOneLedBlinking = false;
+    for (ledIndex = 0; ledIndex < MAX_REGISTERED_LEDS; ledIndex++) {
+        if (_ledsContext[ledIndex].ledParams.blinkCount != 0) {
+            atLeastOneLedBlinking = true;
+            if (xTaskGetTickCount() > _ledsContext[ledIndex].nextActionTimestamp) {
+                _setLed(ledIndex, _ledsContext[ledIndex].nextColor, _ledsContext[ledIndex].ledParams.fade, _ledsContext[ledIndex].ledParams.delayToFade);
+                if ((_ledsContext[ledIndex].ledParams.blinkCount != BLINK_CONTINIOUSLY) && (_ledsContext[ledIndex].nextColor == LED_COLOR_BLACK)) {
+                    _ledsContext[ledIndex].ledParams.blinkCount--;
+                }
+                _ledsContext[ledIndex].nextActionTimestamp = xTaskGetTickCount() + pdMS_TO_TICKS(_ledsContext[ledIndex].ledParams.blinkPeriodMs / 2);
+                _ledsContext[ledIndex].nextColor = (_ledsContext[ledIndex].nextColor == LED_COLOR_BLACK) ? _ledsContext[ledIndex].ledParams.rgbColor : LED_COLOR_BLACK;
+            }
+        }
+    }
+
+    return atLeastOneLedBlinking ? CHECK_BLINKING_PERIOD_TICKS : portMAX_DELAY;
+}
@@ -0,0 +1,213 @@
+/**
+*******************************************************************************
+* @file 	power.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+/* ____________________________________________________________________________ */
+/* Includes  																	*/
+#include "power.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "mapping.h"
+#include "msgBus.h"
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+#include "driver/uart.h"
+#include "esp32/pm.h"
+#include "esp_sleep.h"
+#endif
+
+#if SYSTEM_POWER_MANAGEMENT_ENABLED && !CONFIG_PM_ENABLE
+#error "SYSTEM_POWER_MANAGEMENT_ENABLED requires CONFIG_PM_ENABLE"
+#endif
+
+/* ____________________________________________________________________________ */
+/* Defines  																	*/
+#define TAG_PWR ("PWR")
+#define CHARGE_STATUS_ACTIVE_LEVEL (0) /* Charger status output is open drain, pulled low while charging */
+#define US_PER_SECOND (1000000LL)
+#define CHARGE_SETTLE_TICKS (pdMS_TO_TICKS(PWR_CHARGE_SETTLE_MS))
+
+/* ____________________________________________________________________________ */
+/* Enum  																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																		*/
+
+/* ____________________________________________________________________________ */
+/* Static prototypes 															*/
+static void _reportCharge(TimerHandle_t timer);
+static void _installIsrService(void* pResult);
+static pwrChargeState_e _readChargeState(void);
+
+/* ____________________________________________________________________________ */
+/* Static variables 															*/
+static const char* _chargeStateNames[PWR_CHARGE_STATE_NUMBER] = {
+    [PWR_CHARGE_STATE_DISCHARGING] = "discharging",
+    [PWR_CHARGE_STATE_CHARGING] = "charging",
+};
+static pwrChargeReport_t _chargeReport = { 0 };
+static portMUX_TYPE _chargeMux = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t _chargeSettleTimer = NULL;
+
+/* ____________________________________________________________________________ */
+/* ISR handlers 																*/
+static void _chargeStatusISR(void* pArgs)
+{
+    BaseType_t higherTaskWoken = pdFALSE;
+
+    vPWR_ArmGpioWakeup(CHARGE_STATUS_GPIO_NUM);
+    /* Each edge restarts the settle delay: the line is read once it has been steady, bounces are never reported */
+    xTimerResetFromISR(_chargeSettleTimer, &higherTaskWoken);
+
+    if (higherTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/* ____________________________________________________________________________ */
+/* Public functions 															*/
+void vPWR_Init(void)
+{
+    gpio_config_t gpioConfig = { 0 };
+    esp_err_t result = ESP_OK;
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+    esp_pm_config_esp32_t pmConfig = {
+        .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = PWR_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+
+    /* Light sleep is entered from the idle task once every lock is released (tickless idle) */
+    if (esp_pm_configure(&pmConfig) != ESP_OK) {
+        ESP_LOGE(TAG_PWR, "Cannot configure power management");
+    }
+    /* Pins armed with vPWR_ArmGpioWakeup wake the chip */
+    esp_sleep_enable_gpio_wakeup();
+#endif
+
+    gpioConfig.pin_bit_mask = BIT64(CHARGE_STATUS_GPIO_NUM);
+    gpioConfig.mode = GPIO_MODE_INPUT;
+    gpioConfig.pull_up_en = GPIO_PULLUP_ENABLE;
+    gpioConfig.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    gpioConfig.intr_type = GPIO_INTR_ANYEDGE;
+    gpio_config(&gpioConfig);
+
+    _chargeReport.state = _readChargeState();
+    _chargeReport.sinceUs = esp_timer_get_time();
+    _chargeReport.chargeCount = (_chargeReport.state == PWR_CHARGE_STATE_CHARGING) ? 1U : 0U;
+
+    _chargeSettleTimer = OS_TIMER_CREATE("Timer charge settle", CHARGE_SETTLE_TICKS, pdFALSE, NULL, _reportCharge);
+    /* Service may already be installed by the buttons driver. This init runs on the PRO core, the service goes to the buttons one */
+    if ((_chargeSettleTimer == NULL) || !bOS_RunOnCore(GPIO_ISR_CORE, _installIsrService, &result)) {
+        result = ESP_FAIL;
+    }
+    if ((result == ESP_OK) || (result == ESP_ERR_INVALID_STATE)) {
+        gpio_isr_handler_add(CHARGE_STATUS_GPIO_NUM, _chargeStatusISR, NULL);
+        vPWR_ArmGpioWakeup(CHARGE_STATUS_GPIO_NUM);
+    } else {
+        ESP_LOGE(TAG_PWR, "Cannot watch the charge status");
+    }
+
+    ESP_LOGI(TAG_PWR, "Battery %s", _chargeStateNames[_chargeReport.state]);
+}
+
+void vPWR_CreateLock(pwrLock_t* pLock, const char* name)
+{
+    pLock->held = false;
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+    if ((esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &pLock->cpuLock) != ESP_OK)
+        || (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, name, &pLock->sleepLock) != ESP_OK)) {
+        ESP_LOGE(TAG_PWR, "Cannot create lock %s", name);
+    }
+#endif
+}
+
+void vPWR_AcquireLock(pwrLock_t* pLock)
+{
+    if (!pLock->held) {
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+        esp_pm_lock_acquire(pLock->cpuLock);
+        esp_pm_lock_acquire(pLock->sleepLock);
+#endif
+        pLock->held = true;
+    }
+}
+
+void vPWR_ReleaseLock(pwrLock_t* pLock)
+{
+    if (pLock->held) {
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+        esp_pm_lock_release(pLock->sleepLock);
+        esp_pm_lock_release(pLock->cpuLock);
+#endif
+        pLock->held = false;
+    }
+}
+
+void vPWR_ArmGpioWakeup(uint32_t gpio)
+{
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+    /* Also replaces the edge interrupt type of the pin by this level */
+    gpio_wakeup_enable(gpio, (gpio_get_level(gpio) == 0) ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+#endif
+}
+
+void vPWR_ArmUartWakeup(uint32_t uartNum, uint32_t edgeThreshold)
+{
+#if SYSTEM_POWER_MANAGEMENT_ENABLED
+    if ((uart_set_wakeup_threshold(uartNum, edgeThreshold) != ESP_OK) || (esp_sleep_enable_uart_wakeup(uartNum) != ESP_OK)) {
+        ESP_LOGE(TAG_PWR, "Cannot arm UART %u wakeup", uartNum);
+    }
+#endif
+}
+
+void vPWR_GetChargeReport(pwrChargeReport_t* pReport)
+{
+    portENTER_CRITICAL(&_chargeMux);
+    memcpy(pReport, &_chargeReport, sizeof(_chargeReport));
+    portEXIT_CRITICAL(&_chargeMux);
+}
+
+/* ____________________________________________________________________________ */
+/* Static functions 															*/
+static void _installIsrService(void* pResult)
+{
+    *(esp_err_t*)pResult = gpio_install_isr_service(0);
+}
+
+static void _reportCharge(TimerHandle_t timer)
+{
+    pwrChargeReport_t* pReport = NULL;
+    pwrChargeState_e state = _readChargeState();
+    int64_t nowUs = esp_timer_get_time();
+    bool changed = false;
+
+    portENTER_CRITICAL(&_chargeMux);
+    if (state != _chargeReport.state) {
+        _chargeReport.previousStateDurationS = (uint32_t)((nowUs - _chargeReport.sinceUs) / US_PER_SECOND);
+        _chargeReport.state = state;
+        _chargeReport.sinceUs = nowUs;
+        if (state == PWR_CHARGE_STATE_CHARGING) {
+            _chargeReport.chargeCount++;
+        }
+        changed = true;
+    }
+    portEXIT_CRITICAL(&_chargeMux);
+
+    if (changed) {
+        ESP_LOGI(TAG_PWR, "Battery %s, previous state lasted %u s", _chargeStateNames[state], _chargeReport.previousStateDurationS);
+        pReport = BUS_ALLOC(BUS_TOPIC_CHARGE, pwrChargeReport_t);
+        if (pReport != NULL) {
+            vPWR_GetChargeReport(pReport);
+            u8BUS_Publish(pReport);
+        }
+    }
+}
+
+static pwrChargeState_e _readChargeState(void)
+{
+    return (gpio_get_level(CHARGE_STATUS_GPIO_NUM) == CHARGE_STATUS_ACTIVE_LEVEL) ? PWR_CHARGE_STATE_CHARGING : PWR_CHARGE_STATE_DISCHARGING;
+}
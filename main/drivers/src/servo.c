@@ -8,20 +8,41 @@
 
 /* ____________________________________________________________________________ */
 /* Includes  																	*/
+/* Order logs are on the servo task hot path, set to ESP_LOG_WARN to compile them out */
+#define DLOG_LOCAL_LEVEL (ESP_LOG_INFO)
+
 #include "servo.h"
+#include "deadlineMonitor.h"
+#include "deferredLog.h"
+#include "driver/gpio.h"
 #include "driver/mcpwm.h"
+#include "esp_timer.h"
+#include "inputLog.h"
+#include "nvs.h"
+#include "power.h"
+#include "reactor.h"
+#include "trace.h"
 
 /* ____________________________________________________________________________ */
 /* Defines  																	*/
 #define TAG_SERVO ("SERVO_DRV")
-#define MAX_SERVO_NUMBER (12)
+#define MAX_SERVO_NUMBER (MCPWM_UNIT_MAX * MCPWM_TIMER_MAX * MCPWM_OPR_MAX)
+#define SERVO_TIMER_FULL ((1U << MCPWM_OPR_MAX) - 1U)
 #define MID_DUTY_CYCLE (50.0)
+#define SERVO_NVS_NAMESPACE ("servo")
+#define SERVO_CAL_KEY_FORMAT ("cal%u") /* Per GPIO */
+#define SERVO_CAL_BLOB_VERSION (1U) /* Change with the speed grid */
 
 /* ____________________________________________________________________________ */
 /* Enum  																		*/
 typedef enum {
     SERVO_CONFIG,
+    SERVO_UNREGISTER,
     SERVO_ORDER,
+    SERVO_EMERGENCY_STOPPED,
+    SERVO_PULSE,
+    SERVO_SET_CALIBRATION,
+    SERVO_GET_CALIBRATION,
 } servoEvent_e;
 
 /* ____________________________________________________________________________ */
@@ -38,44 +59,96 @@ typedef struct {
     bool forwardOrder;
 } servoCommand_t;
 
+typedef struct {
+    int64_t timestampUs;
+} servoStopReport_t;
+
+typedef struct {
+    uint32_t gpio;
+    uint32_t pulseUs;
+} servoPulse_t;
+
+typedef struct {
+    uint32_t gpio;
+    const servoCalibration_t* pSource;
+    servoCalibration_t* pDestination;
+} servoCalibrationRequest_t;
+
+typedef struct {
+    uint16_t version;
+    servoCalibration_t calibration;
+} servoCalibrationBlob_t;
+
 typedef struct {
     servoEvent_e type;
     queueContext_t responseQueue;
     union {
         servoConfig_t config;
         servoCommand_t command;
+        servoStopReport_t stopReport;
+        servoPulse_t pulse;
+        servoCalibrationRequest_t calibration;
     };
 } servoEvent_t;
 
+/* Each timer drives one operator and its two generators (MCPWMxA and MCPWMxB), they share its period */
+typedef struct {
+    uint32_t frequency; /* Meaningless while no output is used */
+    uint8_t usedOutputs; /* One bit per mcpwm_operator_t */
+} servoTimer_t;
+
 typedef struct {
     servoConfig_t config;
     mcpwm_unit_t unit;
+    mcpwm_timer_t timer;
     mcpwm_io_signals_t signal;
     mcpwm_operator_t operator;
+    uint32_t neutralPulseUs;
+    servoCalibration_t calibration;
+    bool parked; /* Output held low: no pulse, the servo is unpowered */
 } servoMapping_t;
 
 /* ____________________________________________________________________________ */
 /* Static prototypes 															*/
 static bool getIndexFromGpio(uint32_t gpio, uint8_t* servoIndex);
+static uint32_t _getFrequency(const servoConfig_t* pConfig);
+static bool _allocateOutput(uint8_t index);
+static void _releaseOutput(const servoMapping_t* pServo);
+static void _notifyOrderHooks(uint32_t gpio, float speed, bool forward, int64_t timestampUs);
+static void _forceNeutral(BaseType_t* pHigherTaskWoken);
+static void _parkOutput(uint8_t index);
+static void _updateOutputsLock(void);
+static bool _writeOutput(uint8_t index, uint32_t pulseUs);
+static uint32_t _lookupPulseUs(const servoCalibration_t* pCalibration, int32_t speedPercentage);
+static void _setLinearCalibration(uint8_t index);
+static bool _isCalibrationValid(uint8_t index, const servoCalibration_t* pCalibration);
+static void _loadCalibration(uint8_t index);
+static bool _storeCalibration(uint8_t index);
+static bool _areAllOutputsParked(void);
+static void _init(void);
+static TickType_t _handleEvent(void* pEvent);
 
 /* ____________________________________________________________________________ */
 /* Static variables 															*/
 static uint8_t _servosNumber = 0;
 static QueueHandle_t _queueForServo = NULL;
-static servoMapping_t _servosList[MAX_SERVO_NUMBER] = {
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM0A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM0B, MCPWM_OPR_B },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM1A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM1B, MCPWM_OPR_B },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM2A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_0, MCPWM2B, MCPWM_OPR_B },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM0A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM0B, MCPWM_OPR_B },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM1A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM1B, MCPWM_OPR_B },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM2A, MCPWM_OPR_A },
-    { { 0xFF, 0.0, 0.0 }, MCPWM_UNIT_1, MCPWM2B, MCPWM_OPR_B },
+static servoOrderHook_t _orderHooks[SERVO_MAX_ORDER_HOOKS] = { NULL };
+static servoStopCallback_t _stopCallback = NULL;
+static portMUX_TYPE _outputsMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool _emergencyStopLatched = false;
+static servoStopStats_t _stopStats = { 0 };
+static pwrLock_t _outputsLock = { 0 };
+static const reactorModule_t _reactorModule = {
+    .name = "Driver servos",
+    .bootModule = BOOT_MODULE_SERVO,
+    .pQueue = &_queueForServo,
+    .queueLength = SERVO_QUEUE_LENGTH,
+    .eventSize = sizeof(servoEvent_t),
+    .init = _init,
+    .handleEvent = _handleEvent,
 };
+static servoMapping_t _servosList[MAX_SERVO_NUMBER] = { 0 }; /* Registered servos first, compacted on unregister */
+static servoTimer_t _timers[MCPWM_UNIT_MAX][MCPWM_TIMER_MAX] = { 0 };
 
 /* ____________________________________________________________________________ */
 /* ISR handlers 																*/
@@ -84,64 +157,12 @@ static servoMapping_t _servosList[MAX_SERVO_NUMBER] = {
 /* Public functions 															*/
 void vSERVO_Process(void* pvParameters)
 {
-    servoEvent_t servoEvent = { 0 };
-    mcpwm_config_t pwm_config;
-    uint8_t index = 0;
-    float dutyCycle = 0.0;
-    float pulseMs = 0.0;
-    bool result = false;
+    vREACTOR_RunModule(&_reactorModule);
+}
 
-    _queueForServo = xQueueCreate(10, sizeof(servoEvent_t));
-
-    for (;;) {
-        if (xQueueReceive(_queueForServo, &servoEvent, portMAX_DELAY) == pdTRUE) {
-            switch (servoEvent.type) {
-            case SERVO_CONFIG:
-                ESP_LOGI(TAG_SERVO, "Register servo %d", _servosNumber);
-                if (_servosNumber < MAX_SERVO_NUMBER) {
-                    memcpy(&_servosList[_servosNumber].config, &servoEvent.config, sizeof(servoEvent.config));
-                    mcpwm_gpio_init(_servosList[_servosNumber].unit,
-                        _servosList[_servosNumber].signal,
-                        servoEvent.config.gpio);
-                    pwm_config.frequency = 1000.0 / (servoEvent.config.maxPulseMs + servoEvent.config.minPulseMs);
-                    pwm_config.cmpr_a = 0; //duty cycle of PWMxA = 0
-                    pwm_config.cmpr_b = 0; //duty cycle of PWMxB = 0
-                    pwm_config.counter_mode = MCPWM_UP_COUNTER;
-                    pwm_config.duty_mode = MCPWM_DUTY_MODE_0;
-                    mcpwm_init(_servosList[_servosNumber].unit, MCPWM_TIMER_0, &pwm_config); //Configure PWM0A & PWM0B with above settings
-                    _servosNumber++;
-                    result = true;
-                } else {
-                    result = false;
-                }
-                vOS_QueueSendSafe(&servoEvent.responseQueue, &result);
-                break;
-            case SERVO_ORDER:
-                if (getIndexFromGpio(servoEvent.command.gpio, &index)) {
-                    result = true;
-                    if (servoEvent.command.forwardOrder) {
-                        dutyCycle = MID_DUTY_CYCLE + (servoEvent.command.speedPercentage / 2.0);
-                    } else {
-                        dutyCycle = MID_DUTY_CYCLE - (servoEvent.command.speedPercentage / 2.0);
-                    }
-                    pulseMs = (_servosList[index].config.maxPulseMs - _servosList[index].config.minPulseMs) * (dutyCycle / 100.0) + _servosList[index].config.minPulseMs;
-                    if (pulseMs > _servosList[index].config.maxPulseMs) {
-                        pulseMs = _servosList[index].config.maxPulseMs;
-                    } else if (pulseMs < _servosList[index].config.minPulseMs) {
-                        pulseMs = _servosList[index].config.minPulseMs;
-                    }
-                    ESP_LOGI(TAG_SERVO, "Execute new order on pin %d: %d %s (%0.2f us)", servoEvent.command.gpio, servoEvent.command.speedPercentage, servoEvent.command.forwardOrder ? "FORWARD" : "BACKWARD", pulseMs);
-                    mcpwm_set_duty_in_us(_servosList[index].unit, MCPWM_TIMER_0, _servosList[index].operator, pulseMs* 1000.0);
-                } else {
-                    result = false;
-                }
-                vOS_QueueSendSafe(&servoEvent.responseQueue, &result);
-                break;
-            default:
-                break;
-            }
-        }
-    }
+const reactorModule_t* pSERVO_GetReactorModule(void)
+{
+    return &_reactorModule;
 }
 
 bool bSERVO_RegisterServo(uint32_t gpio, float minPulseMs, float maxPulseMs)
@@ -159,6 +180,19 @@ bool bSERVO_RegisterServo(uint32_t gpio, float minPulseMs, float maxPulseMs)
     return result;
 }
 
+bool bSERVO_UnregisterServo(uint32_t gpio)
+{
+    bool result = false;
+    servoEvent_t event = { 0 };
+
+    event.type = SERVO_UNREGISTER;
+    event.config.gpio = gpio;
+    if (!bOS_SendToTaskAndWaitResponse(_queueForServo, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_SERVO, "Cannot get response from task");
+    }
+    return result;
+}
+
 bool bSERVO_SetOrder(uint32_t gpio, float speed, bool forward)
 {
     bool result = false;
@@ -168,6 +202,94 @@ bool bSERVO_SetOrder(uint32_t gpio, float speed, bool forward)
     event.command.forwardOrder = forward;
     event.command.gpio = gpio;
     event.command.speedPercentage = speed;
+    TRACE_EVENT(TRACE_ID_QUEUE_POST, BOOT_MODULE_SERVO, event.type);
+    if (!bOS_SendToTaskAndWaitResponse(_queueForServo, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_SERVO, "Cannot get response from task");
+    }
+    return result;
+}
+
+bool bSERVO_RegisterOrderHook(servoOrderHook_t hook)
+{
+    bool result = false;
+
+    /* Hooks are registered at init, before any order is applied */
+    for (uint8_t index = 0; index < SERVO_MAX_ORDER_HOOKS; index++) {
+        if (_orderHooks[index] == NULL) {
+            _orderHooks[index] = hook;
+            result = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+void vSERVO_RegisterEmergencyStopCallback(servoStopCallback_t callback)
+{
+    _stopCallback = callback;
+}
+
+void vSERVO_EmergencyStop(void)
+{
+    _forceNeutral(NULL);
+}
+
+void vSERVO_EmergencyStopFromISR(BaseType_t* pHigherTaskWoken)
+{
+    _forceNeutral(pHigherTaskWoken);
+}
+
+void vSERVO_ReleaseEmergencyStop(void)
+{
+    portENTER_CRITICAL(&_outputsMux);
+    _emergencyStopLatched = false;
+    portEXIT_CRITICAL(&_outputsMux);
+}
+
+void vSERVO_GetEmergencyStopStats(servoStopStats_t* pStats)
+{
+    portENTER_CRITICAL(&_outputsMux);
+    memcpy(pStats, &_stopStats, sizeof(_stopStats));
+    portEXIT_CRITICAL(&_outputsMux);
+}
+
+bool bSERVO_SetPulse(uint32_t gpio, uint32_t pulseUs)
+{
+    bool result = false;
+    servoEvent_t event = { 0 };
+
+    event.type = SERVO_PULSE;
+    event.pulse.gpio = gpio;
+    event.pulse.pulseUs = pulseUs;
+    if (!bOS_SendToTaskAndWaitResponse(_queueForServo, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_SERVO, "Cannot get response from task");
+    }
+    return result;
+}
+
+bool bSERVO_SetCalibration(uint32_t gpio, const servoCalibration_t* pCalibration)
+{
+    bool result = false;
+    servoEvent_t event = { 0 };
+
+    event.type = SERVO_SET_CALIBRATION;
+    event.calibration.gpio = gpio;
+    event.calibration.pSource = pCalibration;
+    if (!bOS_SendToTaskAndWaitResponse(_queueForServo, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
+        ESP_LOGE(TAG_SERVO, "Cannot get response from task");
+    }
+    return result;
+}
+
+bool bSERVO_GetCalibration(uint32_t gpio, servoCalibration_t* pCalibration)
+{
+    bool result = false;
+    servoEvent_t event = { 0 };
+
+    event.type = SERVO_GET_CALIBRATION;
+    event.calibration.gpio = gpio;
+    event.calibration.pDestination = pCalibration;
     if (!bOS_SendToTaskAndWaitResponse(_queueForServo, &event, &event.responseQueue, &result, sizeof(result), TASK_DEFAULT_REPONSE_TIME_TICKS)) {
         ESP_LOGE(TAG_SERVO, "Cannot get response from task");
     }
@@ -180,7 +302,7 @@ static bool getIndexFromGpio(uint32_t gpio, uint8_t* servoIndex)
 {
     bool result = false;
 
-    for (uint8_t index = 0; index < MAX_SERVO_NUMBER; index++) {
+    for (uint8_t index = 0; index < _servosNumber; index++) {
         if (_servosList[index].config.gpio == gpio) {
             *servoIndex = index;
             result = true;
@@ -189,4 +311,395 @@ static bool getIndexFromGpio(uint32_t gpio, uint8_t* servoIndex)
     }
 
     return result;
+}
+
+static uint32_t _getFrequency(const servoConfig_t* pConfig)
+{
+    return 1000.0 / (pConfig->maxPulseMs + pConfig->minPulseMs);
+}
+
+static bool _allocateOutput(uint8_t index)
+{
+    servoMapping_t* pServo = &_servosList[index];
+    uint32_t frequency = _getFrequency(&pServo->config);
+    servoTimer_t* pTimer = NULL;
+    mcpwm_config_t pwmConfig;
+    bool result = false;
+
+    /* A running timer of the same period with a free generator first, a free timer otherwise:
+     * a timer is never reconfigured under the servos it already drives */
+    for (uint8_t pass = 0U; (pass < 2U) && !result; pass++) {
+        for (uint8_t unit = 0U; (unit < MCPWM_UNIT_MAX) && !result; unit++) {
+            for (uint8_t timer = 0U; (timer < MCPWM_TIMER_MAX) && !result; timer++) {
+                pTimer = &_timers[unit][timer];
+                if (pass == 0U) {
+                    result = (pTimer->usedOutputs != 0U) && (pTimer->usedOutputs != SERVO_TIMER_FULL) && (pTimer->frequency == frequency);
+                } else {
+                    result = (pTimer->usedOutputs == 0U);
+                }
+                if (result) {
+                    pServo->unit = (mcpwm_unit_t)unit;
+                    pServo->timer = (mcpwm_timer_t)timer;
+                }
+            }
+        }
+    }
+
+    if (result) {
+        pTimer = &_timers[pServo->unit][pServo->timer];
+        pServo->operator = (pTimer->usedOutputs & (1U << MCPWM_OPR_A)) ? MCPWM_OPR_B : MCPWM_OPR_A;
+        pServo->signal = (mcpwm_io_signals_t)((pServo->timer * MCPWM_OPR_MAX) + pServo->operator);
+        if (pTimer->usedOutputs == 0U) {
+            pwmConfig.frequency = frequency;
+            pwmConfig.cmpr_a = 0; //duty cycle of PWMxA = 0
+            pwmConfig.cmpr_b = 0; //duty cycle of PWMxB = 0
+            pwmConfig.counter_mode = MCPWM_UP_COUNTER;
+            pwmConfig.duty_mode = MCPWM_DUTY_MODE_0;
+            mcpwm_init(pServo->unit, pServo->timer, &pwmConfig);
+            pTimer->frequency = frequency;
+        }
+        pTimer->usedOutputs |= (1U << pServo->operator);
+        /* Generator low before the pin is routed to it: no pulse left over from a previous servo */
+        _parkOutput(index);
+        mcpwm_gpio_init(pServo->unit, pServo->signal, pServo->config.gpio);
+        ESP_LOGI(TAG_SERVO, "Servo on pin %u: unit %u timer %u operator %u, %u Hz", pServo->config.gpio, pServo->unit, pServo->timer, pServo->operator, frequency);
+    } else {
+        ESP_LOGE(TAG_SERVO, "No MCPWM output left for a servo at %u Hz", frequency);
+    }
+
+    return result;
+}
+
+static void _releaseOutput(const servoMapping_t* pServo)
+{
+    servoTimer_t* pTimer = &_timers[pServo->unit][pServo->timer];
+
+    pTimer->usedOutputs &= ~(1U << pServo->operator);
+    if (pTimer->usedOutputs == 0U) {
+        /* Free again for any frequency */
+        mcpwm_stop(pServo->unit, pServo->timer);
+    }
+    /* Back to a plain input: the pin keeps no route to a generator another servo may get */
+    gpio_reset_pin(pServo->config.gpio);
+}
+
+static void _notifyOrderHooks(uint32_t gpio, float speed, bool forward, int64_t timestampUs)
+{
+    for (uint8_t index = 0; index < SERVO_MAX_ORDER_HOOKS; index++) {
+        if (_orderHooks[index] != NULL) {
+            _orderHooks[index](gpio, speed, forward, timestampUs);
+        }
+    }
+}
+
+static void _forceNeutral(BaseType_t* pHigherTaskWoken)
+{
+    servoEvent_t event = { 0 };
+    int64_t startUs = esp_timer_get_time();
+    uint32_t latencyUs = 0U;
+
+    /* Bounded section: at most MAX_SERVO_NUMBER register writes, no allocation nor blocking call */
+    portENTER_CRITICAL_ISR(&_outputsMux);
+    _emergencyStopLatched = true;
+    for (uint8_t index = 0; index < _servosNumber; index++) {
+        mcpwm_set_duty_in_us(_servosList[index].unit, _servosList[index].timer, _servosList[index].operator, _servosList[index].neutralPulseUs);
+    }
+    latencyUs = (uint32_t)(esp_timer_get_time() - startUs);
+    _stopStats.stopCount++;
+    _stopStats.lastLatencyUs = latencyUs;
+    if (latencyUs > _stopStats.worstLatencyUs) {
+        _stopStats.worstLatencyUs = latencyUs;
+    }
+    if (latencyUs > SERVO_EMERGENCY_STOP_BUDGET_US) {
+        _stopStats.overrunCount++;
+    }
+    portEXIT_CRITICAL_ISR(&_outputsMux);
+    TRACE_EVENT(TRACE_ID_EMERGENCY_STOP, _servosNumber, latencyUs);
+    for (uint8_t index = 0; index < _servosNumber; index++) {
+        ILOG_SERVO(_servosList[index].config.gpio, _servosList[index].neutralPulseUs);
+    }
+
+    /* Report to servo task (hooks, log) and to upper layer */
+    event.type = SERVO_EMERGENCY_STOPPED;
+    event.stopReport.timestampUs = startUs + latencyUs;
+    if (_queueForServo != NULL) {
+        if (pHigherTaskWoken != NULL) {
+            bOS_QueueSendToFrontFromISR(_queueForServo, &event, pHigherTaskWoken);
+        } else {
+            bOS_QueueSendToFront(_queueForServo, &event, 0U);
+        }
+    }
+    if (_stopCallback != NULL) {
+        _stopCallback(pHigherTaskWoken);
+    }
+}
+
+static void _parkOutput(uint8_t index)
+{
+    mcpwm_set_signal_low(_servosList[index].unit, _servosList[index].timer, _servosList[index].operator);
+    _servosList[index].parked = true;
+}
+
+static void _updateOutputsLock(void)
+{
+    bool moving = false;
+
+    for (uint8_t index = 0; index < _servosNumber; index++) {
+        moving |= !_servosList[index].parked;
+    }
+    /* Light sleep would stretch the pulses of a running servo */
+    if (moving) {
+        vPWR_AcquireLock(&_outputsLock);
+    } else {
+        vPWR_ReleaseLock(&_outputsLock);
+    }
+}
+
+static bool _writeOutput(uint8_t index, uint32_t pulseUs)
+{
+    bool result = false;
+
+    /* Full speed clock before the pulse changes, so that it is not stretched by a frequency switch */
+    if (pulseUs > 0U) {
+        vPWR_AcquireLock(&_outputsLock);
+    }
+    /* Outputs are not touched anymore once an emergency stop has been latched */
+    portENTER_CRITICAL(&_outputsMux);
+    result = !_emergencyStopLatched;
+    if (result && (pulseUs == 0U)) {
+        /* A stopped servo is parked rather than held at neutral: no pulse, no drift, no current */
+        _parkOutput(index);
+    } else if (result) {
+        mcpwm_set_duty_in_us(_servosList[index].unit, _servosList[index].timer, _servosList[index].operator, pulseUs);
+        if (_servosList[index].parked) {
+            mcpwm_set_duty_type(_servosList[index].unit, _servosList[index].timer, _servosList[index].operator, MCPWM_DUTY_MODE_0);
+            _servosList[index].parked = false;
+        }
+    }
+    portEXIT_CRITICAL(&_outputsMux);
+    _updateOutputsLock();
+    if (result) {
+        ILOG_SERVO(_servosList[index].config.gpio, pulseUs);
+    }
+
+    return result;
+}
+
+static uint32_t _lookupPulseUs(const servoCalibration_t* pCalibration, int32_t speedPercentage)
+{
+    /* Uniform speed grid: the segment comes from a division, no search */
+    uint32_t position = (uint32_t)(speedPercentage + 100);
+    uint32_t point = position / SERVO_CAL_STEP_PERCENT;
+    uint32_t fraction = position % SERVO_CAL_STEP_PERCENT;
+    int32_t result = pCalibration->pulseUs[point];
+
+    if (fraction > 0U) {
+        result += ((int32_t)pCalibration->pulseUs[point + 1U] - result) * (int32_t)fraction / (int32_t)SERVO_CAL_STEP_PERCENT;
+    }
+
+    return (uint32_t)result;
+}
+
+static void _setLinearCalibration(uint8_t index)
+{
+    servoConfig_t* pConfig = &_servosList[index].config;
+    float dutyCycle = 0.0;
+
+    /* Uncalibrated servos keep the linear relation, symmetric around the middle pulse */
+    for (uint8_t point = 0U; point < SERVO_CAL_POINTS; point++) {
+        dutyCycle = MID_DUTY_CYCLE + (((int32_t)(point * SERVO_CAL_STEP_PERCENT) - 100) / 2.0);
+        _servosList[index].calibration.pulseUs[point] = (pConfig->maxPulseMs - pConfig->minPulseMs) * (dutyCycle / 100.0) * 1000.0 + pConfig->minPulseMs * 1000U;
+    }
+}
+
+static bool _isCalibrationValid(uint8_t index, const servoCalibration_t* pCalibration)
+{
+    bool result = true;
+
+    for (uint8_t point = 0U; (point < SERVO_CAL_POINTS) && result; point++) {
+        result = (pCalibration->pulseUs[point] >= (_servosList[index].config.minPulseMs * 1000U))
+            && (pCalibration->pulseUs[point] <= (_servosList[index].config.maxPulseMs * 1000U))
+            && ((point == 0U) || (pCalibration->pulseUs[point] >= pCalibration->pulseUs[point - 1U]));
+    }
+
+    return result;
+}
+
+static void _loadCalibration(uint8_t index)
+{
+    servoCalibrationBlob_t blob = { 0 };
+    size_t length = sizeof(blob);
+    nvs_handle_t handle;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    bool loaded = false;
+
+    snprintf(key, sizeof(key), SERVO_CAL_KEY_FORMAT, _servosList[index].config.gpio);
+    if (nvs_open(SERVO_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        loaded = (nvs_get_blob(handle, key, &blob, &length) == ESP_OK) && (length == sizeof(blob))
+            && (blob.version == SERVO_CAL_BLOB_VERSION) && _isCalibrationValid(index, &blob.calibration);
+        nvs_close(handle);
+    }
+    if (loaded) {
+        memcpy(&_servosList[index].calibration, &blob.calibration, sizeof(blob.calibration));
+    } else {
+        _setLinearCalibration(index);
+    }
+    _servosList[index].neutralPulseUs = _servosList[index].calibration.pulseUs[SERVO_CAL_NEUTRAL_INDEX];
+    ESP_LOGI(TAG_SERVO, "Servo on pin %u: %s, neutral %u us", _servosList[index].config.gpio, loaded ? "calibrated" : "linear", _servosList[index].neutralPulseUs);
+}
+
+static bool _storeCalibration(uint8_t index)
+{
+    servoCalibrationBlob_t blob = { 0 };
+    nvs_handle_t handle;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    bool result = false;
+
+    blob.version = SERVO_CAL_BLOB_VERSION;
+    memcpy(&blob.calibration, &_servosList[index].calibration, sizeof(blob.calibration));
+    snprintf(key, sizeof(key), SERVO_CAL_KEY_FORMAT, _servosList[index].config.gpio);
+    if (nvs_open(SERVO_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        result = (nvs_set_blob(handle, key, &blob, sizeof(blob)) == ESP_OK) && (nvs_commit(handle) == ESP_OK);
+        nvs_close(handle);
+    }
+
+    return result;
+}
+
+static bool _areAllOutputsParked(void)
+{
+    bool result = true;
+
+    for (uint8_t index = 0; index < _servosNumber; index++) {
+        result &= _servosList[index].parked;
+    }
+
+    return result;
+}
+
+static void _init(void)
+{
+    _queueForServo = OS_QUEUE_CREATE("Queue servo", SERVO_QUEUE_LENGTH, sizeof(servoEvent_t));
+    vPWR_CreateLock(&_outputsLock, "servo");
+}
+
+static TickType_t _handleEvent(void* pEvent)
+{
+    servoEvent_t* pServoEvent = (servoEvent_t*)pEvent;
+    servoMapping_t released;
+    uint8_t index = 0;
+    uint32_t pulseUs = 0U;
+    int32_t speed = 0;
+    bool result = false;
+
+    switch (pServoEvent->type) {
+    case SERVO_CONFIG:
+        /* Checked before any resource is taken: a refused servo leaves the others untouched */
+        result = (_servosNumber < MAX_SERVO_NUMBER) && !getIndexFromGpio(pServoEvent->config.gpio, &index)
+            && (pServoEvent->config.minPulseMs > 0U) && (pServoEvent->config.minPulseMs < pServoEvent->config.maxPulseMs);
+        if (result) {
+            memcpy(&_servosList[_servosNumber].config, &pServoEvent->config, sizeof(pServoEvent->config));
+            result = _allocateOutput(_servosNumber);
+        }
+        if (result) {
+            _loadCalibration(_servosNumber);
+            _servosNumber++;
+        } else {
+            ESP_LOGE(TAG_SERVO, "Servo on pin %u refused", pServoEvent->config.gpio);
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_UNREGISTER:
+        result = getIndexFromGpio(pServoEvent->config.gpio, &index);
+        if (result) {
+            memcpy(&released, &_servosList[index], sizeof(released));
+            /* The stop path walks the list from interrupts: park and compact in one section */
+            portENTER_CRITICAL(&_outputsMux);
+            _parkOutput(index);
+            _servosNumber--;
+            if (index != _servosNumber) {
+                memcpy(&_servosList[index], &_servosList[_servosNumber], sizeof(_servosList[index]));
+            }
+            portEXIT_CRITICAL(&_outputsMux);
+            _releaseOutput(&released);
+            _updateOutputsLock();
+            if (!released.parked) {
+                _notifyOrderHooks(released.config.gpio, 0.0, true, esp_timer_get_time());
+            }
+            ESP_LOGI(TAG_SERVO, "Servo on pin %u unregistered", released.config.gpio);
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_ORDER:
+        if (getIndexFromGpio(pServoEvent->command.gpio, &index)) {
+            speed = (pServoEvent->command.speedPercentage < 100U) ? (int32_t)pServoEvent->command.speedPercentage : 100;
+            pulseUs = (speed == 0) ? 0U : _lookupPulseUs(&_servosList[index].calibration, pServoEvent->command.forwardOrder ? speed : -speed);
+            result = _writeOutput(index, pulseUs);
+            if (result) {
+                DLN_STAMP(DLN_STAGE_SERVO_WRITE);
+                TRACE_EVENT(TRACE_ID_SERVO_WRITE, pServoEvent->command.gpio, pulseUs);
+                DLOGI(TAG_SERVO, "Execute new order on pin %u: %u%% %s (%u us)", pServoEvent->command.gpio, (uint32_t)pServoEvent->command.speedPercentage, pServoEvent->command.forwardOrder ? "FORWARD" : "BACKWARD", pulseUs);
+                _notifyOrderHooks(pServoEvent->command.gpio, pServoEvent->command.speedPercentage, pServoEvent->command.forwardOrder, esp_timer_get_time());
+            } else {
+                DLOGW(TAG_SERVO, "Order on pin %u dropped, emergency stop latched", pServoEvent->command.gpio);
+            }
+        } else {
+            result = false;
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_PULSE:
+        /* Raw output for calibration sweeps: no table, no order hooks, the pose tracker does not follow */
+        result = getIndexFromGpio(pServoEvent->pulse.gpio, &index)
+            && ((pServoEvent->pulse.pulseUs == 0U)
+                || ((pServoEvent->pulse.pulseUs >= (_servosList[index].config.minPulseMs * 1000U))
+                    && (pServoEvent->pulse.pulseUs <= (_servosList[index].config.maxPulseMs * 1000U))))
+            && _writeOutput(index, pServoEvent->pulse.pulseUs);
+        if (result) {
+            TRACE_EVENT(TRACE_ID_SERVO_WRITE, pServoEvent->pulse.gpio, pServoEvent->pulse.pulseUs);
+            DLOGI(TAG_SERVO, "Raw pulse on pin %u: %u us", pServoEvent->pulse.gpio, pServoEvent->pulse.pulseUs);
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_SET_CALIBRATION:
+        /* Only while every output is parked: a table never changes under a running order. The table is read from
+         * the requester, only while it still waits */
+        result = bOS_IsResponseAwaited(&pServoEvent->responseQueue) && getIndexFromGpio(pServoEvent->calibration.gpio, &index)
+            && _areAllOutputsParked() && _isCalibrationValid(index, pServoEvent->calibration.pSource);
+        if (result) {
+            memcpy(&_servosList[index].calibration, pServoEvent->calibration.pSource, sizeof(servoCalibration_t));
+            _servosList[index].neutralPulseUs = _servosList[index].calibration.pulseUs[SERVO_CAL_NEUTRAL_INDEX];
+            result = _storeCalibration(index);
+            ESP_LOGI(TAG_SERVO, "Calibration of pin %u set, neutral %u us%s", pServoEvent->calibration.gpio, _servosList[index].neutralPulseUs, result ? "" : ", not stored");
+        } else {
+            ESP_LOGW(TAG_SERVO, "Calibration of pin %u rejected", pServoEvent->calibration.gpio);
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_GET_CALIBRATION:
+        /* Requester buffer is gone once it stopped waiting */
+        result = bOS_IsResponseAwaited(&pServoEvent->responseQueue) && getIndexFromGpio(pServoEvent->calibration.gpio, &index);
+        if (result) {
+            memcpy(pServoEvent->calibration.pDestination, &_servosList[index].calibration, sizeof(servoCalibration_t));
+        }
+        vOS_QueueSendSafe(&pServoEvent->responseQueue, &result);
+        break;
+    case SERVO_EMERGENCY_STOPPED:
+        /* Neutral was the fastest safe output from the stop context, park now that motion is over */
+        portENTER_CRITICAL(&_outputsMux);
+        for (index = 0; index < _servosNumber; index++) {
+            _parkOutput(index);
+        }
+        portEXIT_CRITICAL(&_outputsMux);
+        _updateOutputsLock();
+        for (index = 0; index < _servosNumber; index++) {
+            _notifyOrderHooks(_servosList[index].config.gpio, 0.0, true, pServoEvent->stopReport.timestampUs);
+        }
+        DLOGW(TAG_SERVO, "Emergency stop in %u us (worst %u us, %u overruns)", _stopStats.lastLatencyUs, _stopStats.worstLatencyUs, _stopStats.overrunCount);
+        break;
+    default:
+        break;
+    }
+
+    return portMAX_DELAY;
 }
\ No newline at end of file
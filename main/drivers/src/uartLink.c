@@ -0,0 +1,314 @@
+/**
+*******************************************************************************
+* @file 	uartLink.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+/* ____________________________________________________________________________ */
+/* Includes  																	*/
+#include "uartLink.h"
+#include "driver/uart.h"
+#include "mapping.h"
+#include "power.h"
+
+/* ____________________________________________________________________________ */
+/* Defines  																	*/
+#define TAG_LINK ("LINK")
+#define LINK_UART_NUM (UART_NUM_1)
+#define LINK_RX_RING_MASK (LINK_RX_RING_SIZE - 1U)
+#define LINK_CRC_INIT (0xFFFFU)
+#define LINK_IDLE_TIMEOUT_TICKS (pdMS_TO_TICKS(LINK_IDLE_TIMEOUT_MS))
+
+/* ____________________________________________________________________________ */
+/* Enum  																		*/
+
+/* ____________________________________________________________________________ */
+/* Struct																		*/
+
+/* ____________________________________________________________________________ */
+/* Static prototypes 															*/
+static void _fillRing(void);
+static bool _parseFrame(linkFrame_t* pFrame);
+static uint16_t _crc16(uint16_t crc, uint8_t byte);
+static TickType_t _remainingTicks(TickType_t startTicks, TickType_t timeout);
+static void _count(uint32_t* pCounter, uint32_t value);
+static void _keepAwake(void);
+
+/* ____________________________________________________________________________ */
+/* Static variables 															*/
+static const uint16_t _crcNibbleTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+static uint8_t _rxRing[LINK_RX_RING_SIZE] = { 0 };
+static uint32_t _rxHead = 0U; /* Free running, next byte written */
+static uint32_t _rxTail = 0U; /* Free running, first byte not parsed yet */
+static uint32_t _rxPendingRelease = 0U; /* Size of the frame handed to the reader */
+static QueueHandle_t _uartEventQueue = NULL;
+static linkStats_t _stats = { 0 };
+static portMUX_TYPE _statsMux = portMUX_INITIALIZER_UNLOCKED;
+static pwrLock_t _linkLock = { 0 };
+static TickType_t _lastTrafficTicks = 0U;
+
+_Static_assert((LINK_RX_RING_SIZE & LINK_RX_RING_MASK) == 0U, "Ring size must be a power of two");
+_Static_assert(LINK_RX_RING_SIZE >= (2U * LINK_MAX_FRAME_SIZE), "Ring must hold a frame being read and the next one");
+_Static_assert(LINK_MAX_FRAME_SIZE <= UART_FIFO_LEN, "A frame is written to the TX FIFO at once");
+
+/* ____________________________________________________________________________ */
+/* ISR handlers 																*/
+
+/* ____________________________________________________________________________ */
+/* Public functions 															*/
+void vLINK_Init(void)
+{
+    uart_config_t uartConfig = {
+        .baud_rate = LINK_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .use_ref_tick = true,
+    };
+
+    /* REF_TICK keeps the baud rate under frequency scaling. Light sleep stops the UART: the lock is held from the first
+     * byte received or frame sent until the link has been idle for LINK_IDLE_TIMEOUT_MS */
+    vPWR_CreateLock(&_linkLock, "link");
+
+    uart_param_config(LINK_UART_NUM, &uartConfig);
+    uart_set_pin(LINK_UART_NUM, LINK_TX_GPIO_NUM, LINK_RX_GPIO_NUM, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    /* No TX buffer: a frame fits in the FIFO and is written once the previous one is out */
+    if (uart_driver_install(LINK_UART_NUM, LINK_DRIVER_RX_BUFFER_SIZE, 0, LINK_EVENT_QUEUE_LENGTH, &_uartEventQueue, 0) != ESP_OK) {
+        ESP_LOGE(TAG_LINK, "Cannot install UART driver");
+    }
+    /* Client requests sent to a sleeping chip are lost and repeated, the first one wakes it up */
+    vPWR_ArmUartWakeup(LINK_UART_NUM, LINK_WAKEUP_THRESHOLD);
+    vOS_RegisterRamUsage("Link RX ring", sizeof(_rxRing));
+}
+
+bool bLINK_Receive(linkFrame_t* pFrame, TickType_t timeout)
+{
+    TickType_t startTicks = xTaskGetTickCount();
+    TickType_t waitTicks = 0U;
+    TickType_t idleTicks = 0U;
+    uart_event_t event;
+    bool result = false;
+    bool waiting = true;
+
+    /* Previous frame is not read anymore, its bytes can be overwritten */
+    _rxTail += _rxPendingRelease;
+    _rxPendingRelease = 0U;
+
+    _fillRing();
+    result = _parseFrame(pFrame);
+    while (!result && waiting && (_uartEventQueue != NULL)) {
+        /* While the lock is held, the wait is cut at the end of the idle timeout to release it */
+        waitTicks = _remainingTicks(startTicks, timeout);
+        idleTicks = _linkLock.held ? _remainingTicks(_lastTrafficTicks, LINK_IDLE_TIMEOUT_TICKS) : portMAX_DELAY;
+        if (xQueueReceive(_uartEventQueue, &event, (idleTicks < waitTicks) ? idleTicks : waitTicks) != pdTRUE) {
+            if (idleTicks < waitTicks) {
+                vPWR_ReleaseLock(&_linkLock);
+            } else {
+                waiting = false;
+            }
+            continue;
+        }
+        _keepAwake();
+        switch (event.type) {
+        case UART_DATA:
+            _fillRing();
+            result = _parseFrame(pFrame);
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            /* Partial frames left are skipped by the parser */
+            _count(&_stats.rxOverflows, 1U);
+            uart_flush_input(LINK_UART_NUM);
+            xQueueReset(_uartEventQueue);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return result;
+}
+
+bool bLINK_Send(uint8_t type, uint8_t sequence, const uint8_t* pPayload, uint8_t length, TickType_t timeout)
+{
+    uint8_t frame[LINK_MAX_FRAME_SIZE];
+    uint32_t frameSize = LINK_FRAME_HEADER_SIZE + length + LINK_FRAME_CRC_SIZE;
+    uint16_t crc = LINK_CRC_INIT;
+    bool result = (length <= LINK_MAX_PAYLOAD_SIZE);
+
+    /* Held until the frame is out, the idle timeout is far longer than a frame */
+    _keepAwake();
+    if (result && (uart_wait_tx_done(LINK_UART_NUM, timeout) != ESP_OK)) {
+        _count(&_stats.txDropped, 1U);
+        result = false;
+    }
+    if (result) {
+        frame[0] = LINK_FRAME_START;
+        frame[1] = length;
+        frame[2] = type;
+        frame[3] = sequence;
+        memcpy(&frame[LINK_FRAME_HEADER_SIZE], pPayload, length);
+        for (uint32_t index = 1U; index < (LINK_FRAME_HEADER_SIZE + length); index++) {
+            crc = _crc16(crc, frame[index]);
+        }
+        frame[LINK_FRAME_HEADER_SIZE + length] = (uint8_t)(crc & 0xFFU);
+        frame[LINK_FRAME_HEADER_SIZE + length + 1U] = (uint8_t)(crc >> 8);
+        result = (uart_write_bytes(LINK_UART_NUM, (const char*)frame, frameSize) == (int)frameSize);
+    }
+    if (result) {
+        _count(&_stats.txFrames, 1U);
+    }
+
+    return result;
+}
+
+uint8_t u8LINK_GetByte(const linkView_t* pView, uint8_t offset)
+{
+    uint8_t result = 0U;
+
+    if (offset < pView->firstLength) {
+        result = pView->pFirst[offset];
+    } else if (offset < pView->length) {
+        result = pView->pSecond[offset - pView->firstLength];
+    }
+
+    return result;
+}
+
+uint16_t u16LINK_GetUint16(const linkView_t* pView, uint8_t offset)
+{
+    /* Little endian on the wire */
+    return (uint16_t)u8LINK_GetByte(pView, offset) | ((uint16_t)u8LINK_GetByte(pView, offset + 1U) << 8);
+}
+
+void vLINK_GetStats(linkStats_t* pStats)
+{
+    portENTER_CRITICAL(&_statsMux);
+    memcpy(pStats, &_stats, sizeof(_stats));
+    portEXIT_CRITICAL(&_statsMux);
+}
+
+/* ____________________________________________________________________________ */
+/* Static functions 															*/
+static void _fillRing(void)
+{
+    size_t bufferedLength = 0U;
+    uint32_t freeLength = 0U;
+    uint32_t contiguousLength = 0U;
+    int readLength = 0;
+
+    uart_get_buffered_data_len(LINK_UART_NUM, &bufferedLength);
+    /* Bytes go straight from the driver buffer to their place in the ring, at most two reads when wrapping */
+    for (uint8_t part = 0U; (part < 2U) && (bufferedLength > 0U); part++) {
+        freeLength = LINK_RX_RING_SIZE - (_rxHead - _rxTail);
+        contiguousLength = LINK_RX_RING_SIZE - (_rxHead & LINK_RX_RING_MASK);
+        if (contiguousLength > freeLength) {
+            contiguousLength = freeLength;
+        }
+        if (contiguousLength > bufferedLength) {
+            contiguousLength = bufferedLength;
+        }
+        readLength = (contiguousLength > 0U) ? uart_read_bytes(LINK_UART_NUM, &_rxRing[_rxHead & LINK_RX_RING_MASK], contiguousLength, 0U) : 0;
+        if (readLength <= 0) {
+            break;
+        }
+        _rxHead += (uint32_t)readLength;
+        bufferedLength -= (uint32_t)readLength;
+    }
+}
+
+static bool _parseFrame(linkFrame_t* pFrame)
+{
+    uint32_t available = _rxHead - _rxTail;
+    uint32_t skipped = 0U;
+    uint32_t crcErrors = 0U;
+    uint32_t payloadStart = 0U;
+    uint16_t crc = LINK_CRC_INIT;
+    uint8_t length = 0U;
+    bool result = false;
+
+    while (!result && (available >= (LINK_FRAME_HEADER_SIZE + LINK_FRAME_CRC_SIZE))) {
+        length = _rxRing[(_rxTail + 1U) & LINK_RX_RING_MASK];
+        if ((_rxRing[_rxTail & LINK_RX_RING_MASK] != LINK_FRAME_START) || (length > LINK_MAX_PAYLOAD_SIZE)) {
+            skipped++;
+        } else if (available < (uint32_t)(LINK_FRAME_HEADER_SIZE + length + LINK_FRAME_CRC_SIZE)) {
+            /* Rest of the frame not received yet */
+            break;
+        } else {
+            crc = LINK_CRC_INIT;
+            for (uint32_t index = 1U; index < (LINK_FRAME_HEADER_SIZE + length); index++) {
+                crc = _crc16(crc, _rxRing[(_rxTail + index) & LINK_RX_RING_MASK]);
+            }
+            if ((_rxRing[(_rxTail + LINK_FRAME_HEADER_SIZE + length) & LINK_RX_RING_MASK] == (uint8_t)(crc & 0xFFU))
+                && (_rxRing[(_rxTail + LINK_FRAME_HEADER_SIZE + length + 1U) & LINK_RX_RING_MASK] == (uint8_t)(crc >> 8))) {
+                pFrame->type = _rxRing[(_rxTail + 2U) & LINK_RX_RING_MASK];
+                pFrame->sequence = _rxRing[(_rxTail + 3U) & LINK_RX_RING_MASK];
+                payloadStart = (_rxTail + LINK_FRAME_HEADER_SIZE) & LINK_RX_RING_MASK;
+                pFrame->payload.pFirst = &_rxRing[payloadStart];
+                pFrame->payload.pSecond = &_rxRing[0];
+                pFrame->payload.length = length;
+                pFrame->payload.firstLength = ((payloadStart + length) > LINK_RX_RING_SIZE) ? (uint8_t)(LINK_RX_RING_SIZE - payloadStart) : length;
+                _rxPendingRelease = LINK_FRAME_HEADER_SIZE + length + LINK_FRAME_CRC_SIZE;
+                result = true;
+            } else {
+                /* Resynchronize on the next start byte, it may be inside this frame */
+                crcErrors++;
+                skipped++;
+            }
+        }
+        if (!result) {
+            _rxTail++;
+            available--;
+        }
+    }
+
+    _count(&_stats.skippedBytes, skipped);
+    _count(&_stats.crcErrors, crcErrors);
+    if (result) {
+        _count(&_stats.rxFrames, 1U);
+    }
+
+    return result;
+}
+
+static uint16_t _crc16(uint16_t crc, uint8_t byte)
+{
+    crc = (uint16_t)(crc << 4) ^ _crcNibbleTable[(crc >> 12) ^ (byte >> 4)];
+    crc = (uint16_t)(crc << 4) ^ _crcNibbleTable[(crc >> 12) ^ (byte & 0x0FU)];
+    return crc;
+}
+
+static TickType_t _remainingTicks(TickType_t startTicks, TickType_t timeout)
+{
+    TickType_t elapsedTicks = xTaskGetTickCount() - startTicks;
+    TickType_t result = 0U;
+
+    if (timeout == portMAX_DELAY) {
+        result = portMAX_DELAY;
+    } else if (elapsedTicks < timeout) {
+        result = timeout - elapsedTicks;
+    }
+
+    return result;
+}
+
+static void _count(uint32_t* pCounter, uint32_t value)
+{
+    if (value > 0U) {
+        portENTER_CRITICAL(&_statsMux);
+        *pCounter += value;
+        portEXIT_CRITICAL(&_statsMux);
+    }
+}
+
+static void _keepAwake(void)
+{
+    vPWR_AcquireLock(&_linkLock);
+    _lastTrafficTicks = xTaskGetTickCount();
+}
@@ -0,0 +1,38 @@
+/**
+******************************************************************************
+* @file 	boot.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+#include "system_def.h"
+
+#define BOOT_DEPENDENCY_TIMEOUT_TICKS (pdMS_TO_TICKS(1000U))
+
+typedef enum {
+    /* Stage 0: drivers, initialized in parallel */
+    BOOT_MODULE_BUTTONS = 0,
+    BOOT_MODULE_SERVO,
+    BOOT_MODULE_LEDS,
+    /* Stage 1 and above: managers, see dependency table in boot.c */
+    BOOT_MODULE_MOVEMENT_MANAGER,
+    BOOT_MODULE_SEQUENCE_MANAGER,
+    BOOT_MODULE_BUTTONS_MANAGER,
+    /* Do not erase */
+    BOOT_MODULE_NUMBER
+} bootModule_e;
+
+void vBOOT_Init(void);
+
+/* False on timeout or when a dependency is degraded: the module is then marked degraded */
+bool bBOOT_WaitDependencies(bootModule_e module);
+
+void vBOOT_SignalReady(bootModule_e module);
+
+bool bBOOT_WaitAllReady(TickType_t timeout);
+
+#endif //__BOOT_H__
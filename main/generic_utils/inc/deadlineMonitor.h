@@ -0,0 +1,78 @@
+/**
+******************************************************************************
+* @file 	deadlineMonitor.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __DEADLINEMONITOR_H__
+#define __DEADLINEMONITOR_H__
+
+#include "system_def.h"
+
+/* Stamps are compiled out with the monitor */
+#if SYSTEM_DEADLINE_MONITOR_ENABLED
+#define DLN_STAMP(stage) vDLN_Stamp(stage)
+#define DLN_STAMP_FROM_ISR(stage) vDLN_StampFromISR(stage)
+#define DLN_ABANDON() vDLN_Abandon()
+#else
+#define DLN_STAMP(stage) \
+    do {                 \
+    } while (false)
+#define DLN_STAMP_FROM_ISR(stage) \
+    do {                          \
+    } while (false)
+#define DLN_ABANDON() \
+    do {              \
+    } while (false)
+#endif
+
+/* Pipeline stages, hop budget applies between a stage and the previous one of its chain */
+typedef enum {
+    DLN_STAGE_ISR_EDGE = 0, /* Starts an input to motion chain */
+    DLN_STAGE_BUTTON_TASK,
+    DLN_STAGE_BUTTON_MANAGER,
+    DLN_STAGE_MOVEMENT_END, /* Starts a step transition chain */
+    DLN_STAGE_SEQUENCE_MANAGER,
+    DLN_STAGE_MOVEMENT_MANAGER,
+    DLN_STAGE_SERVO_WRITE, /* Ends both chains */
+    /* Do not erase */
+    DLN_STAGE_NUMBER
+} dlnStage_e;
+
+typedef enum {
+    DLN_CHAIN_INPUT_TO_MOTION = 0, /* Button edge to first servo write */
+    DLN_CHAIN_STEP_TRANSITION, /* End of a sequence step to first servo write of the next one */
+    /* Do not erase */
+    DLN_CHAIN_NUMBER
+} dlnChain_e;
+
+typedef struct {
+    uint32_t budgetUs;
+    uint32_t count;
+    uint32_t missCount;
+    uint32_t lastUs;
+    uint32_t worstUs;
+    uint32_t histogram[DLN_HISTOGRAM_BUCKETS]; /* Bucket n counts [2^n, 2^(n+1)) us, last one is open ended */
+} dlnLatencyStats_t;
+
+/* One chain is tracked at a time, a new chain start replaces the one in flight */
+void vDLN_Stamp(dlnStage_e stage);
+
+void vDLN_StampFromISR(dlnStage_e stage);
+
+/* Chain in flight does not lead to a servo write (no trigger, sequence edition, end of sequence) */
+void vDLN_Abandon(void);
+
+void vDLN_GetHopStats(dlnStage_e stage, dlnLatencyStats_t* pStats);
+
+void vDLN_GetChainStats(dlnChain_e chain, dlnLatencyStats_t* pStats);
+
+void vDLN_ResetStats(void);
+
+void vDLN_PrintStats(void);
+
+void vDLN_StartStatsDump(TickType_t period);
+
+#endif //__DEADLINEMONITOR_H__
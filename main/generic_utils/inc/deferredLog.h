@@ -0,0 +1,70 @@
+/**
+******************************************************************************
+* @file 	deferredLog.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __DEFERREDLOG_H__
+#define __DEFERREDLOG_H__
+
+#include "system_def.h"
+
+#define DLOG_MAX_ARGS (4U)
+
+/* Per module compile time level: define DLOG_LOCAL_LEVEL before any include, logs above it are compiled out */
+#ifndef DLOG_LOCAL_LEVEL
+#define DLOG_LOCAL_LEVEL (ESP_LOG_INFO)
+#endif
+
+#define _DLOG_NARGS(_0, _1, _2, _3, _4, _5, N, ...) N
+#define DLOG_NARGS(...) _DLOG_NARGS(0, ##__VA_ARGS__, 5, 4, 3, 2, 1, 0)
+
+/* Every argument travels as an uintptr_t, whatever its type */
+#define _DLOG_ARG(arg) ((uintptr_t)(arg))
+#define _DLOG_ARGS_0()
+#define _DLOG_ARGS_1(a) , _DLOG_ARG(a)
+#define _DLOG_ARGS_2(a, b) , _DLOG_ARG(a), _DLOG_ARG(b)
+#define _DLOG_ARGS_3(a, b, c) , _DLOG_ARG(a), _DLOG_ARG(b), _DLOG_ARG(c)
+#define _DLOG_ARGS_4(a, b, c, d) , _DLOG_ARG(a), _DLOG_ARG(b), _DLOG_ARG(c), _DLOG_ARG(d)
+#define _DLOG_ARGS_5(a, b, c, d, e) /* Rejected by the static assert */
+#define _DLOG_CONCAT(a, b) a##b
+#define _DLOG_ARGS(count, ...) _DLOG_CONCAT(_DLOG_ARGS_, count)(__VA_ARGS__)
+
+/* Records hold the format ID of the call site and the raw arguments, formatting happens in the deferred log task.
+ * Arguments are integers or strings that outlive the log (literals, constant tables), no floating point */
+#define DLOG(level, tag, format, ...)                                                                             \
+    do {                                                                                                          \
+        _Static_assert(DLOG_NARGS(__VA_ARGS__) <= DLOG_MAX_ARGS, "Too many deferred log arguments");              \
+        if ((level) <= DLOG_LOCAL_LEVEL) {                                                                        \
+            static dlogFormat_t _dlogFormat = { (tag), (format), (level), DLOG_NARGS(__VA_ARGS__), 0U };          \
+            if (false) {                                                                                          \
+                vDLOG_CheckFormat((format), ##__VA_ARGS__);                                                       \
+            }                                                                                                     \
+            vDLOG_Write(&_dlogFormat _DLOG_ARGS(DLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__));                          \
+        }                                                                                                         \
+    } while (false)
+
+#define DLOGE(tag, format, ...) DLOG(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) DLOG(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+/* One per call site, the ID is given at its first write */
+typedef struct {
+    const char* tag;
+    const char* format;
+    esp_log_level_t level;
+    uint8_t argCount;
+    uint8_t id;
+} dlogFormat_t;
+
+void vDLOG_Write(dlogFormat_t* pFormat, ...);
+
+/* Never called: lets the compiler check the arguments against the format */
+void vDLOG_CheckFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+void vDLOG_Process(void* pvParameters);
+
+#endif //__DEFERREDLOG_H__
@@ -0,0 +1,79 @@
+/**
+******************************************************************************
+* @file 	inputLog.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __INPUTLOG_H__
+#define __INPUTLOG_H__
+
+#include "system_def.h"
+
+/* Records are compiled out unless SYSTEM_INPUT_LOG_ENABLED is set, callable from task and ISR */
+#if SYSTEM_INPUT_LOG_ENABLED
+#define ILOG_EDGE(gpio, level) vILOG_RecordEdge((uint8_t)(gpio), (uint8_t)(level))
+#define ILOG_FRAME(type, pPayload, length) vILOG_RecordFrame((type), (pPayload), (length))
+#define ILOG_TIMER(module) vILOG_RecordTimer((uint8_t)(module))
+#define ILOG_SERVO(gpio, pulseUs) vILOG_RecordServo((uint8_t)(gpio), (pulseUs))
+#define ILOG_IS_REPLAYING() bILOG_IsReplaying()
+#else
+#define ILOG_EDGE(gpio, level) \
+    do {                       \
+    } while (false)
+#define ILOG_FRAME(type, pPayload, length) \
+    do {                                   \
+    } while (false)
+#define ILOG_TIMER(module) \
+    do {                   \
+    } while (false)
+#define ILOG_SERVO(gpio, pulseUs) \
+    do {                          \
+    } while (false)
+#define ILOG_IS_REPLAYING() (false)
+#endif
+
+#define ILOG_VERSION (1U)
+
+/* Keep in sync with tools/input_log.py. Record: kind, delta from the previous record in us (varint), tick from the start
+ * of the log (varint), then: EDGE gpio, level | FRAME type, length, payload | TIMER bootModule_e | SERVO gpio, pulse us (varint)
+ * Edges and frames are inputs, timer expiries and servo writes are checkpoints */
+typedef enum {
+    ILOG_KIND_EDGE = 0,
+    ILOG_KIND_FRAME,
+    ILOG_KIND_TIMER,
+    ILOG_KIND_SERVO,
+    /* Do not erase */
+    ILOG_KIND_NUMBER
+} ilogKind_e;
+
+/* Injectors run in the replay task, as the interrupt or the task receiving the input would */
+typedef void (*ilogEdgeInjector_t)(uint32_t gpio, uint32_t level);
+typedef void (*ilogFrameInjector_t)(uint8_t type, const uint8_t* pPayload, uint8_t length);
+
+void vILOG_RecordEdge(uint8_t gpio, uint8_t level);
+
+void vILOG_RecordFrame(uint8_t type, const uint8_t* pPayload, uint8_t length);
+
+void vILOG_RecordTimer(uint8_t module);
+
+void vILOG_RecordServo(uint8_t gpio, uint32_t pulseUs);
+
+void vILOG_SetEdgeInjector(ilogEdgeInjector_t injector);
+
+void vILOG_SetFrameInjector(ilogFrameInjector_t injector);
+
+/* Records only, as concatenated from the "@IL" lines. The log must stay valid until the replay ends */
+bool bILOG_LoadReplay(const uint8_t* pLog, uint32_t length);
+
+/* Once all modules are ready: the log starts on a tick boundary, a loaded replay starts with it */
+void vILOG_Start(void);
+
+/* Live inputs are ignored while a replay runs */
+bool bILOG_IsReplaying(void);
+
+/* Streams the log on the console, see tools/input_log.py */
+void vILOG_Process(void* pvParameters);
+
+#endif //__INPUTLOG_H__
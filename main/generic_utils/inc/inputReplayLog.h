@@ -0,0 +1,16 @@
+/**
+******************************************************************************
+* @file 	inputReplayLog.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+/* Replaced by "tools/input_log.py embed CAPTURE", replayed after boot when SYSTEM_INPUT_REPLAY_ENABLED is set */
+#ifndef __INPUTREPLAYLOG_H__
+#define __INPUTREPLAYLOG_H__
+
+#define ILOG_REPLAY_LOG_LENGTH (0U)
+#define ILOG_REPLAY_LOG_BYTES 0x00
+
+#endif //__INPUTREPLAYLOG_H__
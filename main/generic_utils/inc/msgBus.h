@@ -0,0 +1,35 @@
+/**
+******************************************************************************
+* @file 	msgBus.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __MSGBUS_H__
+#define __MSGBUS_H__
+
+#include "system_def.h"
+
+/* Typed allocation, payload must be filled before publishing */
+#define BUS_ALLOC(topic, type) ((type*)pBUS_Alloc(topic, sizeof(type)))
+
+typedef enum {
+    BUS_TOPIC_BUTTON = 0, /* buttonEvent_t, see buttons.h */
+    BUS_TOPIC_CHARGE, /* pwrChargeReport_t, see power.h */
+    /* Do not erase */
+    BUS_TOPIC_NUMBER
+} busTopic_e;
+
+/* Subscribers receive payload pointers (void*) in their queue and must release each of them */
+bool bBUS_Subscribe(busTopic_e topic, QueueHandle_t queue);
+
+void* pBUS_Alloc(busTopic_e topic, uint32_t size);
+
+uint8_t u8BUS_Publish(void* pPayload);
+
+void vBUS_Release(void* pPayload);
+
+busTopic_e eBUS_GetTopic(const void* pPayload);
+
+#endif //__MSGBUS_H__
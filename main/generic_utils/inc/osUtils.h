@@ -25,6 +25,105 @@
         vOS_DeleteQueue(__responseQueue);                                   \
     } while (false)
 
+/* Placement is only applied with SYSTEM_CORE_PINNING_ENABLED, the scheduler picks a core otherwise */
+#if SYSTEM_CORE_PINNING_ENABLED
+#define OS_CORE(core) (core)
+#else
+#define OS_CORE(core) (tskNO_AFFINITY)
+#endif
+
+#if SYSTEM_STATIC_ALLOCATION
+#if !CONFIG_FREERTOS_SUPPORT_STATIC_ALLOCATION
+#error "SYSTEM_STATIC_ALLOCATION requires CONFIG_FREERTOS_SUPPORT_STATIC_ALLOCATION"
+#endif
+
+/* Each expansion owns its storage: a given call site must only be executed once */
+#define OS_TASK_CREATE(function, name, stackSize, priority, core)                                                     \
+    ({                                                                                                                \
+        static StackType_t __taskStack[(stackSize) / sizeof(StackType_t)];                                            \
+        static StaticTask_t __taskBuffer;                                                                             \
+        vOS_RegisterRamUsage(name, sizeof(__taskStack) + sizeof(__taskBuffer));                                       \
+        xTaskCreateStaticPinnedToCore(function, name, (stackSize) / sizeof(StackType_t), NULL, priority, __taskStack, \
+            &__taskBuffer, OS_CORE(core));                                                                            \
+    })
+
+#define OS_QUEUE_CREATE(name, length, itemSize)                                                             \
+    ({                                                                                                      \
+        static uint8_t __queueStorage[(length) * (itemSize)];                                               \
+        static StaticQueue_t __queueBuffer;                                                                 \
+        QueueHandle_t __queueHandle = xQueueCreateStatic(length, itemSize, __queueStorage, &__queueBuffer); \
+        vOS_RegisterRamUsage(name, sizeof(__queueStorage) + sizeof(__queueBuffer));                         \
+        vOS_RegisterQueueStats(__queueHandle, name, length);                                                \
+        __queueHandle;                                                                                      \
+    })
+
+#define OS_TIMER_CREATE(name, period, autoReload, pTimerId, callback)                     \
+    ({                                                                                    \
+        static StaticTimer_t __timerBuffer;                                               \
+        vOS_RegisterRamUsage(name, sizeof(__timerBuffer));                                \
+        xTimerCreateStatic(name, period, autoReload, pTimerId, callback, &__timerBuffer); \
+    })
+
+#define OS_MUTEX_CREATE(name)                              \
+    ({                                                     \
+        static StaticSemaphore_t __mutexBuffer;            \
+        vOS_RegisterRamUsage(name, sizeof(__mutexBuffer)); \
+        xSemaphoreCreateMutexStatic(&__mutexBuffer);       \
+    })
+
+#define OS_EVENT_GROUP_CREATE(name)                             \
+    ({                                                          \
+        static StaticEventGroup_t __eventGroupBuffer;           \
+        vOS_RegisterRamUsage(name, sizeof(__eventGroupBuffer)); \
+        xEventGroupCreateStatic(&__eventGroupBuffer);           \
+    })
+#else
+/* Heap allocation, sizes are reported as an estimate of what is taken from the heap */
+#define OS_TASK_CREATE(function, name, stackSize, priority, core)                                         \
+    ({                                                                                                    \
+        TaskHandle_t __taskHandle = NULL;                                                                 \
+        vOS_RegisterRamUsage(name, (stackSize) + sizeof(StaticTask_t));                                   \
+        xTaskCreatePinnedToCore(function, name, stackSize, NULL, priority, &__taskHandle, OS_CORE(core)); \
+        __taskHandle;                                                                                     \
+    })
+
+#define OS_QUEUE_CREATE(name, length, itemSize)                                    \
+    ({                                                                             \
+        QueueHandle_t __queueHandle = xQueueCreate(length, itemSize);              \
+        vOS_RegisterRamUsage(name, (length) * (itemSize) + sizeof(StaticQueue_t)); \
+        vOS_RegisterQueueStats(__queueHandle, name, length);                       \
+        __queueHandle;                                                             \
+    })
+
+#define OS_TIMER_CREATE(name, period, autoReload, pTimerId, callback) \
+    ({                                                                \
+        vOS_RegisterRamUsage(name, sizeof(StaticTimer_t));            \
+        xTimerCreate(name, period, autoReload, pTimerId, callback);   \
+    })
+
+#define OS_MUTEX_CREATE(name)                                  \
+    ({                                                         \
+        vOS_RegisterRamUsage(name, sizeof(StaticSemaphore_t)); \
+        xSemaphoreCreateMutex();                               \
+    })
+
+#define OS_EVENT_GROUP_CREATE(name)                             \
+    ({                                                          \
+        vOS_RegisterRamUsage(name, sizeof(StaticEventGroup_t)); \
+        xEventGroupCreate();                                    \
+    })
+#endif
+
+typedef struct {
+    const char* name;
+    uint32_t length;
+    uint32_t highWaterMark; /* Deepest level seen right after a send */
+    uint32_t sendCount;
+    uint32_t failedSends; /* Queue full on a non blocking send, item lost */
+    uint32_t timeouts; /* Queue still full at the end of a blocking send, item lost */
+    uint32_t maxBlockedUs; /* Longest time a sender waited for room */
+} osQueueStats_t;
+
 typedef struct {
     QueueHandle_t* pQueueHandle;
     TickType_t creationTime;
@@ -34,8 +133,22 @@ typedef struct {
 void vOS_DeleteQueue(QueueHandle_t* pQueueToDelete);
 void vOS_DeleteSemaphore(SemaphoreHandle_t* pSemaphoreToDelete);
 bool bOS_IsQueueReadyForSending(QueueHandle_t queueToSend, uint32_t startTime, uint32_t timeoutValue);
+/* True while the requester still waits, one tick ahead of its timeout: buffers it passed by pointer can be used
+ * until the response is sent */
+bool bOS_IsResponseAwaited(const queueContext_t* pQueueContext);
 void vOS_CreateResponseQueue(queueContext_t* pQueueContext, QueueHandle_t* pQueue, TickType_t queueTimeout);
 void vOS_QueueSendSafe(queueContext_t* pQueueContext, void* item);
 bool bOS_SendToTaskAndWaitResponse(QueueHandle_t queueToSend, void* pEvent, queueContext_t* pReponseQueue, void* pResponse, uint8_t reponseSize, portTickType timeout);
+void vOS_RegisterRamUsage(const char* name, uint32_t size);
+void vOS_PrintRamBudget(void);
+void vOS_RegisterQueueStats(QueueHandle_t queue, const char* name, uint32_t length);
+bool bOS_QueueSend(QueueHandle_t queue, const void* pItem, TickType_t timeout);
+bool bOS_QueueSendToFront(QueueHandle_t queue, const void* pItem, TickType_t timeout);
+bool bOS_QueueSendFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken);
+bool bOS_QueueSendToFrontFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken);
+uint8_t u8OS_GetQueueStats(osQueueStats_t* pStats, uint8_t maxEntries);
+void vOS_StartQueueStatsDump(TickType_t period);
+/* Runs the function on the core, interrupts allocated from it are served there. OS_CORE placement applies */
+bool bOS_RunOnCore(BaseType_t core, void (*function)(void*), void* pArg);
 
 #endif //__OSUTILS_H__
\ No newline at end of file
@@ -0,0 +1,36 @@
+/**
+******************************************************************************
+* @file 	reactor.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __REACTOR_H__
+#define __REACTOR_H__
+
+#include "boot.h"
+#include "system_def.h"
+
+#define REACTOR_MAX_MODULES (8U)
+#define REACTOR_EVENT_BUFFER_SIZE (64U)
+
+typedef struct {
+    const char* name;
+    bootModule_e bootModule;
+    QueueHandle_t* pQueue;
+    uint32_t queueLength;
+    uint32_t eventSize;
+    void (*init)(void);
+    TickType_t (*handleEvent)(void* pEvent); /* pEvent is NULL on timeout, returns ticks before next timeout */
+} reactorModule_t;
+
+void vREACTOR_RunModule(const reactorModule_t* pModule);
+
+bool bREACTOR_RegisterModule(const reactorModule_t* pModule);
+
+void vREACTOR_Process(void* pvParameters);
+
+bool bREACTOR_DispatchInline(QueueHandle_t queue, void* pEvent);
+
+#endif //__REACTOR_H__
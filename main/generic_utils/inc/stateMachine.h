@@ -0,0 +1,69 @@
+/**
+******************************************************************************
+* @file 	stateMachine.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __STATEMACHINE_H__
+#define __STATEMACHINE_H__
+
+#include "system_def.h"
+
+#define SM_NO_EVENT (0xFFU)
+#define SM_STAY (0U)
+
+/* Table cells, a cell left out of the initializer ignores its event */
+#define SM_TO(state, function) { .next = (uint8_t)((state) + 1U), .action = (function) }
+#define SM_INTERNAL(function) { .next = SM_STAY, .action = (function) } /* The action runs, no exit nor entry */
+
+/* Returns false to refuse the transition, the machine then stays in its state without exit nor entry */
+typedef bool (*smAction_t)(void* pEvent);
+
+typedef struct {
+    uint8_t next; /* Target state + 1, SM_STAY for none */
+    smAction_t action; /* NULL: transition taken without action */
+} smTransition_t;
+
+typedef struct {
+    const char* name;
+    void (*entry)(void);
+    void (*exit)(void);
+    TickType_t timeoutTicks; /* Armed at entry, portMAX_DELAY for none, vSM_SetTimeout overrides it */
+    uint8_t timeoutEvent; /* Dispatched when the timeout expires, SM_NO_EVENT for none */
+} smState_t;
+
+/* Transitions are a [stateNumber][eventNumber] table, row per state: dispatch is a single lookup */
+typedef struct {
+    const char* name;
+    uint8_t traceId; /* arg0 of TRACE_ID_SM_TRANSITION records */
+    const smState_t* pStates;
+    uint8_t stateNumber;
+    const smTransition_t* pTransitions;
+    uint8_t eventNumber;
+    uint8_t initialState;
+} smDefinition_t;
+
+typedef struct {
+    const smDefinition_t* pDefinition;
+    uint8_t state;
+    bool timeoutArmed;
+    TickType_t timeoutDeadline;
+} stateMachine_t;
+
+/* Enters the initial state, its entry action runs */
+void vSM_Start(stateMachine_t* pMachine, const smDefinition_t* pDefinition);
+
+/* Returns the ticks before the state timeout, portMAX_DELAY when none is armed: a reactor handleEvent result */
+TickType_t xSM_Dispatch(stateMachine_t* pMachine, uint8_t event, void* pEvent);
+
+/* Dispatches the timeout event if the deadline has passed, same return as xSM_Dispatch */
+TickType_t xSM_HandleTimeout(stateMachine_t* pMachine);
+
+/* From an entry or an action: (re)arms the timeout of the current state, portMAX_DELAY disarms it */
+void vSM_SetTimeout(stateMachine_t* pMachine, TickType_t ticks);
+
+uint8_t u8SM_GetState(const stateMachine_t* pMachine);
+
+#endif //__STATEMACHINE_H__
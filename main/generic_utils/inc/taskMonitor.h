@@ -0,0 +1,40 @@
+/**
+******************************************************************************
+* @file 	taskMonitor.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __TASKMONITOR_H__
+#define __TASKMONITOR_H__
+
+#include "system_def.h"
+
+/* Called by event loops on each wake up, compiled out with the monitor */
+#if SYSTEM_TASK_MONITOR_ENABLED
+#define TMON_COUNT_WAKEUP() vTMON_CountWakeup()
+#else
+#define TMON_COUNT_WAKEUP() \
+    do {                    \
+    } while (false)
+#endif
+
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    UBaseType_t priority;
+    uint32_t stackFreeMinBytes; /* Stack high water mark */
+    uint16_t loadPermille; /* Share of one core during the last sample */
+    uint16_t windowLoadPermille; /* Share of one core over the sliding window */
+    uint32_t wakeupsPerSecond; /* Over the sliding window, reactor loops only */
+} tmonTaskStats_t;
+
+void vTMON_Process(void* pvParameters);
+
+void vTMON_CountWakeup(void);
+
+uint8_t u8TMON_GetTaskStats(tmonTaskStats_t* pStats, uint8_t maxEntries);
+
+void vTMON_PrintTaskStats(void);
+
+#endif //__TASKMONITOR_H__
@@ -0,0 +1,41 @@
+/**
+******************************************************************************
+* @file 	trace.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "system_def.h"
+
+/* Records are compiled out unless SYSTEM_TRACE_ENABLED is set, callable from task and ISR */
+#if SYSTEM_TRACE_ENABLED
+#define TRACE_EVENT(id, arg0, arg1) vTRACE_Record((id), (uint8_t)(arg0), (uint16_t)(arg1))
+#else
+#define TRACE_EVENT(id, arg0, arg1) \
+    do {                            \
+    } while (false)
+#endif
+
+/* Keep in sync with tools/trace_decode.py */
+typedef enum {
+    TRACE_ID_BUTTON_ISR = 0, /* arg0: gpio, arg1: level */
+    TRACE_ID_QUEUE_POST, /* arg0: target bootModule_e, arg1: event type */
+    TRACE_ID_QUEUE_RECEIVE, /* arg0: bootModule_e */
+    TRACE_ID_TIMER_EXPIRY, /* arg0: bootModule_e, arg1: 0 module timeout, 1 software timer */
+    TRACE_ID_SERVO_WRITE, /* arg0: gpio, arg1: pulse in us */
+    TRACE_ID_SEQUENCE_STEP, /* arg0: step index, arg1: movementType_e */
+    TRACE_ID_EMERGENCY_STOP, /* arg0: servo number, arg1: latency in us */
+    TRACE_ID_SM_TRANSITION, /* arg0: machine traceId (bootModule_e), arg1: source state << 8 | target state */
+    /* Do not erase */
+    TRACE_ID_NUMBER
+} traceEvent_e;
+
+void vTRACE_Record(traceEvent_e id, uint8_t arg0, uint16_t arg1);
+
+void vTRACE_Process(void* pvParameters);
+
+#endif //__TRACE_H__
@@ -0,0 +1,96 @@
+/**
+******************************************************************************
+* @file 	boot.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "boot.h"
+#include "esp_timer.h"
+
+/* Define */
+#define TAG_BOOT ("BOOT")
+#define BOOT_BIT(module) ((EventBits_t)1U << (module))
+#define BOOT_ALL_BITS (BOOT_BIT(BOOT_MODULE_NUMBER) - 1U)
+
+/* Struct */
+typedef struct {
+    const char* name;
+    uint8_t stage;
+    EventBits_t dependencies;
+} bootModuleConfig_t;
+
+/* Static variables */
+/* A module only waits for the queues and init of the modules it calls during its own init or first events */
+static const bootModuleConfig_t _bootModules[BOOT_MODULE_NUMBER] = {
+    [BOOT_MODULE_BUTTONS] = { "Driver buttons", 0U, 0U },
+    [BOOT_MODULE_SERVO] = { "Driver servos", 0U, 0U },
+    [BOOT_MODULE_LEDS] = { "Driver LEDs", 0U, 0U },
+    [BOOT_MODULE_MOVEMENT_MANAGER] = { "Movement manager", 1U, BOOT_BIT(BOOT_MODULE_SERVO) },
+    [BOOT_MODULE_SEQUENCE_MANAGER] = { "Sequence manager", 2U, BOOT_BIT(BOOT_MODULE_MOVEMENT_MANAGER) },
+    [BOOT_MODULE_BUTTONS_MANAGER] = { "Buttons manager", 3U, BOOT_BIT(BOOT_MODULE_BUTTONS) | BOOT_BIT(BOOT_MODULE_SEQUENCE_MANAGER) },
+};
+static EventGroupHandle_t _bootEventGroup = NULL;
+static int64_t _initStartUs[BOOT_MODULE_NUMBER] = { 0 };
+static volatile EventBits_t _degradedModules = 0U;
+static portMUX_TYPE _degradedMux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Public functions */
+void vBOOT_Init(void)
+{
+    /* Called from app_main before any module task is created */
+    _bootEventGroup = OS_EVENT_GROUP_CREATE("Event group boot");
+}
+
+bool bBOOT_WaitDependencies(bootModule_e module)
+{
+    bool result = true;
+    EventBits_t dependencies = _bootModules[module].dependencies;
+
+    if (dependencies != 0U) {
+        if ((xEventGroupWaitBits(_bootEventGroup, dependencies, pdFALSE, pdTRUE, BOOT_DEPENDENCY_TIMEOUT_TICKS) & dependencies) != dependencies) {
+            ESP_LOGE(TAG_BOOT, "%s dependencies not ready (0x%02x)", _bootModules[module].name, xEventGroupGetBits(_bootEventGroup));
+            result = false;
+        } else if ((_degradedModules & dependencies) != 0U) {
+            ESP_LOGE(TAG_BOOT, "%s dependencies degraded (0x%02x)", _bootModules[module].name, _degradedModules & dependencies);
+            result = false;
+        }
+    }
+    if (!result) {
+        /* Modules waiting on this one see it degraded in turn */
+        portENTER_CRITICAL(&_degradedMux);
+        _degradedModules |= BOOT_BIT(module);
+        portEXIT_CRITICAL(&_degradedMux);
+    }
+    /* esp_timer counts from early startup, bootloader time is not included */
+    _initStartUs[module] = esp_timer_get_time();
+
+    return result;
+}
+
+void vBOOT_SignalReady(bootModule_e module)
+{
+    int64_t readyUs = esp_timer_get_time();
+
+    ESP_LOGI(TAG_BOOT, "Stage %u %s ready at %u us (init %u us)", _bootModules[module].stage, _bootModules[module].name, (uint32_t)readyUs, (uint32_t)(readyUs - _initStartUs[module]));
+    xEventGroupSetBits(_bootEventGroup, BOOT_BIT(module));
+}
+
+bool bBOOT_WaitAllReady(TickType_t timeout)
+{
+    bool result = false;
+
+    if ((xEventGroupWaitBits(_bootEventGroup, BOOT_ALL_BITS, pdFALSE, pdTRUE, timeout) & BOOT_ALL_BITS) == BOOT_ALL_BITS) {
+        if (_degradedModules != 0U) {
+            ESP_LOGW(TAG_BOOT, "Boot completed at %u us, degraded modules 0x%02x", (uint32_t)esp_timer_get_time(), _degradedModules);
+        } else {
+            ESP_LOGI(TAG_BOOT, "Boot completed at %u us", (uint32_t)esp_timer_get_time());
+        }
+        result = true;
+    } else {
+        ESP_LOGE(TAG_BOOT, "Boot incomplete (0x%02x)", xEventGroupGetBits(_bootEventGroup));
+    }
+
+    return result;
+}
@@ -0,0 +1,230 @@
+/**
+******************************************************************************
+* @file 	deadlineMonitor.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "deadlineMonitor.h"
+#include "deferredLog.h"
+#include "esp_timer.h"
+
+#if SYSTEM_DEADLINE_MONITOR_ENABLED
+
+/* Define */
+#define TAG_DLN ("DLN")
+#define DLN_CHAIN_MAX_STAGES (6U)
+#define DLN_NO_CHAIN (DLN_CHAIN_NUMBER)
+
+/* Struct */
+typedef struct {
+    bool hopMissed;
+    bool chainMissed;
+    dlnChain_e chain;
+    uint32_t hopUs;
+    uint32_t chainUs;
+} dlnMiss_t;
+
+/* Static prototypes */
+static void _stamp(dlnStage_e stage, dlnMiss_t* pMiss);
+static void _record(dlnLatencyStats_t* pStats, uint32_t latencyUs);
+static void _printStats(const char* name, const dlnLatencyStats_t* pStats);
+static void _dumpStats(TimerHandle_t timer);
+
+/* Static variables */
+static const char* _stageNames[DLN_STAGE_NUMBER] = {
+    [DLN_STAGE_ISR_EDGE] = "ISR edge",
+    [DLN_STAGE_BUTTON_TASK] = "Buttons task",
+    [DLN_STAGE_BUTTON_MANAGER] = "Buttons manager",
+    [DLN_STAGE_MOVEMENT_END] = "Movement end",
+    [DLN_STAGE_SEQUENCE_MANAGER] = "Sequence manager",
+    [DLN_STAGE_MOVEMENT_MANAGER] = "Movement manager",
+    [DLN_STAGE_SERVO_WRITE] = "Servo write",
+};
+static const char* _chainNames[DLN_CHAIN_NUMBER] = {
+    [DLN_CHAIN_INPUT_TO_MOTION] = "Input to motion",
+    [DLN_CHAIN_STEP_TRANSITION] = "Step transition",
+};
+static const dlnStage_e _chainPaths[DLN_CHAIN_NUMBER][DLN_CHAIN_MAX_STAGES] = {
+    [DLN_CHAIN_INPUT_TO_MOTION] = { DLN_STAGE_ISR_EDGE, DLN_STAGE_BUTTON_TASK, DLN_STAGE_BUTTON_MANAGER, DLN_STAGE_SEQUENCE_MANAGER, DLN_STAGE_MOVEMENT_MANAGER, DLN_STAGE_SERVO_WRITE },
+    [DLN_CHAIN_STEP_TRANSITION] = { DLN_STAGE_MOVEMENT_END, DLN_STAGE_SEQUENCE_MANAGER, DLN_STAGE_MOVEMENT_MANAGER, DLN_STAGE_SERVO_WRITE, DLN_STAGE_NUMBER },
+};
+static const uint32_t _hopBudgetsUs[DLN_STAGE_NUMBER] = {
+    [DLN_STAGE_BUTTON_TASK] = DLN_BUDGET_BUTTON_TASK_US,
+    [DLN_STAGE_BUTTON_MANAGER] = DLN_BUDGET_BUTTON_MANAGER_US,
+    [DLN_STAGE_SEQUENCE_MANAGER] = DLN_BUDGET_SEQUENCE_MANAGER_US,
+    [DLN_STAGE_MOVEMENT_MANAGER] = DLN_BUDGET_MOVEMENT_MANAGER_US,
+    [DLN_STAGE_SERVO_WRITE] = DLN_BUDGET_SERVO_WRITE_US,
+};
+static const uint32_t _chainBudgetsUs[DLN_CHAIN_NUMBER] = {
+    [DLN_CHAIN_INPUT_TO_MOTION] = DLN_BUDGET_INPUT_TO_MOTION_US,
+    [DLN_CHAIN_STEP_TRANSITION] = DLN_BUDGET_STEP_TRANSITION_US,
+};
+static dlnLatencyStats_t _hopStats[DLN_STAGE_NUMBER] = { 0 };
+static dlnLatencyStats_t _chainStats[DLN_CHAIN_NUMBER] = { 0 };
+static dlnChain_e _activeChain = DLN_NO_CHAIN;
+static uint8_t _chainPosition = 0U;
+static int64_t _chainStartUs = 0;
+static int64_t _lastStampUs = 0;
+static portMUX_TYPE _deadlineMux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Public functions */
+void vDLN_Stamp(dlnStage_e stage)
+{
+    dlnMiss_t miss = { 0 };
+
+    portENTER_CRITICAL(&_deadlineMux);
+    _stamp(stage, &miss);
+    portEXIT_CRITICAL(&_deadlineMux);
+
+    /* Reported as soon as the late stage is reached, not at the next dump */
+    if (miss.hopMissed) {
+        DLOGW(TAG_DLN, "%s late: %u us (budget %u us)", _stageNames[stage], miss.hopUs, _hopBudgetsUs[stage]);
+    }
+    if (miss.chainMissed) {
+        DLOGW(TAG_DLN, "%s late: %u us (budget %u us)", _chainNames[miss.chain], miss.chainUs, _chainBudgetsUs[miss.chain]);
+    }
+}
+
+void vDLN_StampFromISR(dlnStage_e stage)
+{
+    dlnMiss_t miss = { 0 };
+
+    /* Misses are counted but not logged from ISR */
+    portENTER_CRITICAL_ISR(&_deadlineMux);
+    _stamp(stage, &miss);
+    portEXIT_CRITICAL_ISR(&_deadlineMux);
+}
+
+void vDLN_Abandon(void)
+{
+    portENTER_CRITICAL(&_deadlineMux);
+    _activeChain = DLN_NO_CHAIN;
+    portEXIT_CRITICAL(&_deadlineMux);
+}
+
+void vDLN_GetHopStats(dlnStage_e stage, dlnLatencyStats_t* pStats)
+{
+    portENTER_CRITICAL(&_deadlineMux);
+    memcpy(pStats, &_hopStats[stage], sizeof(_hopStats[stage]));
+    portEXIT_CRITICAL(&_deadlineMux);
+    pStats->budgetUs = _hopBudgetsUs[stage];
+}
+
+void vDLN_GetChainStats(dlnChain_e chain, dlnLatencyStats_t* pStats)
+{
+    portENTER_CRITICAL(&_deadlineMux);
+    memcpy(pStats, &_chainStats[chain], sizeof(_chainStats[chain]));
+    portEXIT_CRITICAL(&_deadlineMux);
+    pStats->budgetUs = _chainBudgetsUs[chain];
+}
+
+void vDLN_ResetStats(void)
+{
+    portENTER_CRITICAL(&_deadlineMux);
+    memset(_hopStats, 0, sizeof(_hopStats));
+    memset(_chainStats, 0, sizeof(_chainStats));
+    portEXIT_CRITICAL(&_deadlineMux);
+}
+
+void vDLN_PrintStats(void)
+{
+    dlnLatencyStats_t stats;
+
+    ESP_LOGI(TAG_DLN, "%-16s %8s %6s %6s %8s %8s  histogram (log2 us)", "Hop / chain", "budget", "count", "missed", "last", "worst");
+    for (uint8_t stage = 0U; stage < DLN_STAGE_NUMBER; stage++) {
+        /* Chain starts have no hop */
+        if (_hopBudgetsUs[stage] > 0U) {
+            vDLN_GetHopStats(stage, &stats);
+            _printStats(_stageNames[stage], &stats);
+        }
+    }
+    for (uint8_t chain = 0U; chain < DLN_CHAIN_NUMBER; chain++) {
+        vDLN_GetChainStats(chain, &stats);
+        _printStats(_chainNames[chain], &stats);
+    }
+}
+
+void vDLN_StartStatsDump(TickType_t period)
+{
+    TimerHandle_t dumpTimer = OS_TIMER_CREATE("Timer deadline stats", period, pdTRUE, NULL, _dumpStats);
+
+    if ((dumpTimer == NULL) || (xTimerStart(dumpTimer, TIMER_API_DEFAULT_TIMEOUT) != pdPASS)) {
+        ESP_LOGE(TAG_DLN, "Cannot start deadline stats dump");
+    }
+}
+
+/* Static functions */
+static void _stamp(dlnStage_e stage, dlnMiss_t* pMiss)
+{
+    int64_t nowUs = esp_timer_get_time();
+    bool isChainStart = false;
+
+    for (uint8_t chain = 0U; chain < DLN_CHAIN_NUMBER; chain++) {
+        if (_chainPaths[chain][0] == stage) {
+            _activeChain = chain;
+            _chainPosition = 0U;
+            _chainStartUs = nowUs;
+            _lastStampUs = nowUs;
+            isChainStart = true;
+            break;
+        }
+    }
+
+    /* Stages reached outside of the expected order belong to another flow (timeouts, stop orders) */
+    if (!isChainStart && (_activeChain != DLN_NO_CHAIN) && ((_chainPosition + 1U) < DLN_CHAIN_MAX_STAGES) && (_chainPaths[_activeChain][_chainPosition + 1U] == stage)) {
+        pMiss->hopUs = (uint32_t)(nowUs - _lastStampUs);
+        _record(&_hopStats[stage], pMiss->hopUs);
+        if (pMiss->hopUs > _hopBudgetsUs[stage]) {
+            _hopStats[stage].missCount++;
+            pMiss->hopMissed = true;
+        }
+        _chainPosition++;
+        _lastStampUs = nowUs;
+
+        if (((_chainPosition + 1U) >= DLN_CHAIN_MAX_STAGES) || (_chainPaths[_activeChain][_chainPosition + 1U] == DLN_STAGE_NUMBER)) {
+            pMiss->chain = _activeChain;
+            pMiss->chainUs = (uint32_t)(nowUs - _chainStartUs);
+            _record(&_chainStats[_activeChain], pMiss->chainUs);
+            if (pMiss->chainUs > _chainBudgetsUs[_activeChain]) {
+                _chainStats[_activeChain].missCount++;
+                pMiss->chainMissed = true;
+            }
+            _activeChain = DLN_NO_CHAIN;
+        }
+    }
+}
+
+static void _record(dlnLatencyStats_t* pStats, uint32_t latencyUs)
+{
+    uint8_t bucket = (latencyUs > 1U) ? (31U - __builtin_clz(latencyUs)) : 0U;
+
+    if (bucket >= DLN_HISTOGRAM_BUCKETS) {
+        bucket = DLN_HISTOGRAM_BUCKETS - 1U;
+    }
+    pStats->histogram[bucket]++;
+    pStats->count++;
+    pStats->lastUs = latencyUs;
+    if (latencyUs > pStats->worstUs) {
+        pStats->worstUs = latencyUs;
+    }
+}
+
+static void _printStats(const char* name, const dlnLatencyStats_t* pStats)
+{
+    char histogram[DLN_HISTOGRAM_BUCKETS * 6U] = { 0 };
+    uint32_t length = 0U;
+
+    for (uint8_t bucket = 0U; (bucket < DLN_HISTOGRAM_BUCKETS) && (length < sizeof(histogram)); bucket++) {
+        length += snprintf(&histogram[length], sizeof(histogram) - length, " %u", pStats->histogram[bucket]);
+    }
+    ESP_LOGI(TAG_DLN, "%-16s %8u %6u %6u %8u %8u %s", name, pStats->budgetUs, pStats->count, pStats->missCount, pStats->lastUs, pStats->worstUs, histogram);
+}
+
+static void _dumpStats(TimerHandle_t timer)
+{
+    vDLN_PrintStats();
+}
+
+#endif
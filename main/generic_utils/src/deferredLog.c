@@ -0,0 +1,220 @@
+/**
+******************************************************************************
+* @file 	deferredLog.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "deferredLog.h"
+#include <stdarg.h>
+
+/* Define */
+#define TAG_DLOG ("DLOG")
+#define DLOG_MESSAGE_MAX_SIZE (128U)
+#define DLOG_VARINT_MAX_SIZE (10U) /* 64 bits, 7 per byte */
+#define DLOG_RECORD_MAX_SIZE ((2U + DLOG_MAX_ARGS) * DLOG_VARINT_MAX_SIZE)
+#define DLOG_DRAIN_PERIOD_TICKS (pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS))
+#define DLOG_NO_ID (0U)
+
+/* Struct */
+/* Record in the ring: format ID, timestamp in ms, then one per argument of the format, all varints */
+typedef struct {
+    const dlogFormat_t* pFormat;
+    uint32_t timestampMs;
+    uintptr_t args[DLOG_MAX_ARGS];
+} dlogRecord_t;
+
+/* Static prototypes */
+static uint8_t _getId(dlogFormat_t* pFormat);
+static uint32_t _putVarint(uint8_t* pBuffer, uint64_t value);
+static uint64_t _getVarint(uint32_t* pTail);
+static bool _readRecord(uint32_t* pTail, dlogRecord_t* pRecord);
+static void _format(const dlogRecord_t* pRecord, char* pMessage, uint32_t size);
+
+/* Static variables */
+static uint8_t _buffer[DLOG_BUFFER_SIZE] = { 0 };
+static volatile uint32_t _head = 0U; /* Free running */
+static volatile uint32_t _tail = 0U; /* Free running */
+static volatile uint32_t _dropped = 0U;
+static const dlogFormat_t* _formats[DLOG_MAX_FORMATS + 1U] = { NULL }; /* By ID, 0 is none */
+static uint8_t _formatNumber = 0U;
+static portMUX_TYPE _logMux = portMUX_INITIALIZER_UNLOCKED;
+
+_Static_assert((DLOG_BUFFER_SIZE & (DLOG_BUFFER_SIZE - 1U)) == 0U, "Deferred log buffer size must be a power of two");
+_Static_assert(DLOG_MAX_FORMATS < UINT8_MAX, "Format IDs are 8 bits");
+
+/* Public functions */
+void vDLOG_Write(dlogFormat_t* pFormat, ...)
+{
+    uint8_t record[DLOG_RECORD_MAX_SIZE];
+    uint32_t size = 0U;
+    va_list args;
+
+    /* Encoded on the caller stack, only the copy is under the lock */
+    size += _putVarint(&record[size], _getId(pFormat));
+    size += _putVarint(&record[size], esp_log_timestamp());
+    va_start(args, pFormat);
+    for (uint8_t argIndex = 0U; argIndex < pFormat->argCount; argIndex++) {
+        size += _putVarint(&record[size], va_arg(args, uintptr_t));
+    }
+    va_end(args);
+
+    /* Never block the caller: the log is lost when the formatting task is late */
+    portENTER_CRITICAL_SAFE(&_logMux);
+    if ((pFormat->id != DLOG_NO_ID) && ((DLOG_BUFFER_SIZE - (_head - _tail)) >= size)) {
+        for (uint32_t index = 0U; index < size; index++) {
+            _buffer[(_head + index) & (DLOG_BUFFER_SIZE - 1U)] = record[index];
+        }
+        __sync_synchronize();
+        _head += size;
+    } else {
+        _dropped++;
+    }
+    portEXIT_CRITICAL_SAFE(&_logMux);
+}
+
+void vDLOG_CheckFormat(const char* format, ...)
+{
+}
+
+void vDLOG_Process(void* pvParameters)
+{
+    static const char levelLetters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    dlogRecord_t record;
+    char message[DLOG_MESSAGE_MAX_SIZE];
+    uint32_t reportedDropped = 0U;
+    uint32_t tail = 0U;
+
+    for (;;) {
+        tail = _tail;
+        __sync_synchronize();
+        while (_readRecord(&tail, &record)) {
+            _format(&record, message, sizeof(message));
+            esp_log_write(record.pFormat->level, record.pFormat->tag, "%c (%u) %s: %s\n", levelLetters[record.pFormat->level],
+                record.timestampMs, record.pFormat->tag, message);
+        }
+        __sync_synchronize();
+        _tail = tail;
+
+        if (_dropped != reportedDropped) {
+            reportedDropped = _dropped;
+            ESP_LOGW(TAG_DLOG, "%u deferred logs dropped", reportedDropped);
+        }
+        vTaskDelay(DLOG_DRAIN_PERIOD_TICKS);
+    }
+}
+
+/* Static functions */
+static uint8_t _getId(dlogFormat_t* pFormat)
+{
+    /* First write of a call site: the format is registered, later ones only read the ID */
+    if (pFormat->id == DLOG_NO_ID) {
+        portENTER_CRITICAL_SAFE(&_logMux);
+        if ((pFormat->id == DLOG_NO_ID) && (_formatNumber < DLOG_MAX_FORMATS)) {
+            _formats[++_formatNumber] = pFormat;
+            pFormat->id = _formatNumber;
+        }
+        portEXIT_CRITICAL_SAFE(&_logMux);
+    }
+
+    return pFormat->id;
+}
+
+static uint32_t _putVarint(uint8_t* pBuffer, uint64_t value)
+{
+    uint32_t size = 0U;
+
+    /* LEB128: 7 bits per byte, low bits first, high bit set on all but the last byte */
+    do {
+        pBuffer[size] = (uint8_t)(value & 0x7FU);
+        value >>= 7;
+        if (value != 0U) {
+            pBuffer[size] |= 0x80U;
+        }
+        size++;
+    } while (value != 0U);
+
+    return size;
+}
+
+static uint64_t _getVarint(uint32_t* pTail)
+{
+    uint64_t value = 0U;
+    uint32_t shift = 0U;
+    uint8_t byte = 0U;
+
+    /* Records are written whole under the lock, a varint never runs past the head */
+    do {
+        byte = _buffer[(*pTail)++ & (DLOG_BUFFER_SIZE - 1U)];
+        value |= (uint64_t)(byte & 0x7FU) << shift;
+        shift += 7U;
+    } while ((byte & 0x80U) != 0U);
+
+    return value;
+}
+
+static bool _readRecord(uint32_t* pTail, dlogRecord_t* pRecord)
+{
+    bool result = (*pTail != _head);
+
+    if (result) {
+        pRecord->pFormat = _formats[_getVarint(pTail)];
+        pRecord->timestampMs = (uint32_t)_getVarint(pTail);
+        for (uint8_t argIndex = 0U; argIndex < pRecord->pFormat->argCount; argIndex++) {
+            pRecord->args[argIndex] = (uintptr_t)_getVarint(pTail);
+        }
+    }
+
+    return result;
+}
+
+static void _format(const dlogRecord_t* pRecord, char* pMessage, uint32_t size)
+{
+    const char* pFormat = pRecord->pFormat->format;
+    const char* pConversion = NULL;
+    char piece[DLOG_MESSAGE_MAX_SIZE];
+    uint32_t length = 0U;
+    uint8_t argIndex = 0U;
+    uint8_t longNumber = 0U;
+
+    /* One conversion at a time, each argument is given back the type its conversion reads */
+    pMessage[0] = '\0';
+    while ((*pFormat != '\0') && (length < size)) {
+        pConversion = strchr(pFormat, '%');
+        while ((pConversion != NULL) && (pConversion[1] == '%')) {
+            pConversion = strchr(&pConversion[2], '%');
+        }
+        if ((pConversion == NULL) || (argIndex >= pRecord->pFormat->argCount)) {
+            /* Only "%%" left, the compiler checked the conversions against the arguments */
+            length += snprintf(&pMessage[length], size - length, pFormat);
+            break;
+        }
+        longNumber = 0U;
+        pConversion += strspn(&pConversion[1], "-+ #0123456789.") + 1U;
+        while (*pConversion == 'l') {
+            longNumber++;
+            pConversion++;
+        }
+        pConversion += strspn(pConversion, "hzjt");
+        if (*pConversion == '\0') {
+            length += snprintf(&pMessage[length], size - length, "%s", pFormat);
+            break;
+        }
+        /* Format up to and including the conversion */
+        snprintf(piece, sizeof(piece), "%.*s", (int)(pConversion + 1 - pFormat), pFormat);
+        if (*pConversion == 's') {
+            length += snprintf(&pMessage[length], size - length, piece, (const char*)pRecord->args[argIndex]);
+        } else if (*pConversion == 'p') {
+            length += snprintf(&pMessage[length], size - length, piece, (void*)pRecord->args[argIndex]);
+        } else if (longNumber == 2U) {
+            length += snprintf(&pMessage[length], size - length, piece, (unsigned long long)pRecord->args[argIndex]);
+        } else if (longNumber == 1U) {
+            length += snprintf(&pMessage[length], size - length, piece, (unsigned long)pRecord->args[argIndex]);
+        } else {
+            length += snprintf(&pMessage[length], size - length, piece, (unsigned int)pRecord->args[argIndex]);
+        }
+        argIndex++;
+        pFormat = pConversion + 1;
+    }
+}
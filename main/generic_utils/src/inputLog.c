@@ -0,0 +1,325 @@
+/**
+******************************************************************************
+* @file 	inputLog.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "inputLog.h"
+#include "esp_timer.h"
+#include "inputReplayLog.h"
+
+#if SYSTEM_INPUT_LOG_ENABLED
+
+/* Define */
+#define TAG_ILOG ("ILOG")
+#define ILOG_VARINT_MAX_SIZE (10U) /* 64 bits, 7 per byte */
+#define ILOG_BODY_MAX_SIZE (2U + ILOG_FRAME_MAX_PAYLOAD_SIZE)
+#define ILOG_RECORD_MAX_SIZE (1U + ILOG_VARINT_MAX_SIZE + ILOG_VARINT_MAX_SIZE + ILOG_BODY_MAX_SIZE)
+#define ILOG_LINE_BYTES (32U)
+#define ILOG_LINE_SIZE (4U + (2U * ILOG_LINE_BYTES) + 1U)
+#define ILOG_DRAIN_PERIOD_TICKS (pdMS_TO_TICKS(ILOG_DRAIN_PERIOD_MS))
+#define TICK_IS_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/* Struct */
+typedef struct {
+    uint8_t kind;
+    uint32_t tick;
+    uint8_t source; /* GPIO, frame type or bootModule_e */
+    uint32_t value; /* Level, frame length or pulse in us */
+    const uint8_t* pPayload;
+} ilogRecord_t;
+
+/* Static prototypes */
+static void _append(ilogKind_e kind, const uint8_t* pBody, uint32_t bodySize);
+static uint32_t _putVarint(uint8_t* pBuffer, uint64_t value);
+static bool _getVarint(uint32_t* pOffset, uint64_t* pValue);
+static bool _readRecord(uint32_t* pOffset, ilogRecord_t* pRecord);
+static void _replayProcess(void* pvParameters);
+static void _drain(void);
+
+/* Static variables */
+static uint8_t _buffer[ILOG_BUFFER_SIZE] = { 0 };
+static volatile uint32_t _head = 0U; /* Free running */
+static volatile uint32_t _tail = 0U; /* Free running */
+static volatile uint32_t _dropped = 0U;
+static uint32_t _reportedDropped = 0U;
+static volatile bool _recording = false;
+static volatile bool _replaying = false;
+static int64_t _lastRecordUs = 0;
+static TickType_t _originTick = 0U;
+static const uint8_t* _pReplayLog = NULL;
+static uint32_t _replayLength = 0U;
+static ilogEdgeInjector_t _edgeInjector = NULL;
+static ilogFrameInjector_t _frameInjector = NULL;
+static portMUX_TYPE _logMux = portMUX_INITIALIZER_UNLOCKED;
+
+_Static_assert((ILOG_BUFFER_SIZE & (ILOG_BUFFER_SIZE - 1U)) == 0U, "Input log buffer size must be a power of two");
+
+/* Public functions */
+void vILOG_RecordEdge(uint8_t gpio, uint8_t level)
+{
+    uint8_t body[2] = { gpio, level };
+
+    _append(ILOG_KIND_EDGE, body, sizeof(body));
+}
+
+void vILOG_RecordFrame(uint8_t type, const uint8_t* pPayload, uint8_t length)
+{
+    uint8_t body[ILOG_BODY_MAX_SIZE];
+
+    length = (length < ILOG_FRAME_MAX_PAYLOAD_SIZE) ? length : ILOG_FRAME_MAX_PAYLOAD_SIZE;
+    body[0] = type;
+    body[1] = length;
+    memcpy(&body[2], pPayload, length);
+    _append(ILOG_KIND_FRAME, body, 2U + length);
+}
+
+void vILOG_RecordTimer(uint8_t module)
+{
+    _append(ILOG_KIND_TIMER, &module, 1U);
+}
+
+void vILOG_RecordServo(uint8_t gpio, uint32_t pulseUs)
+{
+    uint8_t body[1U + ILOG_VARINT_MAX_SIZE];
+
+    body[0] = gpio;
+    _append(ILOG_KIND_SERVO, body, 1U + _putVarint(&body[1], pulseUs));
+}
+
+void vILOG_SetEdgeInjector(ilogEdgeInjector_t injector)
+{
+    _edgeInjector = injector;
+}
+
+void vILOG_SetFrameInjector(ilogFrameInjector_t injector)
+{
+    _frameInjector = injector;
+}
+
+bool bILOG_LoadReplay(const uint8_t* pLog, uint32_t length)
+{
+    bool result = !_recording;
+
+    if (result) {
+        _pReplayLog = pLog;
+        _replayLength = length;
+    } else {
+        ESP_LOGE(TAG_ILOG, "Replay must be loaded before the log starts");
+    }
+
+    return result;
+}
+
+void vILOG_Start(void)
+{
+#if SYSTEM_INPUT_REPLAY_ENABLED
+    static const uint8_t embeddedLog[] = { ILOG_REPLAY_LOG_BYTES };
+
+    if (_pReplayLog == NULL) {
+        bILOG_LoadReplay(embeddedLog, ILOG_REPLAY_LOG_LENGTH);
+    }
+#endif
+
+    /* Replayed inputs are injected in the tick they were recorded in: both logs start on a tick */
+    vTaskDelay(1U);
+    printf("@IH %u %u\n", ILOG_VERSION, (uint32_t)configTICK_RATE_HZ);
+    portENTER_CRITICAL(&_logMux);
+    _originTick = xTaskGetTickCount();
+    _lastRecordUs = esp_timer_get_time();
+    _replaying = (_replayLength > 0U);
+    _recording = true;
+    portEXIT_CRITICAL(&_logMux);
+
+    if (_replaying) {
+        ESP_LOGI(TAG_ILOG, "Replaying %u bytes, live inputs are ignored", _replayLength);
+        OS_TASK_CREATE(_replayProcess, "Input replay", ILOG_REPLAY_TASK_STACK_SIZE, ILOG_REPLAY_TASK_PRIORITY, ILOG_REPLAY_TASK_CORE);
+    }
+}
+
+bool bILOG_IsReplaying(void)
+{
+    return _replaying;
+}
+
+void vILOG_Process(void* pvParameters)
+{
+    for (;;) {
+        _drain();
+        vTaskDelay(ILOG_DRAIN_PERIOD_TICKS);
+    }
+}
+
+/* Static functions */
+static void _append(ilogKind_e kind, const uint8_t* pBody, uint32_t bodySize)
+{
+    uint8_t record[ILOG_RECORD_MAX_SIZE];
+    uint32_t size = 0U;
+    int64_t nowUs = 0;
+
+    /* Time is taken under the lock: records are in time order whatever the core or context */
+    portENTER_CRITICAL_SAFE(&_logMux);
+    if (_recording) {
+        nowUs = esp_timer_get_time();
+        record[size++] = (uint8_t)kind;
+        size += _putVarint(&record[size], (uint64_t)(nowUs - _lastRecordUs));
+        size += _putVarint(&record[size], xTaskGetTickCountFromISR() - _originTick);
+        memcpy(&record[size], pBody, bodySize);
+        size += bodySize;
+        /* A dropped record leaves no gap in the timing: the next delta is taken from the last stored one */
+        if ((ILOG_BUFFER_SIZE - (_head - _tail)) >= size) {
+            for (uint32_t index = 0U; index < size; index++) {
+                _buffer[(_head + index) & (ILOG_BUFFER_SIZE - 1U)] = record[index];
+            }
+            __sync_synchronize();
+            _head += size;
+            _lastRecordUs = nowUs;
+        } else {
+            _dropped++;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&_logMux);
+}
+
+static uint32_t _putVarint(uint8_t* pBuffer, uint64_t value)
+{
+    uint32_t size = 0U;
+
+    /* LEB128: 7 bits per byte, low bits first, high bit set on all but the last byte */
+    do {
+        pBuffer[size] = (uint8_t)(value & 0x7FU);
+        value >>= 7;
+        if (value != 0U) {
+            pBuffer[size] |= 0x80U;
+        }
+        size++;
+    } while (value != 0U);
+
+    return size;
+}
+
+static bool _getVarint(uint32_t* pOffset, uint64_t* pValue)
+{
+    uint32_t shift = 0U;
+    bool result = false;
+
+    *pValue = 0U;
+    while ((*pOffset < _replayLength) && (shift < (7U * ILOG_VARINT_MAX_SIZE))) {
+        *pValue |= (uint64_t)(_pReplayLog[*pOffset] & 0x7FU) << shift;
+        shift += 7U;
+        if ((_pReplayLog[(*pOffset)++] & 0x80U) == 0U) {
+            result = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static bool _readRecord(uint32_t* pOffset, ilogRecord_t* pRecord)
+{
+    uint64_t value = 0U;
+    bool result = (*pOffset < _replayLength);
+
+    if (result) {
+        pRecord->kind = _pReplayLog[(*pOffset)++];
+        result = _getVarint(pOffset, &value) && _getVarint(pOffset, &value) && (*pOffset < _replayLength);
+        pRecord->tick = (uint32_t)value;
+    }
+    if (result) {
+        pRecord->source = _pReplayLog[(*pOffset)++];
+        pRecord->value = 0U;
+        pRecord->pPayload = NULL;
+        switch (pRecord->kind) {
+        case ILOG_KIND_EDGE:
+            result = (*pOffset < _replayLength);
+            pRecord->value = result ? _pReplayLog[(*pOffset)++] : 0U;
+            break;
+        case ILOG_KIND_FRAME:
+            result = (*pOffset < _replayLength) && ((*pOffset + 1U + _pReplayLog[*pOffset]) <= _replayLength);
+            if (result) {
+                pRecord->value = _pReplayLog[(*pOffset)++];
+                pRecord->pPayload = &_pReplayLog[*pOffset];
+                *pOffset += pRecord->value;
+            }
+            break;
+        case ILOG_KIND_TIMER:
+            break;
+        case ILOG_KIND_SERVO:
+            result = _getVarint(pOffset, &value);
+            pRecord->value = (uint32_t)value;
+            break;
+        default:
+            result = false;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void _replayProcess(void* pvParameters)
+{
+    ilogRecord_t record = { 0 };
+    TickType_t lastWakeTime = _originTick;
+    uint32_t offset = 0U;
+    uint32_t inputNumber = 0U;
+
+    /* Checkpoints (timer expiries, servo writes) are not replayed: the firmware produces them again */
+    while (_readRecord(&offset, &record)) {
+        if ((record.kind != ILOG_KIND_EDGE) && (record.kind != ILOG_KIND_FRAME)) {
+            continue;
+        }
+        if (TICK_IS_BEFORE(lastWakeTime, _originTick + record.tick)) {
+            vTaskDelayUntil(&lastWakeTime, (_originTick + record.tick) - lastWakeTime);
+        }
+        if ((record.kind == ILOG_KIND_EDGE) && (_edgeInjector != NULL)) {
+            _edgeInjector(record.source, record.value);
+        } else if ((record.kind == ILOG_KIND_FRAME) && (_frameInjector != NULL)) {
+            _frameInjector(record.source, record.pPayload, (uint8_t)record.value);
+        }
+        inputNumber++;
+    }
+    if (offset < _replayLength) {
+        ESP_LOGE(TAG_ILOG, "Replay log corrupted at byte %u", offset);
+    }
+
+    _replaying = false;
+    ESP_LOGI(TAG_ILOG, "Replay done, %u inputs", inputNumber);
+    vTaskDelete(NULL);
+}
+
+static void _drain(void)
+{
+    uint32_t tail = _tail;
+    uint32_t head = _head;
+    uint32_t dropped = _dropped;
+    char line[ILOG_LINE_SIZE];
+    uint32_t lineLength = 0U;
+
+    __sync_synchronize();
+    /* "@IL " then the log bytes in hex, records run over line ends */
+    while (tail != head) {
+        if (lineLength == 0U) {
+            lineLength = sprintf(line, "@IL ");
+        }
+        lineLength += sprintf(&line[lineLength], "%02x", _buffer[tail & (ILOG_BUFFER_SIZE - 1U)]);
+        tail++;
+        if ((lineLength + 2U >= sizeof(line)) || (tail == head)) {
+            /* Whole line in one call so it is not interleaved with console logs */
+            printf("%s\n", line);
+            lineLength = 0U;
+        }
+    }
+    __sync_synchronize();
+    _tail = tail;
+
+    if (dropped != _reportedDropped) {
+        printf("@ID %u\n", dropped);
+        _reportedDropped = dropped;
+    }
+}
+
+#endif
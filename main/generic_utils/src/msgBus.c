@@ -0,0 +1,156 @@
+/**
+******************************************************************************
+* @file 	msgBus.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "msgBus.h"
+
+/* Define */
+#define TAG_BUS ("BUS")
+#define BUS_BLOCK_SIZE(payloadSize) (sizeof(busHeader_t) + (payloadSize))
+
+/* Enum */
+typedef enum {
+    BUS_POOL_SMALL = 0,
+    BUS_POOL_LARGE,
+    /* Do not erase */
+    BUS_POOL_NUMBER
+} busPool_e;
+
+/* Struct */
+typedef struct {
+    busTopic_e topic;
+    uint8_t pool;
+    uint8_t block;
+    uint8_t refCount;
+    uint8_t reserved;
+} busHeader_t;
+
+typedef struct {
+    uint8_t* pBlocks;
+    uint32_t payloadSize;
+    uint8_t blockNumber;
+    uint32_t usedBitmap;
+} busPool_t;
+
+/* Static prototypes */
+static busHeader_t* _getHeader(const void* pPayload);
+static void _retain(busHeader_t* pHeader);
+
+/* Static variables */
+static uint8_t _smallBlocks[BUS_SMALL_BLOCK_NUMBER][BUS_BLOCK_SIZE(BUS_SMALL_PAYLOAD_SIZE)] __attribute__((aligned(8)));
+static uint8_t _largeBlocks[BUS_LARGE_BLOCK_NUMBER][BUS_BLOCK_SIZE(BUS_LARGE_PAYLOAD_SIZE)] __attribute__((aligned(8)));
+static busPool_t _pools[BUS_POOL_NUMBER] = {
+    [BUS_POOL_SMALL] = { &_smallBlocks[0][0], BUS_SMALL_PAYLOAD_SIZE, BUS_SMALL_BLOCK_NUMBER, 0U },
+    [BUS_POOL_LARGE] = { &_largeBlocks[0][0], BUS_LARGE_PAYLOAD_SIZE, BUS_LARGE_BLOCK_NUMBER, 0U },
+};
+static QueueHandle_t _subscribers[BUS_TOPIC_NUMBER][BUS_MAX_SUBSCRIBERS] = { { NULL } };
+static uint8_t _subscriberNumber[BUS_TOPIC_NUMBER] = { 0U };
+static portMUX_TYPE _busMux = portMUX_INITIALIZER_UNLOCKED;
+
+_Static_assert((BUS_SMALL_BLOCK_NUMBER <= 32U) && (BUS_LARGE_BLOCK_NUMBER <= 32U), "Pool usage is tracked in a 32 bits bitmap");
+_Static_assert((sizeof(busHeader_t) % 8U) == 0U, "Payloads must stay 8 bytes aligned");
+
+/* Public functions */
+bool bBUS_Subscribe(busTopic_e topic, QueueHandle_t queue)
+{
+    bool result = false;
+
+    portENTER_CRITICAL(&_busMux);
+    if ((topic < BUS_TOPIC_NUMBER) && (queue != NULL) && (_subscriberNumber[topic] < BUS_MAX_SUBSCRIBERS)) {
+        _subscribers[topic][_subscriberNumber[topic]++] = queue;
+        result = true;
+    }
+    portEXIT_CRITICAL(&_busMux);
+
+    return result;
+}
+
+void* pBUS_Alloc(busTopic_e topic, uint32_t size)
+{
+    busHeader_t* pHeader = NULL;
+    busPool_t* pPool = NULL;
+    uint8_t block = 0U;
+
+    /* Smallest pool that fits, larger pools are used as overflow */
+    for (uint8_t pool = 0U; (pool < BUS_POOL_NUMBER) && (pHeader == NULL); pool++) {
+        pPool = &_pools[pool];
+        if (size <= pPool->payloadSize) {
+            portENTER_CRITICAL(&_busMux);
+            for (block = 0U; block < pPool->blockNumber; block++) {
+                if ((pPool->usedBitmap & BIT(block)) == 0U) {
+                    pPool->usedBitmap |= BIT(block);
+                    pHeader = (busHeader_t*)&pPool->pBlocks[block * BUS_BLOCK_SIZE(pPool->payloadSize)];
+                    pHeader->topic = topic;
+                    pHeader->pool = pool;
+                    pHeader->block = block;
+                    pHeader->refCount = 1U;
+                    break;
+                }
+            }
+            portEXIT_CRITICAL(&_busMux);
+        }
+    }
+
+    if (pHeader == NULL) {
+        ESP_LOGW(TAG_BUS, "No free block for topic %d (%u bytes)", topic, size);
+    }
+
+    return (pHeader != NULL) ? (void*)(pHeader + 1) : NULL;
+}
+
+uint8_t u8BUS_Publish(void* pPayload)
+{
+    busHeader_t* pHeader = _getHeader(pPayload);
+    busTopic_e topic = pHeader->topic;
+    uint8_t delivered = 0U;
+
+    for (uint8_t subscriber = 0U; subscriber < _subscriberNumber[topic]; subscriber++) {
+        /* One reference per queued pointer */
+        _retain(pHeader);
+        if (bOS_QueueSend(_subscribers[topic][subscriber], &pPayload, WRITE_IN_QUEUE_DEFAULT_TIMEOUT)) {
+            delivered++;
+        } else {
+            ESP_LOGW(TAG_BUS, "Subscriber %u of topic %d is full", subscriber, topic);
+            vBUS_Release(pPayload);
+        }
+    }
+    /* Publisher reference */
+    vBUS_Release(pPayload);
+
+    return delivered;
+}
+
+void vBUS_Release(void* pPayload)
+{
+    busHeader_t* pHeader = _getHeader(pPayload);
+
+    portENTER_CRITICAL(&_busMux);
+    configASSERT(pHeader->refCount > 0U);
+    pHeader->refCount--;
+    if (pHeader->refCount == 0U) {
+        _pools[pHeader->pool].usedBitmap &= ~BIT(pHeader->block);
+    }
+    portEXIT_CRITICAL(&_busMux);
+}
+
+busTopic_e eBUS_GetTopic(const void* pPayload)
+{
+    return _getHeader(pPayload)->topic;
+}
+
+/* Static functions */
+static busHeader_t* _getHeader(const void* pPayload)
+{
+    return (busHeader_t*)pPayload - 1;
+}
+
+static void _retain(busHeader_t* pHeader)
+{
+    portENTER_CRITICAL(&_busMux);
+    pHeader->refCount++;
+    portEXIT_CRITICAL(&_busMux);
+}
@@ -7,6 +7,30 @@
 */
 
 #include "osUtils.h"
+#include "esp_ipc.h"
+#include "esp_timer.h"
+#include "reactor.h"
+
+#define TAG_OS ("OS")
+
+typedef struct {
+    const char* name;
+    uint32_t size;
+} ramUsage_t;
+
+static ramUsage_t _ramBudget[OS_RAM_BUDGET_MAX_ENTRIES] = { 0 };
+static uint8_t _ramBudgetEntries = 0U;
+static uint32_t _ramBudgetUntracked = 0U;
+static portMUX_TYPE _ramBudgetMux = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t _statsQueues[OS_QUEUE_STATS_MAX_ENTRIES] = { NULL };
+static osQueueStats_t _queueStats[OS_QUEUE_STATS_MAX_ENTRIES] = { 0 };
+static uint8_t _queueStatsEntries = 0U;
+static portMUX_TYPE _queueStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool _queueSend(QueueHandle_t queue, const void* pItem, TickType_t timeout, BaseType_t position);
+static bool _queueSendFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken, BaseType_t position);
+static osQueueStats_t* _getQueueStats(QueueHandle_t queue);
+static void _dumpQueueStats(TimerHandle_t timer);
 
 void vOS_DeleteQueue(QueueHandle_t* pQueueToDelete)
 {
@@ -46,6 +70,19 @@ bool bOS_IsQueueReadyForSending(QueueHandle_t queueToSend, uint32_t startTime, u
     return result;
 }
 
+bool bOS_IsResponseAwaited(const queueContext_t* pQueueContext)
+{
+    bool result = true;
+
+    /* Only the times carried by the request are read, the requester stack may already be gone */
+    if (pQueueContext->expirationTime != portMAX_DELAY) {
+        result = (pQueueContext->expirationTime > 1U)
+            && ((xTaskGetTickCount() - pQueueContext->creationTime) < (pQueueContext->expirationTime - 1U));
+    }
+
+    return result;
+}
+
 void vOS_CreateResponseQueue(queueContext_t* pQueueContext, QueueHandle_t* pQueue, TickType_t queueTimeout)
 {
     pQueueContext->pQueueHandle = pQueue;
@@ -63,13 +100,30 @@ void vOS_QueueSendSafe(queueContext_t* pQueueContext, void* item)
 bool bOS_SendToTaskAndWaitResponse(QueueHandle_t queueToSend, void* pEvent, queueContext_t* pReponseQueue, void* pResponse, uint8_t reponseSize, portTickType timeout)
 {
     bool result = false;
+    bool dispatchedInline = false;
+#if SYSTEM_STATIC_ALLOCATION
+    /* Response queue lives on the caller stack for the duration of the request */
+    StaticQueue_t responseQueueBuffer;
+    uint8_t responseQueueStorage[OS_RESPONSE_MAX_SIZE];
+    QueueHandle_t responseQueue = NULL;
+
+    configASSERT(reponseSize <= OS_RESPONSE_MAX_SIZE);
+    responseQueue = xQueueCreateStatic(1U, reponseSize, responseQueueStorage, &responseQueueBuffer);
+#else
     QueueHandle_t responseQueue = xQueueCreate(1U, reponseSize);
+#endif
 
     pReponseQueue->pQueueHandle = &responseQueue;
     pReponseQueue->expirationTime = timeout;
     pReponseQueue->creationTime = xTaskGetTickCount();
-    if (queueToSend != NULL) {
-        if (xQueueSend(queueToSend, pEvent, 0U) == pdTRUE) {
+#if SYSTEM_SINGLE_TASK_REACTOR
+    dispatchedInline = bREACTOR_DispatchInline(queueToSend, pEvent);
+#endif
+    if (dispatchedInline) {
+        /* Target module already answered in the caller context */
+        result = (xQueueReceive(responseQueue, pResponse, 0U) == pdTRUE);
+    } else if (queueToSend != NULL) {
+        if (bOS_QueueSend(queueToSend, pEvent, 0U)) {
             if (xQueueReceive(responseQueue, pResponse, timeout) == pdTRUE) {
                 result = true;
             }
@@ -79,3 +133,176 @@ bool bOS_SendToTaskAndWaitResponse(QueueHandle_t queueToSend, void* pEvent, queu
 
     return result;
 }
+
+void vOS_RegisterRamUsage(const char* name, uint32_t size)
+{
+    portENTER_CRITICAL(&_ramBudgetMux);
+    if (_ramBudgetEntries < OS_RAM_BUDGET_MAX_ENTRIES) {
+        _ramBudget[_ramBudgetEntries].name = name;
+        _ramBudget[_ramBudgetEntries].size = size;
+        _ramBudgetEntries++;
+    } else {
+        _ramBudgetUntracked += size;
+    }
+    portEXIT_CRITICAL(&_ramBudgetMux);
+}
+
+void vOS_PrintRamBudget(void)
+{
+    uint32_t total = _ramBudgetUntracked;
+
+    ESP_LOGI(TAG_OS, "RAM budget (%s):", SYSTEM_STATIC_ALLOCATION ? "static" : "heap");
+    for (uint8_t entry = 0U; entry < _ramBudgetEntries; entry++) {
+        ESP_LOGI(TAG_OS, "  %-24s %6u B", _ramBudget[entry].name, _ramBudget[entry].size);
+        total += _ramBudget[entry].size;
+    }
+    if (_ramBudgetUntracked > 0U) {
+        ESP_LOGW(TAG_OS, "  %-24s %6u B", "Untracked", _ramBudgetUntracked);
+    }
+    ESP_LOGI(TAG_OS, "  %-24s %6u B, free heap %u B", "Total", total, esp_get_free_heap_size());
+}
+
+void vOS_RegisterQueueStats(QueueHandle_t queue, const char* name, uint32_t length)
+{
+    portENTER_CRITICAL(&_queueStatsMux);
+    if ((queue != NULL) && (_queueStatsEntries < OS_QUEUE_STATS_MAX_ENTRIES)) {
+        _queueStats[_queueStatsEntries].name = name;
+        _queueStats[_queueStatsEntries].length = length;
+        _statsQueues[_queueStatsEntries] = queue;
+        _queueStatsEntries++;
+    }
+    portEXIT_CRITICAL(&_queueStatsMux);
+}
+
+bool bOS_QueueSend(QueueHandle_t queue, const void* pItem, TickType_t timeout)
+{
+    return _queueSend(queue, pItem, timeout, queueSEND_TO_BACK);
+}
+
+bool bOS_QueueSendToFront(QueueHandle_t queue, const void* pItem, TickType_t timeout)
+{
+    return _queueSend(queue, pItem, timeout, queueSEND_TO_FRONT);
+}
+
+bool bOS_QueueSendFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken)
+{
+    return _queueSendFromISR(queue, pItem, pHigherTaskWoken, queueSEND_TO_BACK);
+}
+
+bool bOS_QueueSendToFrontFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken)
+{
+    return _queueSendFromISR(queue, pItem, pHigherTaskWoken, queueSEND_TO_FRONT);
+}
+
+uint8_t u8OS_GetQueueStats(osQueueStats_t* pStats, uint8_t maxEntries)
+{
+    uint8_t entries = 0U;
+
+    portENTER_CRITICAL(&_queueStatsMux);
+    entries = (_queueStatsEntries < maxEntries) ? _queueStatsEntries : maxEntries;
+    memcpy(pStats, _queueStats, entries * sizeof(osQueueStats_t));
+    portEXIT_CRITICAL(&_queueStatsMux);
+
+    return entries;
+}
+
+void vOS_StartQueueStatsDump(TickType_t period)
+{
+    TimerHandle_t dumpTimer = OS_TIMER_CREATE("Timer queue stats", period, pdTRUE, NULL, _dumpQueueStats);
+
+    if ((dumpTimer == NULL) || (xTimerStart(dumpTimer, TIMER_API_DEFAULT_TIMEOUT) != pdPASS)) {
+        ESP_LOGE(TAG_OS, "Cannot start queue stats dump");
+    }
+}
+
+bool bOS_RunOnCore(BaseType_t core, void (*function)(void*), void* pArg)
+{
+    bool result = true;
+
+    core = OS_CORE(core);
+    if ((core == tskNO_AFFINITY) || (core == xPortGetCoreID())) {
+        function(pArg);
+    } else {
+        /* Runs in the IPC task of that core, blocking until done: see CONFIG_ESP_IPC_TASK_STACK_SIZE */
+        result = (esp_ipc_call_blocking((uint32_t)core, function, pArg) == ESP_OK);
+    }
+
+    return result;
+}
+
+static bool _queueSend(QueueHandle_t queue, const void* pItem, TickType_t timeout, BaseType_t position)
+{
+    osQueueStats_t* pStats = _getQueueStats(queue);
+    int64_t startUs = esp_timer_get_time();
+    bool result = (xQueueGenericSend(queue, pItem, timeout, position) == pdTRUE);
+    uint32_t blockedUs = (uint32_t)(esp_timer_get_time() - startUs);
+    uint32_t depth = uxQueueMessagesWaiting(queue);
+
+    if (pStats != NULL) {
+        portENTER_CRITICAL(&_queueStatsMux);
+        if (result) {
+            pStats->sendCount++;
+            if (depth > pStats->highWaterMark) {
+                pStats->highWaterMark = depth;
+            }
+        } else if (timeout == 0U) {
+            pStats->failedSends++;
+        } else {
+            pStats->timeouts++;
+        }
+        if ((timeout != 0U) && (blockedUs > pStats->maxBlockedUs)) {
+            pStats->maxBlockedUs = blockedUs;
+        }
+        portEXIT_CRITICAL(&_queueStatsMux);
+    }
+
+    return result;
+}
+
+static bool _queueSendFromISR(QueueHandle_t queue, const void* pItem, BaseType_t* pHigherTaskWoken, BaseType_t position)
+{
+    osQueueStats_t* pStats = _getQueueStats(queue);
+    bool result = (xQueueGenericSendFromISR(queue, pItem, pHigherTaskWoken, position) == pdTRUE);
+    uint32_t depth = uxQueueMessagesWaitingFromISR(queue);
+
+    if (pStats != NULL) {
+        portENTER_CRITICAL_ISR(&_queueStatsMux);
+        if (result) {
+            pStats->sendCount++;
+            if (depth > pStats->highWaterMark) {
+                pStats->highWaterMark = depth;
+            }
+        } else {
+            pStats->failedSends++;
+        }
+        portEXIT_CRITICAL_ISR(&_queueStatsMux);
+    }
+
+    return result;
+}
+
+static osQueueStats_t* _getQueueStats(QueueHandle_t queue)
+{
+    osQueueStats_t* pStats = NULL;
+
+    /* Entries are only appended, a stale count just misses the newest queue */
+    for (uint8_t entry = 0U; entry < _queueStatsEntries; entry++) {
+        if (_statsQueues[entry] == queue) {
+            pStats = &_queueStats[entry];
+            break;
+        }
+    }
+
+    return pStats;
+}
+
+static void _dumpQueueStats(TimerHandle_t timer)
+{
+    osQueueStats_t stats[OS_QUEUE_STATS_MAX_ENTRIES];
+    uint8_t entries = u8OS_GetQueueStats(stats, OS_QUEUE_STATS_MAX_ENTRIES);
+
+    ESP_LOGI(TAG_OS, "%-24s %5s %5s %8s %6s %8s %10s", "Queue", "depth", "max", "sent", "failed", "timeouts", "blocked us");
+    for (uint8_t entry = 0U; entry < entries; entry++) {
+        ESP_LOGI(TAG_OS, "%-24s %5u %5u %8u %6u %8u %10u", stats[entry].name, stats[entry].length, stats[entry].highWaterMark, stats[entry].sendCount, stats[entry].failedSends, stats[entry].timeouts, stats[entry].maxBlockedUs);
+    }
+}
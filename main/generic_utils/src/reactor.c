@@ -0,0 +1,236 @@
+/**
+******************************************************************************
+* @file 	reactor.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "reactor.h"
+#include "inputLog.h"
+#include "taskMonitor.h"
+#include "trace.h"
+
+/* Define */
+#define TAG_REACTOR ("REACTOR")
+#define NO_HEAP_POSITION (0xFFU)
+#define TICK_IS_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/* Struct */
+typedef struct {
+    TickType_t deadline;
+    uint8_t moduleIndex;
+} reactorTimer_t;
+
+/* Static prototypes */
+static void _dispatch(uint8_t moduleIndex, void* pEvent);
+static void _armTimer(uint8_t moduleIndex, TickType_t blockTime);
+static void _removeTimer(uint8_t moduleIndex);
+static void _siftUp(uint8_t position);
+static void _siftDown(uint8_t position);
+static void _swapTimers(uint8_t positionA, uint8_t positionB);
+
+/* Static variables */
+static const reactorModule_t* _modules[REACTOR_MAX_MODULES] = { NULL };
+static uint8_t _moduleNumber = 0U;
+static TaskHandle_t _reactorTask = NULL;
+static reactorTimer_t _timerHeap[REACTOR_MAX_MODULES] = { 0 };
+static uint8_t _timerPosition[REACTOR_MAX_MODULES] = { [0 ... REACTOR_MAX_MODULES - 1] = NO_HEAP_POSITION };
+static uint8_t _timerNumber = 0U;
+static uint8_t _eventBuffer[REACTOR_EVENT_BUFFER_SIZE] __attribute__((aligned(8)));
+
+/* Public functions */
+void vREACTOR_RunModule(const reactorModule_t* pModule)
+{
+    uint8_t event[REACTOR_EVENT_BUFFER_SIZE] __attribute__((aligned(8)));
+    TickType_t blockTime = portMAX_DELAY;
+
+    configASSERT(pModule->eventSize <= sizeof(event));
+    if (!bBOOT_WaitDependencies(pModule->bootModule)) {
+        /* Initialized anyway, callers need its queue: requests to a missing dependency fail on their own */
+        ESP_LOGE(TAG_REACTOR, "%s runs degraded", pModule->name);
+    }
+    pModule->init();
+    vBOOT_SignalReady(pModule->bootModule);
+
+    for (;;) {
+        if (xQueueReceive(*pModule->pQueue, event, blockTime) == pdTRUE) {
+            TMON_COUNT_WAKEUP();
+            TRACE_EVENT(TRACE_ID_QUEUE_RECEIVE, pModule->bootModule, 0U);
+            blockTime = pModule->handleEvent(event);
+        } else {
+            TMON_COUNT_WAKEUP();
+            TRACE_EVENT(TRACE_ID_TIMER_EXPIRY, pModule->bootModule, 0U);
+            ILOG_TIMER(pModule->bootModule);
+            blockTime = pModule->handleEvent(NULL);
+        }
+    }
+}
+
+bool bREACTOR_RegisterModule(const reactorModule_t* pModule)
+{
+    bool result = false;
+
+    /* Modules are registered from app_main, in dependency order, before the reactor task starts */
+    if ((_moduleNumber < REACTOR_MAX_MODULES) && (pModule->eventSize <= REACTOR_EVENT_BUFFER_SIZE)) {
+        _modules[_moduleNumber++] = pModule;
+        result = true;
+    } else {
+        ESP_LOGE(TAG_REACTOR, "Cannot register module %s", pModule->name);
+    }
+
+    return result;
+}
+
+void vREACTOR_Process(void* pvParameters)
+{
+    QueueSetHandle_t queueSet = NULL;
+    QueueSetMemberHandle_t activeQueue = NULL;
+    TickType_t blockTime = portMAX_DELAY;
+    uint32_t setLength = 0U;
+    uint8_t moduleIndex = 0U;
+
+    _reactorTask = xTaskGetCurrentTaskHandle();
+    for (moduleIndex = 0U; moduleIndex < _moduleNumber; moduleIndex++) {
+        setLength += _modules[moduleIndex]->queueLength;
+    }
+    /* No static variant of queue sets in this FreeRTOS port, the set is the only heap object */
+    queueSet = xQueueCreateSet(setLength);
+
+    /* Sequential init: registration order must satisfy the boot dependencies */
+    for (moduleIndex = 0U; moduleIndex < _moduleNumber; moduleIndex++) {
+        if (!bBOOT_WaitDependencies(_modules[moduleIndex]->bootModule)) {
+            ESP_LOGE(TAG_REACTOR, "%s runs degraded", _modules[moduleIndex]->name);
+        }
+        _modules[moduleIndex]->init();
+        vBOOT_SignalReady(_modules[moduleIndex]->bootModule);
+        if (xQueueAddToSet(*_modules[moduleIndex]->pQueue, queueSet) != pdPASS) {
+            ESP_LOGE(TAG_REACTOR, "Cannot add %s queue to set", _modules[moduleIndex]->name);
+        }
+    }
+
+    for (;;) {
+        blockTime = portMAX_DELAY;
+        if (_timerNumber > 0U) {
+            blockTime = TICK_IS_BEFORE(xTaskGetTickCount(), _timerHeap[0].deadline) ? (_timerHeap[0].deadline - xTaskGetTickCount()) : 0U;
+        }
+
+        activeQueue = xQueueSelectFromSet(queueSet, blockTime);
+        TMON_COUNT_WAKEUP();
+        if (activeQueue != NULL) {
+            for (moduleIndex = 0U; moduleIndex < _moduleNumber; moduleIndex++) {
+                if (*_modules[moduleIndex]->pQueue == (QueueHandle_t)activeQueue) {
+                    /* Queue may have been reset since it was selected */
+                    if (xQueueReceive(activeQueue, _eventBuffer, 0U) == pdTRUE) {
+                        TRACE_EVENT(TRACE_ID_QUEUE_RECEIVE, _modules[moduleIndex]->bootModule, 0U);
+                        _dispatch(moduleIndex, _eventBuffer);
+                    }
+                    break;
+                }
+            }
+        }
+
+        /* Expired module timeouts, earliest first */
+        while ((_timerNumber > 0U) && !TICK_IS_BEFORE(xTaskGetTickCount(), _timerHeap[0].deadline)) {
+            moduleIndex = _timerHeap[0].moduleIndex;
+            _removeTimer(moduleIndex);
+            TRACE_EVENT(TRACE_ID_TIMER_EXPIRY, _modules[moduleIndex]->bootModule, 0U);
+            ILOG_TIMER(_modules[moduleIndex]->bootModule);
+            _dispatch(moduleIndex, NULL);
+        }
+    }
+}
+
+bool bREACTOR_DispatchInline(QueueHandle_t queue, void* pEvent)
+{
+    bool result = false;
+
+    /* Synchronous requests between modules of the reactor task would deadlock on the response queue */
+    if ((_reactorTask != NULL) && (xTaskGetCurrentTaskHandle() == _reactorTask) && (queue != NULL)) {
+        for (uint8_t moduleIndex = 0U; moduleIndex < _moduleNumber; moduleIndex++) {
+            if (*_modules[moduleIndex]->pQueue == queue) {
+                _dispatch(moduleIndex, pEvent);
+                result = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Static functions */
+static void _dispatch(uint8_t moduleIndex, void* pEvent)
+{
+    _armTimer(moduleIndex, _modules[moduleIndex]->handleEvent(pEvent));
+}
+
+static void _armTimer(uint8_t moduleIndex, TickType_t blockTime)
+{
+    uint8_t position = _timerPosition[moduleIndex];
+
+    if (blockTime == portMAX_DELAY) {
+        _removeTimer(moduleIndex);
+    } else {
+        if (position == NO_HEAP_POSITION) {
+            position = _timerNumber++;
+            _timerHeap[position].moduleIndex = moduleIndex;
+            _timerPosition[moduleIndex] = position;
+        }
+        _timerHeap[position].deadline = xTaskGetTickCount() + blockTime;
+        _siftUp(position);
+        _siftDown(_timerPosition[moduleIndex]);
+    }
+}
+
+static void _removeTimer(uint8_t moduleIndex)
+{
+    uint8_t position = _timerPosition[moduleIndex];
+
+    if (position != NO_HEAP_POSITION) {
+        _timerNumber--;
+        _swapTimers(position, _timerNumber);
+        _timerPosition[moduleIndex] = NO_HEAP_POSITION;
+        if (position < _timerNumber) {
+            _siftUp(position);
+            _siftDown(_timerPosition[_timerHeap[position].moduleIndex]);
+        }
+    }
+}
+
+static void _siftUp(uint8_t position)
+{
+    while ((position > 0U) && TICK_IS_BEFORE(_timerHeap[position].deadline, _timerHeap[(position - 1U) / 2U].deadline)) {
+        _swapTimers(position, (position - 1U) / 2U);
+        position = (position - 1U) / 2U;
+    }
+}
+
+static void _siftDown(uint8_t position)
+{
+    uint8_t earliest = position;
+    uint8_t child = 0U;
+
+    for (;;) {
+        for (child = 2U * position + 1U; (child <= 2U * position + 2U) && (child < _timerNumber); child++) {
+            if (TICK_IS_BEFORE(_timerHeap[child].deadline, _timerHeap[earliest].deadline)) {
+                earliest = child;
+            }
+        }
+        if (earliest == position) {
+            break;
+        }
+        _swapTimers(position, earliest);
+        position = earliest;
+    }
+}
+
+static void _swapTimers(uint8_t positionA, uint8_t positionB)
+{
+    reactorTimer_t timer = _timerHeap[positionA];
+
+    _timerHeap[positionA] = _timerHeap[positionB];
+    _timerHeap[positionB] = timer;
+    _timerPosition[_timerHeap[positionA].moduleIndex] = positionA;
+    _timerPosition[_timerHeap[positionB].moduleIndex] = positionB;
+}
@@ -0,0 +1,102 @@
+/**
+******************************************************************************
+* @file 	stateMachine.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "stateMachine.h"
+#include "trace.h"
+
+/* Define */
+#define TAG_SM ("SM")
+#define TICK_IS_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/* Static prototypes */
+static void _enter(stateMachine_t* pMachine, uint8_t state);
+static TickType_t _getRemainingTicks(const stateMachine_t* pMachine);
+
+/* Public functions */
+void vSM_Start(stateMachine_t* pMachine, const smDefinition_t* pDefinition)
+{
+    configASSERT(pDefinition->initialState < pDefinition->stateNumber);
+    pMachine->pDefinition = pDefinition;
+    _enter(pMachine, pDefinition->initialState);
+}
+
+TickType_t xSM_Dispatch(stateMachine_t* pMachine, uint8_t event, void* pEvent)
+{
+    const smDefinition_t* pDefinition = pMachine->pDefinition;
+    const smTransition_t* pTransition = NULL;
+    uint8_t source = pMachine->state;
+    uint8_t target = 0U;
+    bool accepted = false;
+
+    if (event < pDefinition->eventNumber) {
+        /* An empty cell, no action and SM_STAY, ignores the event in this state */
+        pTransition = &pDefinition->pTransitions[(source * pDefinition->eventNumber) + event];
+        accepted = (pTransition->action != NULL) ? pTransition->action(pEvent) : true;
+        if (accepted && (pTransition->next != SM_STAY)) {
+            target = pTransition->next - 1U;
+            TRACE_EVENT(TRACE_ID_SM_TRANSITION, pDefinition->traceId, ((uint16_t)source << 8) | target);
+            ESP_LOGD(TAG_SM, "%s: %s -> %s (event %u)", pDefinition->name, pDefinition->pStates[source].name,
+                pDefinition->pStates[target].name, event);
+            if (pDefinition->pStates[source].exit != NULL) {
+                pDefinition->pStates[source].exit();
+            }
+            _enter(pMachine, target);
+        }
+    } else {
+        ESP_LOGE(TAG_SM, "%s: unknown event %u", pDefinition->name, event);
+    }
+
+    return _getRemainingTicks(pMachine);
+}
+
+TickType_t xSM_HandleTimeout(stateMachine_t* pMachine)
+{
+    TickType_t result = _getRemainingTicks(pMachine);
+
+    if (pMachine->timeoutArmed && (result == 0U)) {
+        pMachine->timeoutArmed = false;
+        result = xSM_Dispatch(pMachine, pMachine->pDefinition->pStates[pMachine->state].timeoutEvent, NULL);
+    }
+
+    return result;
+}
+
+void vSM_SetTimeout(stateMachine_t* pMachine, TickType_t ticks)
+{
+    pMachine->timeoutArmed = (ticks != portMAX_DELAY) && (pMachine->pDefinition->pStates[pMachine->state].timeoutEvent != SM_NO_EVENT);
+    pMachine->timeoutDeadline = xTaskGetTickCount() + ticks;
+}
+
+uint8_t u8SM_GetState(const stateMachine_t* pMachine)
+{
+    return pMachine->state;
+}
+
+/* Static functions */
+static void _enter(stateMachine_t* pMachine, uint8_t state)
+{
+    const smState_t* pState = &pMachine->pDefinition->pStates[state];
+
+    pMachine->state = state;
+    vSM_SetTimeout(pMachine, pState->timeoutTicks);
+    if (pState->entry != NULL) {
+        pState->entry();
+    }
+}
+
+static TickType_t _getRemainingTicks(const stateMachine_t* pMachine)
+{
+    TickType_t now = xTaskGetTickCount();
+    TickType_t result = portMAX_DELAY;
+
+    if (pMachine->timeoutArmed) {
+        result = TICK_IS_BEFORE(now, pMachine->timeoutDeadline) ? (pMachine->timeoutDeadline - now) : 0U;
+    }
+
+    return result;
+}
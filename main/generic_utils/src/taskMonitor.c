@@ -0,0 +1,204 @@
+/**
+******************************************************************************
+* @file 	taskMonitor.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "taskMonitor.h"
+#include "esp_timer.h"
+
+#if SYSTEM_TASK_MONITOR_ENABLED
+
+#if !CONFIG_FREERTOS_USE_TRACE_FACILITY || !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#error "Task monitor requires CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS"
+#endif
+
+/* Define */
+#define TAG_TMON ("TMON")
+#define TMON_NO_SLOT (0xFFU)
+
+/* Struct */
+typedef struct {
+    TaskHandle_t handle; /* NULL: free slot */
+    volatile uint32_t wakeups; /* Only incremented by the task itself */
+    uint32_t lastRunTime;
+    uint32_t lastWakeups;
+    uint32_t runTimeDeltas[TMON_WINDOW_SAMPLES];
+    uint32_t wakeupDeltas[TMON_WINDOW_SAMPLES];
+    bool seen;
+    tmonTaskStats_t stats;
+} tmonTask_t;
+
+/* Static prototypes */
+static void _sample(void);
+static uint8_t _getSlot(TaskHandle_t handle);
+static uint8_t _addSlot(TaskHandle_t handle);
+
+/* Static variables */
+static TaskStatus_t _systemState[TMON_MAX_TASKS] = { 0 };
+static tmonTask_t _tasks[TMON_MAX_TASKS] = { 0 };
+static uint32_t _elapsedDeltas[TMON_WINDOW_SAMPLES] = { 0 };
+static uint8_t _windowIndex = 0U;
+static int64_t _lastSampleUs = 0;
+static portMUX_TYPE _statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Public functions */
+void vTMON_Process(void* pvParameters)
+{
+    TickType_t lastWakeTime = xTaskGetTickCount();
+    uint32_t samplesSincePrint = 0U;
+
+    _lastSampleUs = esp_timer_get_time();
+    for (;;) {
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(TMON_SAMPLE_PERIOD_MS));
+        _sample();
+#if TMON_PRINT_PERIOD_MS > 0
+        if (++samplesSincePrint >= (TMON_PRINT_PERIOD_MS / TMON_SAMPLE_PERIOD_MS)) {
+            samplesSincePrint = 0U;
+            vTMON_PrintTaskStats();
+        }
+#endif
+    }
+}
+
+void vTMON_CountWakeup(void)
+{
+    uint8_t slot = _getSlot(xTaskGetCurrentTaskHandle());
+
+    /* Tasks are known after the first sample, earlier wakeups are not counted */
+    if (slot != TMON_NO_SLOT) {
+        _tasks[slot].wakeups++;
+    }
+}
+
+uint8_t u8TMON_GetTaskStats(tmonTaskStats_t* pStats, uint8_t maxEntries)
+{
+    uint8_t entries = 0U;
+
+    portENTER_CRITICAL(&_statsMux);
+    for (uint8_t slot = 0U; (slot < TMON_MAX_TASKS) && (entries < maxEntries); slot++) {
+        if (_tasks[slot].handle != NULL) {
+            memcpy(&pStats[entries++], &_tasks[slot].stats, sizeof(tmonTaskStats_t));
+        }
+    }
+    portEXIT_CRITICAL(&_statsMux);
+
+    return entries;
+}
+
+void vTMON_PrintTaskStats(void)
+{
+    static tmonTaskStats_t stats[TMON_MAX_TASKS];
+    uint8_t entries = u8TMON_GetTaskStats(stats, TMON_MAX_TASKS);
+
+    ESP_LOGI(TAG_TMON, "%-16s %4s %7s %7s %9s %10s", "Task", "prio", "load %", "window", "wakeup/s", "stack free");
+    for (uint8_t entry = 0U; entry < entries; entry++) {
+        ESP_LOGI(TAG_TMON, "%-16s %4u %5u.%u %5u.%u %9u %10u", stats[entry].name, (uint32_t)stats[entry].priority, stats[entry].loadPermille / 10U, stats[entry].loadPermille % 10U,
+            stats[entry].windowLoadPermille / 10U, stats[entry].windowLoadPermille % 10U, stats[entry].wakeupsPerSecond, stats[entry].stackFreeMinBytes);
+    }
+}
+
+/* Static functions */
+static void _sample(void)
+{
+    uint32_t totalRunTime = 0U;
+    UBaseType_t taskNumber = uxTaskGetSystemState(_systemState, TMON_MAX_TASKS, &totalRunTime);
+    int64_t nowUs = esp_timer_get_time();
+    uint32_t elapsedUs = (uint32_t)(nowUs - _lastSampleUs);
+    uint32_t windowElapsedUs = 0U;
+    uint32_t windowRunTime = 0U;
+    uint32_t windowWakeups = 0U;
+    tmonTask_t* pTask = NULL;
+    uint8_t slot = 0U;
+
+    if (taskNumber == 0U) {
+        ESP_LOGE(TAG_TMON, "More than %u tasks, increase TMON_MAX_TASKS", TMON_MAX_TASKS);
+    }
+    _lastSampleUs = nowUs;
+    _elapsedDeltas[_windowIndex] = elapsedUs;
+    for (uint8_t sample = 0U; sample < TMON_WINDOW_SAMPLES; sample++) {
+        windowElapsedUs += _elapsedDeltas[sample];
+    }
+    for (slot = 0U; slot < TMON_MAX_TASKS; slot++) {
+        _tasks[slot].seen = false;
+    }
+
+    for (UBaseType_t index = 0U; index < taskNumber; index++) {
+        slot = _getSlot(_systemState[index].xHandle);
+        if (slot == TMON_NO_SLOT) {
+            slot = _addSlot(_systemState[index].xHandle);
+            if (slot == TMON_NO_SLOT) {
+                continue;
+            }
+            /* First sample only sets the reference */
+            _tasks[slot].lastRunTime = _systemState[index].ulRunTimeCounter;
+        }
+        pTask = &_tasks[slot];
+        pTask->seen = true;
+        /* Run time counters are esp_timer microseconds, unsigned deltas survive wrap around */
+        pTask->runTimeDeltas[_windowIndex] = _systemState[index].ulRunTimeCounter - pTask->lastRunTime;
+        pTask->lastRunTime = _systemState[index].ulRunTimeCounter;
+        pTask->wakeupDeltas[_windowIndex] = pTask->wakeups - pTask->lastWakeups;
+        pTask->lastWakeups += pTask->wakeupDeltas[_windowIndex];
+        windowRunTime = 0U;
+        windowWakeups = 0U;
+        for (uint8_t sample = 0U; sample < TMON_WINDOW_SAMPLES; sample++) {
+            windowRunTime += pTask->runTimeDeltas[sample];
+            windowWakeups += pTask->wakeupDeltas[sample];
+        }
+
+        portENTER_CRITICAL(&_statsMux);
+        strncpy(pTask->stats.name, _systemState[index].pcTaskName, configMAX_TASK_NAME_LEN - 1U);
+        pTask->stats.priority = _systemState[index].uxCurrentPriority;
+        /* Same value as uxTaskGetStackHighWaterMark, in bytes on this port */
+        pTask->stats.stackFreeMinBytes = _systemState[index].usStackHighWaterMark * sizeof(StackType_t);
+        pTask->stats.loadPermille = (elapsedUs > 0U) ? (uint16_t)((uint64_t)pTask->runTimeDeltas[_windowIndex] * 1000U / elapsedUs) : 0U;
+        pTask->stats.windowLoadPermille = (windowElapsedUs > 0U) ? (uint16_t)((uint64_t)windowRunTime * 1000U / windowElapsedUs) : 0U;
+        pTask->stats.wakeupsPerSecond = (windowElapsedUs > 0U) ? (uint32_t)((uint64_t)windowWakeups * 1000000U / windowElapsedUs) : 0U;
+        portEXIT_CRITICAL(&_statsMux);
+    }
+
+    /* Deleted tasks free their slot */
+    portENTER_CRITICAL(&_statsMux);
+    for (slot = 0U; slot < TMON_MAX_TASKS; slot++) {
+        if (!_tasks[slot].seen && (_tasks[slot].handle != NULL)) {
+            memset(&_tasks[slot], 0, sizeof(tmonTask_t));
+        }
+    }
+    portEXIT_CRITICAL(&_statsMux);
+    _windowIndex = (_windowIndex + 1U) % TMON_WINDOW_SAMPLES;
+}
+
+static uint8_t _getSlot(TaskHandle_t handle)
+{
+    uint8_t result = TMON_NO_SLOT;
+
+    for (uint8_t slot = 0U; slot < TMON_MAX_TASKS; slot++) {
+        if (_tasks[slot].handle == handle) {
+            result = slot;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static uint8_t _addSlot(TaskHandle_t handle)
+{
+    uint8_t result = TMON_NO_SLOT;
+
+    for (uint8_t slot = 0U; slot < TMON_MAX_TASKS; slot++) {
+        if (_tasks[slot].handle == NULL) {
+            memset(&_tasks[slot], 0, sizeof(tmonTask_t));
+            _tasks[slot].handle = handle;
+            result = slot;
+            break;
+        }
+    }
+
+    return result;
+}
+
+#endif //SYSTEM_TASK_MONITOR_ENABLED
@@ -0,0 +1,112 @@
+/**
+******************************************************************************
+* @file 	trace.c
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+#include "trace.h"
+#include "xtensa/hal.h"
+
+/* Define */
+#define TRACE_RECORD_TEXT_SIZE (16U)
+#define TRACE_LINE_SIZE (8U + 8U * TRACE_RECORD_TEXT_SIZE + 1U)
+#define TRACE_DRAIN_PERIOD_TICKS (pdMS_TO_TICKS(100U))
+
+/* Struct */
+typedef struct {
+    uint32_t cycles;
+    uint8_t id;
+    uint8_t arg0;
+    uint16_t arg1;
+} traceRecord_t;
+
+/* Single producer (its core, interrupts masked) and single consumer (drain task) */
+typedef struct {
+    traceRecord_t records[TRACE_BUFFER_RECORDS];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+} traceBuffer_t;
+
+/* Static prototypes */
+static void _drainBuffer(uint8_t core);
+
+/* Static variables */
+static traceBuffer_t _buffers[portNUM_PROCESSORS] = { 0 };
+static uint32_t _reportedDropped[portNUM_PROCESSORS] = { 0 };
+
+_Static_assert((TRACE_BUFFER_RECORDS & (TRACE_BUFFER_RECORDS - 1U)) == 0U, "Trace buffer size must be a power of two");
+
+/* Public functions */
+void vTRACE_Record(traceEvent_e id, uint8_t arg0, uint16_t arg1)
+{
+    /* Masking interrupts also prevents the caller from migrating to the other core */
+    UBaseType_t savedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    traceBuffer_t* pBuffer = &_buffers[xPortGetCoreID()];
+    traceRecord_t* pRecord = NULL;
+    uint32_t head = pBuffer->head;
+
+    if ((head - pBuffer->tail) < TRACE_BUFFER_RECORDS) {
+        pRecord = &pBuffer->records[head & (TRACE_BUFFER_RECORDS - 1U)];
+        pRecord->cycles = xthal_get_ccount();
+        pRecord->id = (uint8_t)id;
+        pRecord->arg0 = arg0;
+        pRecord->arg1 = arg1;
+        /* Record must be visible before the drain task sees the new head */
+        __sync_synchronize();
+        pBuffer->head = head + 1U;
+    } else {
+        pBuffer->dropped++;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(savedInterruptStatus);
+}
+
+void vTRACE_Process(void* pvParameters)
+{
+    /* Header line: CPU frequency to convert cycles, record size */
+    printf("@TH %u %u\n", CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, (uint32_t)sizeof(traceRecord_t));
+
+    for (;;) {
+        for (uint8_t core = 0U; core < portNUM_PROCESSORS; core++) {
+            _drainBuffer(core);
+        }
+        vTaskDelay(TRACE_DRAIN_PERIOD_TICKS);
+    }
+}
+
+/* Static functions */
+static void _drainBuffer(uint8_t core)
+{
+    traceBuffer_t* pBuffer = &_buffers[core];
+    traceRecord_t* pRecord = NULL;
+    uint32_t tail = pBuffer->tail;
+    uint32_t head = pBuffer->head;
+    uint32_t dropped = pBuffer->dropped;
+    char line[TRACE_LINE_SIZE];
+    uint32_t lineLength = 0U;
+
+    __sync_synchronize();
+    /* "@TR <core> " then per record: cycles (8 hex digits), id (2), arg0 (2), arg1 (4) */
+    while (tail != head) {
+        if (lineLength == 0U) {
+            lineLength = sprintf(line, "@TR %u ", core);
+        }
+        pRecord = &pBuffer->records[tail & (TRACE_BUFFER_RECORDS - 1U)];
+        lineLength += sprintf(&line[lineLength], "%08x%02x%02x%04x", pRecord->cycles, pRecord->id, pRecord->arg0, pRecord->arg1);
+        tail++;
+        if ((lineLength + TRACE_RECORD_TEXT_SIZE >= sizeof(line)) || (tail == head)) {
+            /* Whole line in one call so it is not interleaved with console logs */
+            printf("%s\n", line);
+            lineLength = 0U;
+        }
+    }
+    __sync_synchronize();
+    pBuffer->tail = tail;
+
+    if (dropped != _reportedDropped[core]) {
+        printf("@TD %u %u\n", core, dropped);
+        _reportedDropped[core] = dropped;
+    }
+}
@@ -6,23 +6,99 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include "benchmark.h"
+#include "boot.h"
 #include "buttons.h"
 #include "buttonsManager.h"
+#include "deadlineMonitor.h"
+#include "deferredLog.h"
 #include "esp_spi_flash.h"
+#include "inputLog.h"
 #include "leds.h"
 #include "movementManager.h"
+#include "nvs_flash.h"
+#include "poseTracker.h"
+#include "power.h"
+#include "reactor.h"
+#include "remoteManager.h"
 #include "sequenceManager.h"
 #include "servo.h"
+#include "taskMonitor.h"
+#include "trace.h"
 
 void app_main()
 {
+    esp_err_t nvsResult = ESP_OK;
+
+    vBOOT_Init();
+    /* Servo calibration tables are read when the servos register */
+    nvsResult = nvs_flash_init();
+    if ((nvsResult == ESP_ERR_NVS_NO_FREE_PAGES) || (nvsResult == ESP_ERR_NVS_NEW_VERSION_FOUND)) {
+        /* Partition layout changed, servos fall back to their linear tables */
+        nvs_flash_erase();
+        nvsResult = nvs_flash_init();
+    }
+    if (nvsResult != ESP_OK) {
+        ESP_LOGE("MAIN", "NVS unavailable (%d), servo calibrations not persisted", nvsResult);
+    }
+    /* Before any driver arms its wake up pins or creates its locks */
+    vPWR_Init();
+    OS_TASK_CREATE(vDLOG_Process, "Deferred logs", DLOG_TASK_STACK_SIZE, DLOG_TASK_PRIORITY, DLOG_TASK_CORE);
+    /* Pose tracker must hook the servo driver before any order is applied */
+    vPOSE_Init();
+#if SYSTEM_BENCHMARK_ENABLED
+    vBENCH_Init();
+#endif
+#if SYSTEM_TASK_MONITOR_ENABLED
+    OS_TASK_CREATE(vTMON_Process, "Task monitor", TMON_TASK_STACK_SIZE, TMON_TASK_PRIORITY, TMON_TASK_CORE);
+#endif
+#if SYSTEM_INPUT_LOG_ENABLED
+    OS_TASK_CREATE(vILOG_Process, "Input log", ILOG_TASK_STACK_SIZE, ILOG_TASK_PRIORITY, ILOG_TASK_CORE);
+#endif
+#if SYSTEM_TRACE_ENABLED
+    OS_TASK_CREATE(vTRACE_Process, "Trace drain", TRACE_TASK_STACK_SIZE, TRACE_TASK_PRIORITY, TRACE_TASK_CORE);
+#endif
+
+#if SYSTEM_SINGLE_TASK_REACTOR
+    /* Modules registration, in dependency order: drivers, then managers */
+    bREACTOR_RegisterModule(pBUT_GetReactorModule());
+    bREACTOR_RegisterModule(pSERVO_GetReactorModule());
+    bREACTOR_RegisterModule(pLED_GetReactorModule());
+    bREACTOR_RegisterModule(pMVT_GetReactorModule());
+    bREACTOR_RegisterModule(pSEQMNGR_GetReactorModule());
+    bREACTOR_RegisterModule(pBUTMNGR_GetReactorModule());
+
+    OS_TASK_CREATE(vREACTOR_Process, "Reactor", REACTOR_TASK_STACK_SIZE, REACTOR_TASK_PRIORITY, REACTOR_TASK_CORE);
+#else
     /* Drivers tasks creation */
-    xTaskCreate(vBUT_Process, "Driver buttons", 2048U, NULL, 7U, NULL);
-    xTaskCreate(vSERVO_Process, "Driver servos", 2048U, NULL, 6U, NULL);
-    xTaskCreate(vLED_Process, "Driver LEDs", 2048U, NULL, 5U, NULL);
+    OS_TASK_CREATE(vBUT_Process, "Driver buttons", BUTTONS_TASK_STACK_SIZE, BUTTONS_TASK_PRIORITY, BUTTONS_TASK_CORE);
+    OS_TASK_CREATE(vSERVO_Process, "Driver servos", SERVO_TASK_STACK_SIZE, SERVO_TASK_PRIORITY, SERVO_TASK_CORE);
+    OS_TASK_CREATE(vLED_Process, "Driver LEDs", LEDS_TASK_STACK_SIZE, LEDS_TASK_PRIORITY, LEDS_TASK_CORE);
 
     /* Applications tasks creation */
-    xTaskCreate(vBUTMNGR_Process, "Buttons manager", 2048U, NULL, 3U, NULL);
-    xTaskCreate(vMVT_Process, "Movement manager", 2048U, NULL, 2U, NULL);
-    xTaskCreate(vSEQMNGR_Process, "Sequence manager", 2048U, NULL, 1U, NULL);
+    OS_TASK_CREATE(vBUTMNGR_Process, "Buttons manager", BUT_MNGR_TASK_STACK_SIZE, BUT_MNGR_TASK_PRIORITY, BUT_MNGR_TASK_CORE);
+    OS_TASK_CREATE(vMVT_Process, "Movement manager", MOVEMENT_TASK_STACK_SIZE, MOVEMENT_TASK_PRIORITY, MOVEMENT_TASK_CORE);
+    OS_TASK_CREATE(vSEQMNGR_Process, "Sequence manager", SEQUENCE_TASK_STACK_SIZE, SEQUENCE_TASK_PRIORITY, SEQUENCE_TASK_CORE);
+#endif
+
+    /* Budget is complete once every module has created its queues and timers */
+    if (bBOOT_WaitAllReady(BOOT_DEPENDENCY_TIMEOUT_TICKS * BOOT_MODULE_NUMBER)) {
+        vOS_PrintRamBudget();
+    }
+#if OS_QUEUE_STATS_DUMP_PERIOD_MS > 0
+    vOS_StartQueueStatsDump(pdMS_TO_TICKS(OS_QUEUE_STATS_DUMP_PERIOD_MS));
+#endif
+#if SYSTEM_DEADLINE_MONITOR_ENABLED && (DLN_PRINT_PERIOD_MS > 0)
+    vDLN_StartStatsDump(pdMS_TO_TICKS(DLN_PRINT_PERIOD_MS));
+#endif
+#if SYSTEM_REMOTE_LINK_ENABLED
+    OS_TASK_CREATE(vRMT_Process, "Remote link", RMT_TASK_STACK_SIZE, RMT_TASK_PRIORITY, RMT_TASK_CORE);
+#endif
+#if SYSTEM_BENCHMARK_ENABLED
+    OS_TASK_CREATE(vBENCH_Process, "Benchmark", BENCH_TASK_STACK_SIZE, BENCH_TASK_PRIORITY, BENCH_TASK_CORE);
+#endif
+#if SYSTEM_INPUT_LOG_ENABLED
+    /* Last: every input owner has set its injector, the tick waited at start lets the tasks created above run */
+    vILOG_Start();
+#endif
 }
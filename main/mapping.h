@@ -37,6 +37,13 @@
 #define BUZZER_GPIO_NUM (GPIO_NUM_4)
 #define CHARGE_STATUS_GPIO_NUM (GPIO_NUM_5)
 
+#define LINK_TX_GPIO_NUM (GPIO_NUM_13)
+#define LINK_RX_GPIO_NUM (GPIO_NUM_14)
+
+/* Benchmark edge generator, wired to the GO button input */
+#define BENCH_EDGE_GPIO_NUM (GPIO_NUM_15)
+#define BENCH_EDGE_TARGET_GPIO_NUM (BUTTON_GO_GPIO_NUM)
+
 /* ____________________________________________________________________________ */
 /* Enum 																		*/
 
@@ -0,0 +1,213 @@
+/**
+*******************************************************************************
+* @file 	system_config.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+*******************************************************************************
+*/
+
+#ifndef __SYSTEMCONFIG_H__
+#define __SYSTEMCONFIG_H__
+
+/* ____________________________________________________________________________ */
+/* Build options 																*/
+#ifndef SYSTEM_BENCHMARK_ENABLED
+#define SYSTEM_BENCHMARK_ENABLED (0) /* 1: benchmark suite runs once after boot, see tools/bench_compare.py */
+#endif
+
+#ifndef SYSTEM_CORE_PINNING_ENABLED
+#define SYSTEM_CORE_PINNING_ENABLED (1) /* 1: tasks and GPIO interrupts follow the *_TASK_CORE placement, 0: no affinity */
+#endif
+
+#ifndef SYSTEM_DEADLINE_MONITOR_ENABLED
+#define SYSTEM_DEADLINE_MONITOR_ENABLED (1) /* 1: latency budgets and histograms on the input to motion path */
+#endif
+
+#ifndef SYSTEM_INPUT_LOG_ENABLED
+#define SYSTEM_INPUT_LOG_ENABLED (0) /* 1: external inputs, timer expiries and servo writes streamed on the console, see tools/input_log.py */
+#endif
+
+#ifndef SYSTEM_INPUT_REPLAY_ENABLED
+#define SYSTEM_INPUT_REPLAY_ENABLED (0) /* 1: log embedded by tools/input_log.py replayed after boot, needs SYSTEM_INPUT_LOG_ENABLED */
+#endif
+
+#ifndef SYSTEM_POWER_MANAGEMENT_ENABLED
+#define SYSTEM_POWER_MANAGEMENT_ENABLED (1) /* 1: frequency scaling, tickless idle and light sleep, needs CONFIG_PM_ENABLE */
+#endif
+
+#ifndef SYSTEM_REMOTE_LINK_ENABLED
+#define SYSTEM_REMOTE_LINK_ENABLED (1) /* 1: binary command and telemetry link on UART1, keeps the chip awake while in use, see tools/link_client.py */
+#endif
+
+#ifndef SYSTEM_SINGLE_TASK_REACTOR
+#define SYSTEM_SINGLE_TASK_REACTOR (0) /* 1: all drivers and managers run in one event loop task */
+#endif
+
+#ifndef SYSTEM_STATIC_ALLOCATION
+#define SYSTEM_STATIC_ALLOCATION (0) /* 1: tasks, queues, timers and mutexes use compile time storage */
+#endif
+
+#ifndef SYSTEM_TASK_MONITOR_ENABLED
+#define SYSTEM_TASK_MONITOR_ENABLED (1) /* 1: per task CPU load and stack usage, needs FreeRTOS run time stats */
+#endif
+
+#ifndef SYSTEM_TRACE_ENABLED
+#define SYSTEM_TRACE_ENABLED (0) /* 1: binary event trace drained on the console, see tools/trace_decode.py */
+#endif
+
+/* ____________________________________________________________________________ */
+/* Tasks (stack sizes in bytes) 												*/
+/* Motion path (buttons, movement, servos) alone on the APP core. Everything else shares the PRO core
+ * with the ESP-IDF services pinned there: esp_timer, timer task, console */
+#define SYSTEM_PRO_CORE (0)
+#define SYSTEM_APP_CORE (1)
+#define BUTTONS_TASK_STACK_SIZE (2048U)
+#define BUTTONS_TASK_PRIORITY (7U)
+#define BUTTONS_TASK_CORE (SYSTEM_APP_CORE)
+#define SERVO_TASK_STACK_SIZE (2048U)
+#define SERVO_TASK_PRIORITY (6U)
+#define SERVO_TASK_CORE (SYSTEM_APP_CORE)
+#define LEDS_TASK_STACK_SIZE (2048U)
+#define LEDS_TASK_PRIORITY (5U)
+#define LEDS_TASK_CORE (SYSTEM_PRO_CORE)
+#define BUT_MNGR_TASK_STACK_SIZE (2048U)
+#define BUT_MNGR_TASK_PRIORITY (3U)
+#define BUT_MNGR_TASK_CORE (SYSTEM_PRO_CORE)
+#define MOVEMENT_TASK_STACK_SIZE (2048U)
+#define MOVEMENT_TASK_PRIORITY (2U)
+#define MOVEMENT_TASK_CORE (SYSTEM_APP_CORE)
+#define SEQUENCE_TASK_STACK_SIZE (2048U)
+#define SEQUENCE_TASK_PRIORITY (1U)
+#define SEQUENCE_TASK_CORE (SYSTEM_PRO_CORE)
+#define REACTOR_TASK_STACK_SIZE (4096U)
+#define REACTOR_TASK_PRIORITY (7U)
+#define REACTOR_TASK_CORE (SYSTEM_APP_CORE)
+#define TRACE_TASK_STACK_SIZE (2048U)
+#define TRACE_TASK_PRIORITY (1U)
+#define TRACE_TASK_CORE (SYSTEM_PRO_CORE)
+#define DLOG_TASK_STACK_SIZE (3072U)
+#define DLOG_TASK_PRIORITY (1U)
+#define DLOG_TASK_CORE (SYSTEM_PRO_CORE)
+#define TMON_TASK_STACK_SIZE (2560U)
+#define TMON_TASK_PRIORITY (1U)
+#define TMON_TASK_CORE (SYSTEM_PRO_CORE)
+#define BENCH_TASK_STACK_SIZE (3072U)
+#define BENCH_TASK_PRIORITY (1U)
+#define BENCH_TASK_CORE (SYSTEM_PRO_CORE)
+#define BENCH_ECHO_TASK_PRIORITY (2U) /* Above the caller, as drivers are above managers */
+#define RMT_TASK_STACK_SIZE (3072U)
+#define RMT_TASK_PRIORITY (1U) /* Below every control task, a busy link never delays motion */
+#define RMT_TASK_CORE (SYSTEM_PRO_CORE) /* UART interrupt follows, it is allocated by the task */
+/* Interrupts are served by the core they were allocated on: the GPIO service goes where the buttons driver runs */
+#if SYSTEM_SINGLE_TASK_REACTOR
+#define GPIO_ISR_CORE (REACTOR_TASK_CORE)
+#else
+#define GPIO_ISR_CORE (BUTTONS_TASK_CORE)
+#endif
+#define ILOG_TASK_STACK_SIZE (2560U)
+#define ILOG_TASK_PRIORITY (1U)
+#define ILOG_TASK_CORE (SYSTEM_PRO_CORE)
+#define ILOG_REPLAY_TASK_STACK_SIZE (3072U)
+#define ILOG_REPLAY_TASK_PRIORITY (BUTTONS_TASK_PRIORITY + 1U) /* Injected inputs preempt the firmware, as interrupts do */
+#define ILOG_REPLAY_TASK_CORE (GPIO_ISR_CORE)
+
+/* ____________________________________________________________________________ */
+/* Queues (number of events) 													*/
+#define BUTTONS_QUEUE_LENGTH (10U)
+#define SERVO_QUEUE_LENGTH (10U)
+#define LEDS_QUEUE_LENGTH (10U)
+#define BUT_MNGR_QUEUE_LENGTH (10U)
+#define MOVEMENT_QUEUE_LENGTH (5U)
+#define SEQUENCE_QUEUE_LENGTH (5U)
+
+/* ____________________________________________________________________________ */
+/* Button gestures (durations in milliseconds) 									*/
+#define BUTTON_CLICK_MAX_MS (300U) /* Longer presses do not start a double click */
+#define BUTTON_DOUBLE_CLICK_WINDOW_MS (300U) /* From the first release to the second press */
+#define BUTTON_HOLD_REPEAT_DELAY_MS (500U) /* From the press to the first repeat */
+#define BUTTON_HOLD_REPEAT_PERIOD_MS (250U)
+#define BUTTON_CHORD_WINDOW_MS (80U) /* Presses of a chord, chord member presses are held back for as long */
+
+/* ____________________________________________________________________________ */
+/* Mechanics (lengths in millimeters) 											*/
+#define MECH_WHEEL_DIAMETER_MM (60.0F)
+#define MECH_WHEEL_TRACK_MM (100.0F) /* Between the wheel contact points */
+#define MECH_WHEEL_MAX_RPM (110.0F) /* At 100% speed, FS90R no load at 4.8 V, calibration tables give it on both wheels */
+
+/* ____________________________________________________________________________ */
+/* Message bus (payload sizes in bytes) 										*/
+#define BUS_SMALL_PAYLOAD_SIZE (16U)
+#define BUS_SMALL_BLOCK_NUMBER (16U)
+#define BUS_LARGE_PAYLOAD_SIZE (64U)
+#define BUS_LARGE_BLOCK_NUMBER (4U)
+#define BUS_MAX_SUBSCRIBERS (4U) /* Per topic */
+
+/* ____________________________________________________________________________ */
+/* Power management 															*/
+#define PWR_MIN_CPU_FREQ_MHZ (40U) /* XTAL, lowest frequency scaling step */
+#define PWR_CHARGE_SETTLE_MS (50U) /* Charge status steady for this long before a change is reported */
+
+/* ____________________________________________________________________________ */
+/* Remote link 																	*/
+#define LINK_BAUD_RATE (115200U) /* UART clocked from the 1 MHz REF_TICK, which frequency scaling leaves alone: faster rates drift */
+#define LINK_RX_RING_SIZE (512U) /* Power of two, frames are parsed in place */
+#define LINK_DRIVER_RX_BUFFER_SIZE (1024U) /* UART driver buffer, filled from the RX FIFO interrupt */
+#define LINK_EVENT_QUEUE_LENGTH (16U)
+#define LINK_WAKEUP_THRESHOLD (3U) /* RX edges waking the chip from light sleep, the bytes carrying them are lost */
+#define LINK_IDLE_TIMEOUT_MS (1000U) /* Without traffic for as long, light sleep is allowed again. Above the client retry delay */
+#define RMT_TELEMETRY_MIN_PERIOD_MS (10U)
+#define RMT_REPLY_TIMEOUT_MS (20U) /* Replies wait for the previous frame, telemetry frames never wait */
+
+/* ____________________________________________________________________________ */
+/* Trace 																		*/
+#define TRACE_BUFFER_RECORDS (256U) /* Per core, power of two */
+
+/* ____________________________________________________________________________ */
+/* Deferred log 																*/
+#define DLOG_BUFFER_SIZE (1024U) /* Bytes, power of two */
+#define DLOG_MAX_FORMATS (64U) /* DLOG call sites that have written once */
+#define DLOG_DRAIN_PERIOD_MS (50U)
+
+/* ____________________________________________________________________________ */
+/* Input log 																	*/
+#define ILOG_BUFFER_SIZE (4096U) /* Bytes, power of two */
+#define ILOG_DRAIN_PERIOD_MS (100U)
+#define ILOG_FRAME_MAX_PAYLOAD_SIZE (64U) /* LINK_MAX_PAYLOAD_SIZE, longer payloads are truncated */
+
+/* ____________________________________________________________________________ */
+/* Task monitor 																*/
+#define TMON_MAX_TASKS (24U) /* Application and ESP-IDF tasks */
+#define TMON_SAMPLE_PERIOD_MS (1000U)
+#define TMON_WINDOW_SAMPLES (10U)
+#define TMON_PRINT_PERIOD_MS (60000U) /* 0: no periodic print */
+
+/* ____________________________________________________________________________ */
+/* Deadline monitor (budgets in microseconds) 									*/
+#define DLN_BUDGET_BUTTON_TASK_US (1000U) /* From ISR edge */
+#define DLN_BUDGET_BUTTON_MANAGER_US (2000U) /* From buttons task */
+#define DLN_BUDGET_SEQUENCE_MANAGER_US (5000U) /* From buttons manager or movement end */
+#define DLN_BUDGET_MOVEMENT_MANAGER_US (5000U) /* From sequence manager */
+#define DLN_BUDGET_SERVO_WRITE_US (2000U) /* From movement manager */
+#define DLN_BUDGET_INPUT_TO_MOTION_US (15000U)
+#define DLN_BUDGET_STEP_TRANSITION_US (12000U)
+#define DLN_HISTOGRAM_BUCKETS (16U) /* Log2 buckets, last one starts at 32 ms */
+#define DLN_PRINT_PERIOD_MS (60000U) /* 0: no periodic print */
+
+/* ____________________________________________________________________________ */
+/* Benchmark 																	*/
+#define BENCH_SAMPLES (500U) /* Per measure */
+#define BENCH_EDGE_SAMPLES (50U)
+#define BENCH_EDGE_RATE_HZ (5U) /* Synthetic GO presses per second */
+#define BENCH_EDGE_TIMEOUT_MS (100U) /* Edge without servo write within this delay is dropped */
+#define BENCH_TICK_PERIOD_MS (10U) /* Servo tick probe period */
+#define BENCH_LOAD_CRITICAL_US (200U) /* Interrupts off stretches of the synthetic service core load */
+#define BENCH_LOAD_BURSTS (10U) /* Stretches between two yields of the load task */
+
+/* ____________________________________________________________________________ */
+/* OS utils 																	*/
+#define OS_RESPONSE_MAX_SIZE (8U) /* Largest response of a synchronous request */
+#define OS_RAM_BUDGET_MAX_ENTRIES (24U)
+#define OS_QUEUE_STATS_MAX_ENTRIES (12U)
+#define OS_QUEUE_STATS_DUMP_PERIOD_MS (60000U) /* 0: no periodic dump */
+
+#endif //__SYSTEMCONFIG_H__
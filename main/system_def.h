@@ -10,11 +10,14 @@
 
 #include "freertos/FreeRTOS.h"
 
+#include "freertos/event_groups.h"
 #include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
 
+#include "system_config.h"
+
 #include "osUtils.h"
 
 #define WRITE_IN_QUEUE_DEFAULT_TIMEOUT (pdMS_TO_TICKS(10U))
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Compare benchmark results printed on the console when SYSTEM_BENCHMARK_ENABLED is set.
+
+Usage: bench_compare.py [--json] BEFORE_LOG [AFTER_LOG]
+
+Lines starting with "@B " carry one JSON result each, other lines are ignored. With one log the
+results are listed, with two logs each measure of AFTER is compared to the one of BEFORE.
+--json prints the parsed results (and deltas) as a single JSON document instead of a table.
+
+Task placement: build once with SYSTEM_CORE_PINNING_ENABLED set to 0 and once with 1, then compare the
+two logs. edge_to_isr and servo_tick_lateness are the measures placement moves.
+"""
+
+import argparse
+import json
+import sys
+
+PERCENTILES = ("p50", "p90", "p99", "max")
+
+
+def parse(path):
+    config = {}
+    results = {}
+    with open(path, errors="replace") as stream:
+        for line in stream:
+            marker = line.find("@B ")
+            if marker < 0:
+                continue
+            try:
+                record = json.loads(line[marker + 3:])
+            except ValueError:
+                continue
+            if record.get("name") == "config":
+                config = record
+            else:
+                results[record["name"]] = record
+    return config, results
+
+
+def delta(before, after):
+    if before == 0:
+        return None
+    return 100.0 * (after - before) / before
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("before")
+    parser.add_argument("after", nargs="?")
+    parser.add_argument("--json", action="store_true", help="machine readable output")
+    args = parser.parse_args()
+
+    config, before = parse(args.before)
+    if not before:
+        sys.exit("No benchmark result in %s" % args.before)
+    after = parse(args.after)[1] if args.after else None
+
+    if args.json:
+        document = {"config": config, "before": before}
+        if after is not None:
+            document["after"] = after
+            document["delta_percent"] = {
+                name: {key: delta(before[name][key], after[name][key]) for key in PERCENTILES}
+                for name in before if name in after
+            }
+        print(json.dumps(document, indent=2, sort_keys=True))
+        return
+
+    if after is None:
+        print("%-36s %6s %6s %8s %8s %8s %8s %8s" % ("measure", "unit", "count", "dropped", *PERCENTILES))
+        for name, result in before.items():
+            print("%-36s %6s %6d %8d %8d %8d %8d %8d" % (name, result["unit"], result["count"], result["dropped"],
+                                                        *(result[key] for key in PERCENTILES)))
+        return
+
+    print("%-36s %6s %17s %17s %17s" % ("measure", "unit", "p50", "p99", "max"))
+    for name, result in before.items():
+        if name not in after:
+            print("%-36s missing in %s" % (name, args.after))
+            continue
+        columns = []
+        for key in ("p50", "p99", "max"):
+            change = delta(result[key], after[name][key])
+            columns.append("%7d %+8.1f%%" % (after[name][key], change) if change is not None else "%7d %9s" % (after[name][key], "n/a"))
+        print("%-36s %6s %s" % (name, result["unit"], " ".join(columns)))
+
+
+if __name__ == "__main__":
+    main()
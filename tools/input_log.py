@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Decode, embed and compare the input logs printed on the console when SYSTEM_INPUT_LOG_ENABLED is set.
+
+Usage: input_log.py decode [LOG]          print the records (stdin when no file)
+       input_log.py embed LOG             print main/generic_utils/inc/inputReplayLog.h replaying LOG
+       input_log.py compare LOG REPLAY    check that a replay took the same decisions, exit 1 on divergence
+
+Lines starting with @IH / @IL / @ID are extracted from the console output, other lines are ignored.
+Edges and link frames are the inputs of the run, a replay injects them in the tick they were recorded in.
+Timer expiries and servo writes are checkpoints: a faithful replay produces them again in the same ticks.
+The host build replays a capture with "mouse_host -r LOG", a target one once the log is embedded.
+"""
+
+import argparse
+import sys
+
+# Keep in sync with main/generic_utils/inc/inputLog.h
+VERSION = 1
+KINDS = ["EDGE", "FRAME", "TIMER", "SERVO"]
+CHECKPOINTS = ("TIMER", "SERVO")
+
+# Keep in sync with bootModule_e in main/generic_utils/inc/boot.h
+MODULES = ["buttons", "servo", "leds", "movement", "sequence", "buttonsManager"]
+
+EMBED_BYTES_PER_LINE = 16
+EMBED_TEMPLATE = """/**
+******************************************************************************
+* @file 	inputReplayLog.h
+* @author 	Benoit Florimond
+* @date 	10/19/26
+******************************************************************************
+*/
+
+/* Replaced by "tools/input_log.py embed CAPTURE", replayed after boot when SYSTEM_INPUT_REPLAY_ENABLED is set */
+#ifndef __INPUTREPLAYLOG_H__
+#define __INPUTREPLAYLOG_H__
+
+#define ILOG_REPLAY_LOG_LENGTH (%dU)
+#define ILOG_REPLAY_LOG_BYTES %s
+
+#endif //__INPUTREPLAYLOG_H__"""
+
+
+def extract(lines):
+    """Log bytes, tick rate and dropped record count of a console capture."""
+    data = bytearray()
+    tick_hz = None
+    dropped = 0
+    for line in lines:
+        marker = line.find("@I")
+        if marker < 0:
+            continue
+        fields = line[marker:].split()
+        if fields[0] == "@IH" and len(fields) >= 3:
+            if int(fields[1]) != VERSION:
+                sys.exit("Input log version %s, this tool reads version %d" % (fields[1], VERSION))
+            tick_hz = int(fields[2])
+        elif fields[0] == "@ID" and len(fields) >= 2:
+            dropped = int(fields[1])
+        elif fields[0] == "@IL" and len(fields) >= 2:
+            data += bytes.fromhex(fields[1])
+    return bytes(data), tick_hz, dropped
+
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, offset
+
+
+def parse(data):
+    """Records as dicts, time in us from the start of the log."""
+    records = []
+    offset = 0
+    time_us = 0
+    try:
+        while offset < len(data):
+            start = offset
+            kind = data[offset]
+            if kind >= len(KINDS):
+                raise ValueError("unknown kind %d" % kind)
+            delta_us, offset = read_varint(data, offset + 1)
+            tick, offset = read_varint(data, offset)
+            time_us += delta_us
+            record = {"kind": KINDS[kind], "time_us": time_us, "tick": tick, "source": data[offset]}
+            offset += 1
+            if record["kind"] == "EDGE":
+                record["value"] = data[offset]
+                offset += 1
+            elif record["kind"] == "FRAME":
+                length = data[offset]
+                record["value"] = bytes(data[offset + 1:offset + 1 + length])
+                if len(record["value"]) != length:
+                    raise IndexError
+                offset += 1 + length
+            elif record["kind"] == "SERVO":
+                record["value"], offset = read_varint(data, offset)
+            records.append(record)
+    except (IndexError, ValueError) as error:
+        print("Log corrupted at byte %d (%s), %d records kept" % (start, str(error) or "truncated", len(records)),
+              file=sys.stderr)
+    return records
+
+
+def describe(record):
+    if record["kind"] == "EDGE":
+        return "gpio=%d level=%d" % (record["source"], record["value"])
+    if record["kind"] == "FRAME":
+        return "type=0x%02X payload=%s" % (record["source"], record["value"].hex() or "-")
+    if record["kind"] == "TIMER":
+        return "module=%s" % (MODULES[record["source"]] if record["source"] < len(MODULES) else record["source"])
+    return "gpio=%d pulse=%dus" % (record["source"], record["value"])
+
+
+def load(path):
+    with (open(path, errors="replace") if path else sys.stdin) as stream:
+        data, tick_hz, dropped = extract(stream)
+    if not data:
+        sys.exit("No input log found in %s" % (path or "stdin"))
+    if dropped:
+        print("%s: %d records dropped, the log is incomplete" % (path or "stdin", dropped), file=sys.stderr)
+    return data, tick_hz
+
+
+def decode(args):
+    data, tick_hz = load(args.log)
+    print("%12s %8s  %-6s %s" % ("time_us", "tick", "kind", "details"))
+    for record in parse(data):
+        print("%12d %8d  %-6s %s" % (record["time_us"], record["tick"], record["kind"], describe(record)))
+    if tick_hz:
+        print("# %d Hz tick" % tick_hz)
+
+
+def embed(args):
+    data, _ = load(args.log)
+    lines = ["0x" + ", 0x".join("%02x" % byte for byte in data[offset:offset + EMBED_BYTES_PER_LINE])
+             for offset in range(0, len(data), EMBED_BYTES_PER_LINE)]
+    print(EMBED_TEMPLATE % (len(data), ", \\\n    ".join(lines)))
+
+
+def checkpoints(records):
+    return [(record["tick"], record["kind"], record["source"], record.get("value")) for record in records
+            if record["kind"] in CHECKPOINTS]
+
+
+def describe_checkpoint(checkpoint):
+    return "tick %d %s %s" % (checkpoint[0], checkpoint[1],
+                              describe(dict(zip(("tick", "kind", "source", "value"), checkpoint))))
+
+
+def compare(args):
+    original = parse(load(args.log)[0])
+    replay = parse(load(args.replay)[0])
+    expected = checkpoints(original)
+    produced = checkpoints(replay)
+    for index, (left, right) in enumerate(zip(expected, produced)):
+        if left != right:
+            print("Divergence at checkpoint %d:" % index)
+            print("  log:    " + describe_checkpoint(left))
+            print("  replay: " + describe_checkpoint(right))
+            sys.exit(1)
+    # The replay may run longer than the capture: only a missing checkpoint is a divergence
+    if len(produced) < len(expected):
+        print("Replay stopped after %d of %d checkpoints" % (len(produced), len(expected)))
+        sys.exit(1)
+    print("%d checkpoints identical, %d inputs replayed" % (
+        len(expected), sum(1 for record in replay if record["kind"] not in CHECKPOINTS)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    command = commands.add_parser("decode", help="print the records")
+    command.add_argument("log", nargs="?", help="console capture, stdin when omitted")
+    command.set_defaults(function=decode)
+    command = commands.add_parser("embed", help="print inputReplayLog.h")
+    command.add_argument("log", help="console capture")
+    command.set_defaults(function=embed)
+    command = commands.add_parser("compare", help="compare the checkpoints of a run and of its replay")
+    command.add_argument("log", help="console capture of the original run")
+    command.add_argument("replay", help="console capture of the replay")
+    command.set_defaults(function=compare)
+    args = parser.parse_args()
+    args.function(args)
+
+
+if __name__ == "__main__":
+    main()
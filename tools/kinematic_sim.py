@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""Replay servo pulse widths as a 2D robot trajectory, in virtual time.
+
+Usage: kinematic_sim.py [options] SOURCE              one run, trajectory printed as CSV
+       kinematic_sim.py [options] --batch FILE        final pose checks, one run per line
+
+SOURCE is either:
+  - a timeline CSV written by the host build (mouse_host -o), only the MCPWM samples are used
+  - seq:MOVES, a sequence of F/B/L/R steps, turned into the pulses servo.c would emit for it
+
+Batch lines are "SOURCE X_MM Y_MM HEADING_DEG", '#' starts a comment. The exit code is 1 if a
+final pose is off by more than --tolerance-mm / --tolerance-deg.
+
+The simulation is event driven: the clock jumps from one pulse change to the next. Wheel speed
+follows the command with a first order lag, integrated in --step-ms steps until both wheels are
+settled, then in one exact arc up to the next event. A run of a few minutes takes milliseconds.
+
+Pose origin is the robot start, x forward, y to the left, heading counter clockwise.
+"""
+
+import argparse
+import csv
+import math
+import sys
+
+# Keep in sync with main/mapping.h
+SERVO_LEFT_GPIO = 23
+SERVO_RIGHT_GPIO = 25
+
+# Keep in sync with hostSignal_e in host/inc/hostHarness.h
+HOST_SIGNAL_MCPWM = 2
+
+# Keep in sync with main/applications/src/movementManager.c and main/drivers/src/servo.c (linear, uncalibrated tables)
+PULSE_MIN_US = 1000.0
+PULSE_MAX_US = 2000.0
+STEP_DURATION_MS = 1000
+MOVES = {
+    # (left speed %, left forward, right speed %, right forward)
+    "F": (50.0, True, 50.0, True),
+    "B": (50.0, False, 50.0, False),
+    "L": (30.0, False, 30.0, True),
+    "R": (30.0, True, 30.0, False),
+}
+
+SETTLED_RPM = 0.01
+
+
+class Fs90Model:
+    """FS90R continuous rotation servo: dead band around neutral, linear up to saturation, first order lag."""
+
+    def __init__(self, args):
+        self.neutral_us = (PULSE_MIN_US + PULSE_MAX_US) / 2.0
+        self.deadband_us = args.deadband_us
+        self.saturation_us = args.saturation_us
+        self.max_rpm = args.max_rpm
+        self.tau_s = args.tau_ms / 1000.0
+
+    def target_rpm(self, pulse_us):
+        offset = pulse_us - self.neutral_us
+        # No pulse at all (output idle after init) leaves the motor unpowered
+        if pulse_us <= 0.0:
+            return 0.0
+        magnitude = abs(offset) - self.deadband_us
+        if magnitude <= 0.0:
+            return 0.0
+        ratio = min(magnitude / (self.saturation_us - self.deadband_us), 1.0)
+        return math.copysign(ratio * self.max_rpm, offset)
+
+    def advance(self, rpm, target, duration_s):
+        """Speed at the end of the interval and its mean over the interval."""
+        if self.tau_s <= 0.0 or rpm == target:
+            return target, target
+        decay = math.exp(-duration_s / self.tau_s)
+        final = target + (rpm - target) * decay
+        mean = target + (rpm - target) * self.tau_s * (1.0 - decay) / duration_s
+        return final, mean
+
+
+class Robot:
+    def __init__(self, args):
+        self.model = Fs90Model(args)
+        self.mm_per_rev = math.pi * args.wheel_diameter_mm
+        self.track_mm = args.track_mm
+        self.step_s = args.step_ms / 1000.0
+        self.time_s = 0.0
+        self.x = 0.0
+        self.y = 0.0
+        self.heading = 0.0
+        self.rpm = {SERVO_LEFT_GPIO: 0.0, SERVO_RIGHT_GPIO: 0.0}
+        self.target = {SERVO_LEFT_GPIO: 0.0, SERVO_RIGHT_GPIO: 0.0}
+
+    def pose(self):
+        return (self.time_s * 1000.0, self.x, self.y, math.degrees(self.heading))
+
+    def set_pulse(self, gpio, pulse_us):
+        if gpio in self.target:
+            self.target[gpio] = self.model.target_rpm(pulse_us)
+
+    def run_until(self, end_s, sample_s, trajectory):
+        while self.time_s < end_s:
+            settled = all(abs(self.rpm[gpio] - self.target[gpio]) < SETTLED_RPM for gpio in self.rpm)
+            stop_s = end_s if settled else min(end_s, self.time_s + self.step_s)
+            next_sample_s = None
+            if sample_s > 0.0:
+                next_sample_s = (math.floor(self.time_s / sample_s + 1e-9) + 1) * sample_s
+                stop_s = min(stop_s, next_sample_s)
+            self._integrate(stop_s - self.time_s)
+            if trajectory is not None and sample_s > 0.0 and stop_s == next_sample_s:
+                record(trajectory, self.pose())
+
+    def _integrate(self, duration_s):
+        mean = {}
+        for gpio in self.rpm:
+            self.rpm[gpio], mean[gpio] = self.model.advance(self.rpm[gpio], self.target[gpio], duration_s)
+        left = mean[SERVO_LEFT_GPIO] / 60.0 * self.mm_per_rev
+        right = mean[SERVO_RIGHT_GPIO] / 60.0 * self.mm_per_rev
+        speed = (left + right) / 2.0
+        turn = (right - left) / self.track_mm
+        delta = turn * duration_s
+        if abs(delta) < 1e-12:
+            self.x += speed * duration_s * math.cos(self.heading)
+            self.y += speed * duration_s * math.sin(self.heading)
+        else:
+            self.x += speed / turn * (math.sin(self.heading + delta) - math.sin(self.heading))
+            self.y -= speed / turn * (math.cos(self.heading + delta) - math.cos(self.heading))
+        self.heading = math.atan2(math.sin(self.heading + delta), math.cos(self.heading + delta))
+        self.time_s += duration_s
+
+
+def record(trajectory, pose):
+    """Events at the same time (one per wheel) give a single pose."""
+    if trajectory and trajectory[-1][0] == pose[0]:
+        trajectory[-1] = pose
+    else:
+        trajectory.append(pose)
+
+
+def pulse_us(speed, forward):
+    duty = 50.0 + speed / 2.0 if forward else 50.0 - speed / 2.0
+    return min(max((PULSE_MAX_US - PULSE_MIN_US) * duty / 100.0 + PULSE_MIN_US, PULSE_MIN_US), PULSE_MAX_US)
+
+
+def events_from_sequence(moves):
+    """(time_us, gpio, pulse_us) list of an ideal run: no latency between steps."""
+    events = []
+    time_us = 0
+    for move in moves.upper():
+        if move not in MOVES:
+            raise ValueError("unknown move '%s'" % move)
+        left_speed, left_forward, right_speed, right_forward = MOVES[move]
+        events.append((time_us, SERVO_LEFT_GPIO, pulse_us(left_speed, left_forward)))
+        events.append((time_us, SERVO_RIGHT_GPIO, pulse_us(right_speed, right_forward)))
+        time_us += STEP_DURATION_MS * 1000
+    events.append((time_us, SERVO_LEFT_GPIO, pulse_us(0.0, True)))
+    events.append((time_us, SERVO_RIGHT_GPIO, pulse_us(0.0, True)))
+    return events
+
+
+def events_from_timeline(path):
+    events = []
+    with open(path, newline="") as stream:
+        for row in csv.DictReader(stream):
+            if int(row["signal"]) == HOST_SIGNAL_MCPWM:
+                events.append((int(row["time_us"]), int(row["gpio"]), float(row["value"])))
+    # The first non idle pulse is the origin: time spent booting is not part of the run
+    origins = [time_us for time_us, gpio, value in events if value > 0.0]
+    if origins:
+        origin = origins[0]
+        events = [(time_us - origin, gpio, value) for time_us, gpio, value in events]
+    return events
+
+
+def load(source):
+    if source.startswith("seq:"):
+        return events_from_sequence(source[4:])
+    return events_from_timeline(source)
+
+
+def simulate(events, args, trajectory=None):
+    robot = Robot(args)
+    events = sorted(events, key=lambda event: event[0])
+    end_s = (events[-1][0] / 1e6 if events else 0.0) + args.tail_ms / 1000.0
+    sample_s = args.sample_ms / 1000.0
+    if trajectory is not None:
+        record(trajectory, robot.pose())
+    for time_us, gpio, value in events:
+        robot.run_until(time_us / 1e6, sample_s, trajectory)
+        robot.set_pulse(gpio, value)
+        if trajectory is not None and sample_s <= 0.0:
+            record(trajectory, robot.pose())
+    robot.run_until(end_s, sample_s, trajectory)
+    if trajectory is not None:
+        record(trajectory, robot.pose())
+    return robot
+
+
+def angle_error(a, b):
+    return abs((a - b + 180.0) % 360.0 - 180.0)
+
+
+def run_batch(path, args):
+    failures = 0
+    runs = 0
+    with open(path) as stream:
+        for number, line in enumerate(stream, 1):
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) != 4:
+                sys.exit("%s:%d: expected SOURCE X_MM Y_MM HEADING_DEG" % (path, number))
+            robot = simulate(load(fields[0]), args)
+            expected_x, expected_y, expected_heading = (float(field) for field in fields[1:])
+            distance = math.hypot(robot.x - expected_x, robot.y - expected_y)
+            heading = math.degrees(robot.heading)
+            runs += 1
+            if distance > args.tolerance_mm or angle_error(heading, expected_heading) > args.tolerance_deg:
+                failures += 1
+                print("FAIL %s: (%.1f, %.1f, %.1f) expected (%.1f, %.1f, %.1f)" %
+                      (fields[0], robot.x, robot.y, heading, expected_x, expected_y, expected_heading))
+    print("%d runs, %d failed" % (runs, failures))
+    return 1 if failures else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", nargs="?", help="timeline CSV or seq:MOVES")
+    parser.add_argument("--batch", help="file of SOURCE X_MM Y_MM HEADING_DEG lines")
+    # Keep in sync with the mechanics section of main/system_config.h
+    parser.add_argument("--wheel-diameter-mm", type=float, default=60.0)
+    parser.add_argument("--track-mm", type=float, default=100.0, help="distance between the wheels")
+    parser.add_argument("--max-rpm", type=float, default=110.0, help="FS90R no load speed at 4.8 V")
+    parser.add_argument("--deadband-us", type=float, default=20.0, help="around the neutral pulse")
+    parser.add_argument("--saturation-us", type=float, default=500.0, help="offset from neutral giving max speed")
+    parser.add_argument("--tau-ms", type=float, default=50.0, help="speed response time constant, 0 for none")
+    parser.add_argument("--step-ms", type=float, default=10.0, help="integration step while a wheel accelerates")
+    parser.add_argument("--sample-ms", type=float, default=0.0, help="trajectory period, 0 for events only")
+    parser.add_argument("--tail-ms", type=float, default=500.0, help="run time after the last event")
+    parser.add_argument("--tolerance-mm", type=float, default=5.0)
+    parser.add_argument("--tolerance-deg", type=float, default=2.0)
+    args = parser.parse_args()
+
+    if args.batch:
+        sys.exit(run_batch(args.batch, args))
+    if not args.source:
+        parser.error("a source or --batch is required")
+
+    trajectory = []
+    simulate(load(args.source), args, trajectory)
+    print("time_ms,x_mm,y_mm,heading_deg")
+    for pose in trajectory:
+        print("%.3f,%.2f,%.2f,%.2f" % pose)
+
+
+if __name__ == "__main__":
+    main()
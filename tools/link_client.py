@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Talk to the robot over the binary UART link, see main/drivers/inc/uartLink.h and remoteManager.h.
+
+Usage: link_client.py [--baud N] PORT COMMAND [ARGUMENT [VALUE]]
+
+PORT is the serial device wired to the link pins, or the pseudo-terminal printed by the host build.
+Commands:
+  ping
+  upload MOVES          replace the sequence, MOVES is a string of F/B/L/R steps
+  download              print the sequence
+  route X,Y,H TARGETS   plan a grid route from the start cell and heading (N/E/S/W) through TARGETS, cells as
+                        X,Y separated by '/', the route replaces the sequence (--grid, --blocked)
+  launch | abort
+  move F|B|L|R|S        one live step, S stops and aborts a running sequence
+  telemetry PERIOD_MS   stream telemetry as CSV until interrupted (or --count frames), then stop it
+  pulse GPIO US         raw servo pulse, 0 parks the output (tools/servo_calibrate.py sweeps with it)
+  calibration GPIO      print the speed table of a servo, pulse per speed from -100% to +100%
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+
+FRAME_START = 0xA5
+MAX_PAYLOAD_SIZE = 64
+
+# Keep in sync with rmtMessage_e and rmtStatus_e in main/applications/inc/remoteManager.h
+MSG_PING = 0x01
+MSG_SEQUENCE_UPLOAD = 0x10
+MSG_SEQUENCE_DOWNLOAD = 0x11
+MSG_SEQUENCE_LAUNCH = 0x12
+MSG_SEQUENCE_ABORT = 0x13
+MSG_ROUTE_PLAN = 0x14
+MSG_MOVE = 0x20
+MSG_TELEMETRY_PERIOD = 0x30
+MSG_SERVO_PULSE = 0x40
+MSG_CALIBRATION_UPLOAD = 0x41
+MSG_CALIBRATION_DOWNLOAD = 0x42
+MSG_ACK = 0x80
+MSG_SEQUENCE_CONTENT = 0x91
+MSG_CALIBRATION_CONTENT = 0x92
+MSG_TELEMETRY = 0xA0
+STATUSES = ("ok", "bad payload", "rejected", "unknown type")
+
+# Keep in sync with movementType_e in main/applications/inc/movementManager.h
+MOVES = {"S": 0, "F": 1, "B": 2, "L": 3, "R": 4}
+MOVE_NAMES = {value: name for name, value in MOVES.items()}
+
+# Keep in sync with planHeading_e in main/applications/inc/pathPlanner.h
+HEADINGS = {"N": 0, "E": 1, "S": 2, "W": 3}
+
+# Keep in sync with SERVO_CAL_STEP_PERCENT in main/drivers/inc/servo.h
+CALIBRATION_STEP_PERCENT = 10
+CALIBRATION_SPEEDS = tuple(range(-100, 101, CALIBRATION_STEP_PERCENT))
+
+TELEMETRY_HEADER = struct.Struct("<IBBiihHHHB")
+TELEMETRY_QUEUE = struct.Struct("<BH")
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC16 CCITT, polynomial 0x1021."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        crc &= 0xFFFF
+    return crc
+
+
+def encode(frame_type, sequence, payload=b""):
+    if len(payload) > MAX_PAYLOAD_SIZE:
+        raise ValueError("payload of %d bytes, at most %d" % (len(payload), MAX_PAYLOAD_SIZE))
+    body = bytes((len(payload), frame_type, sequence)) + payload
+    return bytes((FRAME_START,)) + body + struct.pack("<H", crc16(body))
+
+
+class Link:
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.buffer = bytearray()
+        self.sequence = 0
+        if os.isatty(self.fd):
+            attributes = termios.tcgetattr(self.fd)
+            attributes[0] = attributes[1] = attributes[3] = 0
+            attributes[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+            speed = getattr(termios, "B%d" % baud, None)
+            if speed is not None:
+                attributes[4] = attributes[5] = speed
+            attributes[6][termios.VMIN] = 0
+            attributes[6][termios.VTIME] = 0
+            termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+            termios.tcflush(self.fd, termios.TCIFLUSH)
+
+    def send(self, frame_type, payload=b""):
+        self.sequence = (self.sequence + 1) & 0xFF
+        os.write(self.fd, encode(frame_type, self.sequence, payload))
+        return self.sequence
+
+    def receive(self, timeout_s):
+        """Next valid frame as (type, sequence, payload), None on timeout."""
+        deadline = time.monotonic() + timeout_s
+        while True:
+            frame = self._parse()
+            if frame is not None:
+                return frame
+            remaining = deadline - time.monotonic()
+            if remaining <= 0.0 or not select.select([self.fd], [], [], remaining)[0]:
+                return None
+            self.buffer += os.read(self.fd, 4096)
+
+    def request(self, frame_type, payload=b"", reply_type=MSG_ACK, retries=3):
+        """Bytes sent while the robot wakes up may be lost, requests are repeated."""
+        for _ in range(retries):
+            sequence = self.send(frame_type, payload)
+            deadline = time.monotonic() + 0.5
+            while time.monotonic() < deadline:
+                frame = self.receive(deadline - time.monotonic())
+                if frame is not None and frame[0] == reply_type and frame[1] == sequence:
+                    return frame[2]
+        sys.exit("No reply to request 0x%02X" % frame_type)
+
+    def _parse(self):
+        while len(self.buffer) >= 6:
+            length = self.buffer[1]
+            if self.buffer[0] != FRAME_START or length > MAX_PAYLOAD_SIZE:
+                del self.buffer[0]
+                continue
+            size = 4 + length + 2
+            if len(self.buffer) < size:
+                return None
+            body = bytes(self.buffer[1:4 + length])
+            if struct.unpack_from("<H", self.buffer, 4 + length)[0] != crc16(body):
+                del self.buffer[0]
+                continue
+            del self.buffer[:size]
+            return body[1], body[2], body[3:]
+        return None
+
+
+def acknowledge(payload, quiet=False):
+    status = payload[1] if len(payload) == 2 else None
+    if status != 0:
+        sys.exit("Request failed: %s" % (STATUSES[status] if status is not None and status < len(STATUSES) else status))
+    if not quiet:
+        print("ok")
+
+
+def set_pulse(link, gpio, pulse_us):
+    acknowledge(link.request(MSG_SERVO_PULSE, struct.pack("<BH", gpio, pulse_us)), quiet=True)
+
+
+def upload_calibration(link, gpio, table):
+    acknowledge(link.request(MSG_CALIBRATION_UPLOAD, struct.pack("<B%dH" % len(table), gpio, *table)), quiet=True)
+
+
+def download_calibration(link, gpio):
+    payload = link.request(MSG_CALIBRATION_DOWNLOAD, bytes((gpio,)), reply_type=MSG_CALIBRATION_CONTENT)
+    return list(struct.unpack_from("<%dH" % len(CALIBRATION_SPEEDS), payload, 1))
+
+
+def parse_cells(text):
+    """'X,Y/X,Y' as a list of (x, y)."""
+    try:
+        return [tuple(int(value) for value in cell.split(",")) for cell in text.split("/") if cell]
+    except ValueError:
+        sys.exit("Cells are X,Y separated by '/'")
+
+
+def plan_route(link, grid, start, targets, blocked):
+    width, height = (int(value) for value in grid.lower().split("x"))
+    x, y, heading = start.split(",")
+    payload = struct.pack("<6B", width, height, int(x), int(y), HEADINGS[heading.upper()], len(targets))
+    payload += b"".join(struct.pack("<2B", *cell) for cell in targets + blocked)
+    acknowledge(link.request(MSG_ROUTE_PLAN, payload))
+
+
+def print_telemetry(sequence, payload):
+    fields = TELEMETRY_HEADER.unpack_from(payload)
+    uptime_ms, length, step, x, y, heading, crc_errors, overflows, dropped, queue_number = fields
+    queues = [TELEMETRY_QUEUE.unpack_from(payload, TELEMETRY_HEADER.size + index * TELEMETRY_QUEUE.size)
+              for index in range(queue_number)]
+    print("%d,%d,%d,%d,%.1f,%.1f,%.2f,%d,%d,%d,%s" % (
+        sequence, uptime_ms, length, step, x / 10.0, y / 10.0, heading / 100.0, crc_errors, overflows, dropped,
+        " ".join("%d/%d" % queue for queue in queues)), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--count", type=int, default=0, help="telemetry frames to print, 0 for no limit")
+    parser.add_argument("--grid", default="12x12", help="route grid size, WIDTHxHEIGHT")
+    parser.add_argument("--blocked", default="", help="route blocked cells, X,Y separated by '/'")
+    parser.add_argument("port")
+    parser.add_argument("command", choices=("ping", "upload", "download", "route", "launch", "abort", "move",
+                                            "telemetry", "pulse", "calibration"))
+    parser.add_argument("argument", nargs="?")
+    parser.add_argument("value", nargs="?")
+    args = parser.parse_args()
+    link = Link(args.port, args.baud)
+
+    if args.command == "ping":
+        acknowledge(link.request(MSG_PING))
+    elif args.command == "upload":
+        try:
+            steps = bytes(MOVES[move] for move in (args.argument or "").upper())
+        except KeyError as error:
+            sys.exit("Unknown move %s" % error)
+        acknowledge(link.request(MSG_SEQUENCE_UPLOAD, steps))
+    elif args.command == "download":
+        payload = link.request(MSG_SEQUENCE_DOWNLOAD, reply_type=MSG_SEQUENCE_CONTENT)
+        print("".join(MOVE_NAMES.get(step, "?") for step in payload))
+    elif args.command == "route":
+        if args.argument is None or args.value is None:
+            sys.exit("route expects a start X,Y,H and targets")
+        plan_route(link, args.grid, args.argument, parse_cells(args.value), parse_cells(args.blocked))
+    elif args.command == "launch":
+        acknowledge(link.request(MSG_SEQUENCE_LAUNCH))
+    elif args.command == "abort":
+        acknowledge(link.request(MSG_SEQUENCE_ABORT))
+    elif args.command == "move":
+        if (args.argument or "").upper() not in MOVES:
+            sys.exit("move expects one of %s" % "/".join(MOVES))
+        acknowledge(link.request(MSG_MOVE, bytes((MOVES[args.argument.upper()],))))
+    elif args.command == "telemetry":
+        period_ms = int(args.argument or 100)
+        acknowledge(link.request(MSG_TELEMETRY_PERIOD, struct.pack("<H", period_ms)), quiet=True)
+        print("frame,uptime_ms,sequence_length,sequence_step,x_mm,y_mm,heading_deg,crc_errors,rx_overflows,"
+              "tx_dropped,queues_high_water/lost")
+        received = 0
+        try:
+            while args.count == 0 or received < args.count:
+                frame = link.receive(1.0)
+                if frame is not None and frame[0] == MSG_TELEMETRY:
+                    print_telemetry(frame[1], frame[2])
+                    received += 1
+        except KeyboardInterrupt:
+            pass
+        acknowledge(link.request(MSG_TELEMETRY_PERIOD, struct.pack("<H", 0)), quiet=True)
+    elif args.command == "pulse":
+        if args.argument is None or args.value is None:
+            sys.exit("pulse expects a GPIO and a pulse width in us")
+        set_pulse(link, int(args.argument), int(args.value))
+        print("ok")
+    elif args.command == "calibration":
+        table = download_calibration(link, int(args.argument or 0))
+        print("speed_percent,pulse_us")
+        for speed, pulse_us in zip(CALIBRATION_SPEEDS, table):
+            print("%d,%d" % (speed, pulse_us))
+
+
+if __name__ == "__main__":
+    main()
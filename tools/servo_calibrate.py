@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Measure both wheel servos and upload speed tables that make them match, see servo.h.
+
+Usage: servo_calibrate.py [options] PORT          sweep over the UART link, speeds typed in or read from --samples
+       servo_calibrate.py --simulate [options]    sweep the kinematic_sim.py servo model, nothing is sent
+
+The robot has no speed sensor: with the wheels lifted, each pulse of the sweep is applied through the
+link and the wheel speed is measured by hand (tachometer, or turns counted over a timed interval) and
+typed in as rpm, positive when the wheel drives the robot forward. --samples reads them from a CSV of
+"gpio,pulse_us,rpm" lines instead, --save writes the measured ones in the same format.
+
+Fit, per wheel: speeds are made non decreasing with the pulse, the stopped range gives the neutral
+pulse (its middle). Both wheels are scaled to a common maximum, the slowest wheel full speed on each
+side, so that a speed percentage gives the same rpm on both. Each table point is the pulse reaching
+its rpm, linearly interpolated between the two samples around it.
+"""
+
+import argparse
+import csv
+import random
+import sys
+
+import kinematic_sim
+import link_client
+
+WHEELS = (kinematic_sim.SERVO_LEFT_GPIO, kinematic_sim.SERVO_RIGHT_GPIO)
+STOPPED_RPM = 0.5
+
+
+def sweep_pulses(args):
+    pulses = list(range(int(kinematic_sim.PULSE_MIN_US), int(kinematic_sim.PULSE_MAX_US) + 1, args.step_us))
+    if pulses[-1] != kinematic_sim.PULSE_MAX_US:
+        pulses.append(int(kinematic_sim.PULSE_MAX_US))
+    return pulses
+
+
+def simulated_wheels(args):
+    """One FS90R model per wheel, spread as two servos out of the same batch are."""
+    rng = random.Random(args.seed)
+    models = {}
+    for gpio in WHEELS:
+        model = kinematic_sim.Fs90Model(argparse.Namespace(
+            deadband_us=20.0 * rng.uniform(0.5, 1.5), saturation_us=500.0 * rng.uniform(0.8, 1.0),
+            max_rpm=110.0 * rng.uniform(0.9, 1.0), tau_ms=0.0))
+        model.neutral_us += rng.uniform(-15.0, 15.0)
+        models[gpio] = model
+    return models
+
+
+def measure(args):
+    """{gpio: [(pulse_us, rpm)]}"""
+    samples = {gpio: [] for gpio in WHEELS}
+    if args.samples:
+        with open(args.samples) as source:
+            for row in csv.reader(line for line in source if line.strip() and not line.startswith("#")):
+                if row[0].strip().isdigit() and int(row[0]) in samples:
+                    samples[int(row[0])].append((int(row[1]), float(row[2])))
+    elif args.simulate:
+        models = simulated_wheels(args)
+        for gpio in WHEELS:
+            samples[gpio] = [(pulse, models[gpio].target_rpm(pulse)) for pulse in sweep_pulses(args)]
+    else:
+        link = link_client.Link(args.port, args.baud)
+        try:
+            for gpio in WHEELS:
+                for pulse in sweep_pulses(args):
+                    link_client.set_pulse(link, gpio, pulse)
+                    samples[gpio].append((pulse, float(input("GPIO %d at %d us, rpm: " % (gpio, pulse)))))
+        finally:
+            for gpio in WHEELS:
+                link_client.set_pulse(link, gpio, 0)
+    return samples
+
+
+def fit_wheel(samples):
+    """Sorted (pulse_us, rpm) with non decreasing rpm, and the neutral pulse."""
+    points = sorted(samples)
+    fitted = []
+    for pulse, rpm in points:
+        fitted.append((pulse, max(rpm, fitted[-1][1]) if fitted else rpm))
+    stopped = [pulse for pulse, rpm in fitted if abs(rpm) < STOPPED_RPM]
+    if not stopped:
+        sys.exit("No stopped sample around neutral, sweep with a smaller --step-us")
+    return fitted, (stopped[0] + stopped[-1]) / 2.0
+
+
+def pulse_for(fitted, neutral_us, target_rpm):
+    """Smallest pulse reaching the target, searched away from neutral."""
+    if target_rpm > 0.0:
+        side = [(pulse, rpm) for pulse, rpm in fitted if pulse >= neutral_us]
+        reached = lambda rpm: rpm >= target_rpm
+    else:
+        side = list(reversed([(pulse, rpm) for pulse, rpm in fitted if pulse <= neutral_us]))
+        reached = lambda rpm: rpm <= target_rpm
+    previous = (neutral_us, 0.0)
+    for pulse, rpm in side:
+        if reached(rpm):
+            return previous[0] + (pulse - previous[0]) * (target_rpm - previous[1]) / (rpm - previous[1])
+        previous = (pulse, rpm)
+    return side[-1][0]
+
+
+def build_tables(samples):
+    fits = {gpio: fit_wheel(samples[gpio]) for gpio in WHEELS}
+    forward_rpm = min(fitted[-1][1] for fitted, _ in fits.values())
+    backward_rpm = max(fitted[0][1] for fitted, _ in fits.values())
+    if forward_rpm <= 0.0 or backward_rpm >= 0.0:
+        sys.exit("A wheel does not turn both ways over the sweep")
+    tables = {}
+    for gpio, (fitted, neutral_us) in fits.items():
+        table = []
+        for speed in link_client.CALIBRATION_SPEEDS:
+            if speed == 0:
+                pulse = neutral_us
+            else:
+                pulse = pulse_for(fitted, neutral_us, speed / 100.0 * (forward_rpm if speed > 0 else -backward_rpm))
+            table.append(int(round(min(max(pulse, kinematic_sim.PULSE_MIN_US), kinematic_sim.PULSE_MAX_US))))
+        for index in range(1, len(table)):
+            table[index] = max(table[index], table[index - 1])
+        tables[gpio] = table
+    return tables, forward_rpm, backward_rpm
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--step-us", type=int, default=25, help="sweep step")
+    parser.add_argument("--samples", help="CSV of gpio,pulse_us,rpm instead of typed speeds")
+    parser.add_argument("--save", help="write the measured samples to this CSV")
+    parser.add_argument("--simulate", action="store_true", help="model two mismatched FS90R, implies --dry-run")
+    parser.add_argument("--seed", type=int, default=1, help="mismatch of the simulated servos")
+    parser.add_argument("--dry-run", action="store_true", help="print the tables without uploading them")
+    args = parser.parse_args()
+    upload = not (args.dry_run or args.simulate)
+    if (upload or not (args.samples or args.simulate)) and not args.port:
+        parser.error("a port is required to sweep or upload")
+
+    samples = measure(args)
+    if args.save:
+        with open(args.save, "w", newline="") as output:
+            writer = csv.writer(output)
+            writer.writerow(("gpio", "pulse_us", "rpm"))
+            for gpio in WHEELS:
+                writer.writerows((gpio, pulse, "%.2f" % rpm) for pulse, rpm in samples[gpio])
+
+    tables, forward_rpm, backward_rpm = build_tables(samples)
+    print("# common full speed: %.1f rpm forward, %.1f rpm backward" % (forward_rpm, -backward_rpm))
+    print("speed_percent," + ",".join("gpio%d_us" % gpio for gpio in WHEELS))
+    for index, speed in enumerate(link_client.CALIBRATION_SPEEDS):
+        print("%d,%s" % (speed, ",".join(str(tables[gpio][index]) for gpio in WHEELS)))
+    if args.simulate:
+        models = simulated_wheels(args)
+        print("# simulated rpm at +50%%: %s" % ", ".join(
+            "%.1f" % models[gpio].target_rpm(tables[gpio][link_client.CALIBRATION_SPEEDS.index(50)]) for gpio in WHEELS))
+
+    if upload:
+        link = link_client.Link(args.port, args.baud)
+        for gpio in WHEELS:
+            link_client.upload_calibration(link, gpio, tables[gpio])
+            if link_client.download_calibration(link, gpio) != tables[gpio]:
+                sys.exit("GPIO %d table read back differs" % gpio)
+        print("# uploaded")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Decode the binary event trace printed on the console when SYSTEM_TRACE_ENABLED is set.
+
+Usage: trace_decode.py [--mhz N] [--chains] [log file]   (stdin when no file)
+
+Lines starting with @TH / @TR / @TD are extracted from the console output, other lines are ignored.
+Each core has its own cycle counter: records are unwrapped per core then merged in a single timeline.
+Cores counters are not synchronized, expect a skew of a few microseconds between cores.
+"""
+
+import argparse
+import sys
+
+# Keep in sync with traceEvent_e in main/generic_utils/inc/trace.h
+EVENTS = [
+    "BUTTON_ISR",
+    "QUEUE_POST",
+    "QUEUE_RECEIVE",
+    "TIMER_EXPIRY",
+    "SERVO_WRITE",
+    "SEQUENCE_STEP",
+    "EMERGENCY_STOP",
+    "SM_TRANSITION",
+]
+
+# Keep in sync with bootModule_e in main/generic_utils/inc/boot.h
+MODULES = ["buttons", "servo", "leds", "movement", "sequence", "buttonsManager"]
+
+MODULE_EVENTS = ("QUEUE_POST", "QUEUE_RECEIVE", "TIMER_EXPIRY")
+RECORD_HEX_SIZE = 16
+CYCLE_COUNTER_RANGE = 1 << 32
+
+
+def parse(lines):
+    mhz = None
+    records = []
+    dropped = {}
+    last_cycles = {}
+    wraps = {}
+
+    for line in lines:
+        marker = line.find("@T")
+        if marker < 0:
+            continue
+        fields = line[marker:].split()
+        if fields[0] == "@TH" and len(fields) >= 2:
+            mhz = int(fields[1])
+        elif fields[0] == "@TD" and len(fields) >= 3:
+            dropped[int(fields[1])] = int(fields[2])
+        elif fields[0] == "@TR" and len(fields) >= 3:
+            core = int(fields[1])
+            payload = fields[2]
+            for offset in range(0, len(payload) - RECORD_HEX_SIZE + 1, RECORD_HEX_SIZE):
+                chunk = payload[offset:offset + RECORD_HEX_SIZE]
+                cycles = int(chunk[0:8], 16)
+                if core in last_cycles and cycles < last_cycles[core]:
+                    wraps[core] = wraps.get(core, 0) + 1
+                last_cycles[core] = cycles
+                records.append({
+                    "core": core,
+                    "cycles": cycles + wraps.get(core, 0) * CYCLE_COUNTER_RANGE,
+                    "id": int(chunk[8:10], 16),
+                    "arg0": int(chunk[10:12], 16),
+                    "arg1": int(chunk[12:16], 16),
+                })
+
+    return mhz, records, dropped
+
+
+def describe(record):
+    name = EVENTS[record["id"]] if record["id"] < len(EVENTS) else "UNKNOWN_%d" % record["id"]
+    if name in MODULE_EVENTS:
+        module = MODULES[record["arg0"]] if record["arg0"] < len(MODULES) else str(record["arg0"])
+        return name, "module=%s arg=%d" % (module, record["arg1"])
+    if name == "BUTTON_ISR":
+        return name, "gpio=%d level=%d" % (record["arg0"], record["arg1"])
+    if name == "SERVO_WRITE":
+        return name, "gpio=%d pulse=%dus" % (record["arg0"], record["arg1"])
+    if name == "SEQUENCE_STEP":
+        return name, "index=%d movement=%d" % (record["arg0"], record["arg1"])
+    if name == "EMERGENCY_STOP":
+        return name, "servos=%d latency=%dus" % (record["arg0"], record["arg1"])
+    if name == "SM_TRANSITION":
+        module = MODULES[record["arg0"]] if record["arg0"] < len(MODULES) else str(record["arg0"])
+        return name, "module=%s state %d -> %d" % (module, record["arg1"] >> 8, record["arg1"] & 0xFF)
+    return name, "arg0=%d arg1=%d" % (record["arg0"], record["arg1"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="console capture, stdin when omitted")
+    parser.add_argument("--mhz", type=int, help="CPU frequency, overrides the @TH header")
+    parser.add_argument("--chains", action="store_true", help="print button edge to first servo write latencies")
+    args = parser.parse_args()
+
+    with (open(args.log, errors="replace") if args.log else sys.stdin) as stream:
+        mhz, records, dropped = parse(stream)
+    mhz = args.mhz or mhz or 160
+    if not records:
+        sys.exit("No trace record found")
+
+    records.sort(key=lambda record: record["cycles"])
+    origin = records[0]["cycles"]
+    previous = origin
+    print("%12s %10s %4s  %-15s %s" % ("time_us", "delta_us", "core", "event", "details"))
+    for record in records:
+        name, details = describe(record)
+        print("%12.1f %10.1f %4d  %-15s %s" % ((record["cycles"] - origin) / mhz, (record["cycles"] - previous) / mhz,
+                                                record["core"], name, details))
+        previous = record["cycles"]
+
+    if args.chains:
+        print("\nButton edge to servo write:")
+        pending = None
+        for record in records:
+            name = EVENTS[record["id"]] if record["id"] < len(EVENTS) else None
+            if name == "BUTTON_ISR" and record["arg1"] == 1:
+                pending = record
+            elif name == "SERVO_WRITE" and pending is not None:
+                print("  gpio %2d -> servo gpio %2d: %8.1f us" % (pending["arg0"], record["arg0"],
+                                                                  (record["cycles"] - pending["cycles"]) / mhz))
+                pending = None
+
+    for core, count in sorted(dropped.items()):
+        print("Core %d dropped %d records" % (core, count), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()